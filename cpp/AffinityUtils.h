@@ -25,6 +25,14 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <boost/lexical_cast.hpp>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <dirent.h>
+#include <unistd.h>
+#include <sched.h>
 #include "ossie/debug.h"
 
 template <typename T>
@@ -57,53 +65,93 @@ T ConvertString(const std::string &data, bool &success)
 }
 
 
-uint64_t ipow(uint64_t base, uint64_t exp)
-{
-	uint64_t result = 1;
-    while (exp)
-    {
-        if (exp & 1)
-            result *= base;
-        exp >>= 1;
-        base *= base;
-    }
+/**
+ * Fills cpuset from a Linux cpu list such as 0-7,16-23, the format used throughout sysfs. Returns false if the list
+ * is empty or cannot be parsed.
+ */
+bool parseCpuList(const std::string &list, cpu_set_t &cpuset) {
+	CPU_ZERO(&cpuset);
+	std::stringstream ss(list);
+	std::string range;
+	bool any = false;
+
+	while (std::getline(ss, range, ',')) {
+		range.erase(range.find_last_not_of(" \n\t") + 1);
+		if (range.empty()) {
+			continue;
+		}
 
-    return result;
-}
+		unsigned int first, last;
+		char extra;
+		int fields = sscanf(range.c_str(), "%u-%u%c", &first, &last, &extra);
+		if (fields == 1 && sscanf(range.c_str(), "%u%c", &first, &extra) == 1) {
+			last = first;
+		} else if (fields != 2 || last < first) {
+			return false;
+		}
+		if (last >= CPU_SETSIZE) {
+			return false;
+		}
 
-int setAffinity(pthread_t thread, std::string str_mask) {
-	cpu_set_t cpuset;
-	uint64_t mask;
-	int s,j;
-	bool success = false;
+		for (unsigned int cpu = first; cpu <= last; ++cpu) {
+			CPU_SET(cpu, &cpuset);
+		}
+		any = true;
+	}
 
-	mask = ConvertString<uint64_t>(str_mask, success);
-	if (not success) {
-		return -1;
+	return any;
+}
+
+/**
+ * Fills cpuset from an affinity property value, either a hex mask of any width such as FF00 or, if it holds a comma
+ * or a dash, a taskset style cpu list such as 2,4-7. A single CPU n as a list is written n-n. Returns false if the
+ * value cannot be parsed or names no CPU.
+ */
+bool parseAffinity(const std::string &affinity, cpu_set_t &cpuset) {
+	if (affinity.find_first_of(",-") != std::string::npos) {
+		return parseCpuList(affinity, cpuset);
 	}
 
 	CPU_ZERO(&cpuset);
-
-	// This loop runs through 1024 possible CPUs (currently that's what the setsize is)
-	for (j = 0; j < CPU_SETSIZE; j++) {
-		if (ipow(2,j) & mask) {
-			CPU_SET(j, &cpuset);
+	bool any = false;
+	size_t cpu = 0;
+	for (std::string::const_reverse_iterator digit = affinity.rbegin(); digit != affinity.rend(); ++digit, cpu += 4) {
+		if (!isxdigit(*digit)) {
+			return false;
+		}
+		int nibble = isdigit(*digit) ? *digit - '0' : toupper(*digit) - 'A' + 10;
+		for (size_t bit = 0; bit < 4; ++bit) {
+			if (nibble & (1 << bit)) {
+				if (cpu + bit >= CPU_SETSIZE) {
+					return false;
+				}
+				CPU_SET(cpu + bit, &cpuset);
+				any = true;
+			}
 		}
 	}
+	return any;
+}
 
-	s = pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset);
-	if (s != 0) {
+int setAffinity(pthread_t thread, const cpu_set_t &cpuset) {
+	if (pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset) != 0) {
 		return -1;
 	}
 	return 0;
 }
 
+int setAffinity(pthread_t thread, std::string str_mask) {
+	cpu_set_t cpuset;
+	if (not parseAffinity(str_mask, cpuset)) {
+		return -1;
+	}
+	return setAffinity(thread, cpuset);
+}
+
 std::string getAffinity(pthread_t thread) {
 	int s, j;
 	cpu_set_t cpuset;
 
-	/* Set affinity mask to include CPUs 0 to 7 */
-
 	CPU_ZERO(&cpuset);
 
 	/* Check the actual affinity mask assigned to the thread */
@@ -113,19 +161,20 @@ std::string getAffinity(pthread_t thread) {
 		return "";
 	}
 
-
-	uint64_t mask = 0;
-
-	// This loop runs through 1024 possible CPUs
-	for (j = 0; j < CPU_SETSIZE; j++) {
-	   if (CPU_ISSET(j, &cpuset)) {
-		   mask |= ipow(2,j);  // TODO: This will obviously break on a system that has more than 64 cores. Fix it.
-	   }
+	// Reported as a hex mask as wide as the highest CPU set, four CPUs per digit
+	std::string mask;
+	for (j = 0; j < CPU_SETSIZE; j += 4) {
+		int nibble = 0;
+		for (int bit = 0; bit < 4; ++bit) {
+			if (CPU_ISSET(j + bit, &cpuset)) {
+				nibble |= 1 << bit;
+			}
+		}
+		mask.insert(mask.begin(), "0123456789ABCDEF"[nibble]);
 	}
 
-	std::stringstream stream;
-	stream << std::uppercase << std::hex << mask;
-	return stream.str();
+	size_t first = mask.find_first_not_of('0');
+	return (first == std::string::npos) ? "0" : mask.substr(first);
 }
 
 static uint64_t get_rx_queue(std::string ip, uint16_t port, int &num_listeners) {
@@ -242,6 +291,212 @@ static int64_t get_rx_dropped(std::string interface) {
 	return atol(buffer);
 }
 
+/**
+ * Returns the NUMA node the NIC behind interface is attached to, or -1 if it is not known. Virtual interfaces such as
+ * the loopback have no device and single node systems usually report -1.
+ */
+int getNumaNode(std::string interface) {
+	if (interface.empty()) {
+		return -1;
+	}
+
+	std::stringstream ss;
+	ss << "/sys/class/net/" << interface << "/device/numa_node";
+
+	FILE *fp = fopen(ss.str().c_str(), "r");
+	if (!fp) {
+		RH_NL_DEBUG("SourceSDDSUtils", "Failed to open " << ss.str() << ", the NUMA node of " << interface << " is not known");
+		return -1;
+	}
+
+	int node = -1;
+	if (fscanf(fp, "%d", &node) != 1) {
+		node = -1;
+	}
+	fclose(fp);
+	return node;
+}
+
+/**
+ * Fills cpuset from a sysfs or procfs file holding a cpu list. Returns false if it cannot be read or parsed.
+ */
+bool readCpuListFile(const std::string &path, cpu_set_t &cpuset) {
+	std::ifstream file(path.c_str());
+	std::string list;
+	if (not std::getline(file, list)) {
+		RH_NL_DEBUG("SourceSDDSUtils", "Failed to read " << path);
+		return false;
+	}
+
+	return parseCpuList(list, cpuset);
+}
+
+/**
+ * Fills cpuset with the CPUs of the given NUMA node. Returns false if they cannot be read.
+ */
+bool getNodeCpus(int node, cpu_set_t &cpuset) {
+	std::stringstream ss;
+	ss << "/sys/devices/system/node/node" << node << "/cpulist";
+	return readCpuListFile(ss.str(), cpuset);
+}
+
+/**
+ * Fills cpuset with the CPUs which service the receive interrupts of interface. The interrupts are those named after
+ * the interface in /proc/interrupts, otherwise the MSI interrupts of its NIC, and of those the receive queues where the
+ * driver names them so (rx, input). Returns false if no interrupts are found.
+ */
+bool getIrqCpus(std::string interface, cpu_set_t &cpuset) {
+	std::map<int, std::string> names;
+	std::vector<int> irqs;
+
+	std::ifstream interrupts("/proc/interrupts");
+	std::string line;
+	while (std::getline(interrupts, line)) {
+		int irq;
+		if (sscanf(line.c_str(), " %d:", &irq) != 1) {
+			continue;
+		}
+		std::string name = line.substr(line.find_last_of(" \t") + 1);
+		std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+		names[irq] = name;
+
+		// The name must start with the interface, eth0 does not match veth0 or eth01
+		if (name.compare(0, interface.size(), interface) == 0 && (name.size() == interface.size() || !isalnum(name[interface.size()]))) {
+			irqs.push_back(irq);
+		}
+	}
+
+	// Virtual NICs such as virtio keep their interrupts on the PCI device above the network device
+	const char *msi_dirs[] = {"/device/msi_irqs", "/device/../msi_irqs"};
+	for (size_t i = 0; i < 2 && irqs.empty(); ++i) {
+		std::string path = "/sys/class/net/" + interface + msi_dirs[i];
+		DIR *dir = opendir(path.c_str());
+		if (not dir) {
+			continue;
+		}
+		struct dirent *entry;
+		while ((entry = readdir(dir)) != NULL) {
+			if (isdigit(entry->d_name[0])) {
+				irqs.push_back(atoi(entry->d_name));
+			}
+		}
+		closedir(dir);
+	}
+
+	std::vector<int> rx;
+	for (size_t i = 0; i < irqs.size(); ++i) {
+		if (names[irqs[i]].find("rx") != std::string::npos || names[irqs[i]].find("input") != std::string::npos) {
+			rx.push_back(irqs[i]);
+		}
+	}
+	if (not rx.empty()) {
+		irqs.swap(rx);
+	}
+
+	// The effective affinity is where the interrupt actually fires, older kernels only have the allowed affinity
+	CPU_ZERO(&cpuset);
+	for (size_t i = 0; i < irqs.size(); ++i) {
+		std::stringstream ss;
+		ss << "/proc/irq/" << irqs[i] << "/";
+		cpu_set_t irq_cpus;
+		if (readCpuListFile(ss.str() + "effective_affinity_list", irq_cpus) || readCpuListFile(ss.str() + "smp_affinity_list", irq_cpus)) {
+			CPU_OR(&cpuset, &cpuset, &irq_cpus);
+		}
+	}
+
+	return CPU_COUNT(&cpuset) > 0;
+}
+
+/**
+ * Fills cpuset with the CPUs sharing the given level of data or unified cache with cpu. Returns false if sysfs does not
+ * describe that cache.
+ */
+bool getCacheCpus(int cpu, int level, cpu_set_t &cpuset) {
+	for (int index = 0; ; ++index) {
+		std::stringstream ss;
+		ss << "/sys/devices/system/cpu/cpu" << cpu << "/cache/index" << index << "/";
+
+		std::ifstream level_file((ss.str() + "level").c_str());
+		std::ifstream type_file((ss.str() + "type").c_str());
+		int cache_level;
+		std::string type;
+		if (not (level_file >> cache_level) || not (type_file >> type)) {
+			return false;
+		}
+		if (cache_level == level && type != "Instruction") {
+			return readCpuListFile(ss.str() + "shared_cpu_list", cpuset);
+		}
+	}
+}
+
+/**
+ * Returns the first CPU sharing the L2 cache, or failing that the L3, with cpu which is in allowed and not in exclude,
+ * or -1 if there is none.
+ */
+int getCpuNear(int cpu, const cpu_set_t &allowed, const cpu_set_t &exclude) {
+	for (int level = 2; level <= 3; ++level) {
+		cpu_set_t shared;
+		if (not getCacheCpus(cpu, level, shared)) {
+			continue;
+		}
+		for (int candidate = 0; candidate < CPU_SETSIZE; ++candidate) {
+			if (CPU_ISSET(candidate, &shared) && CPU_ISSET(candidate, &allowed) && !CPU_ISSET(candidate, &exclude)) {
+				return candidate;
+			}
+		}
+	}
+	return -1;
+}
+
+/**
+ * Picks the CPUs for the socket reader and SDDS to BulkIO threads from where the receive interrupts of interface are
+ * serviced, for the auto affinity. The reader goes on a CPU sharing cache with the first interrupt CPU, its L2 if
+ * possible or else its L3, without being an interrupt CPU itself, and the processor on a CPU sharing the reader's cache
+ * but not its core. Only CPUs the process may run on are picked. Returns false if the interrupts cannot be found.
+ */
+bool getAutoPlacement(std::string interface, int &reader_cpu, int &processor_cpu) {
+	cpu_set_t irq_cpus, allowed;
+	if (not getIrqCpus(interface, irq_cpus) || sched_getaffinity(getpid(), sizeof(allowed), &allowed) != 0) {
+		return false;
+	}
+
+	int irq_cpu = -1;
+	for (int cpu = 0; cpu < CPU_SETSIZE && irq_cpu < 0; ++cpu) {
+		if (CPU_ISSET(cpu, &irq_cpus) && CPU_ISSET(cpu, &allowed)) {
+			irq_cpu = cpu;
+		}
+	}
+	if (irq_cpu < 0) {
+		return false;
+	}
+
+	reader_cpu = getCpuNear(irq_cpu, allowed, irq_cpus);
+	if (reader_cpu < 0) {
+		reader_cpu = irq_cpu;
+	}
+
+	// Keep the processor off the reader's core, its hyperthread siblings included, and off the interrupt CPUs if possible
+	cpu_set_t exclude = irq_cpus;
+	cpu_set_t siblings;
+	std::stringstream ss;
+	ss << "/sys/devices/system/cpu/cpu" << reader_cpu << "/topology/thread_siblings_list";
+	if (readCpuListFile(ss.str(), siblings)) {
+		CPU_OR(&exclude, &exclude, &siblings);
+	}
+	CPU_SET(reader_cpu, &exclude);
+	processor_cpu = getCpuNear(reader_cpu, allowed, exclude);
+
+	if (processor_cpu < 0) {
+		CPU_ZERO(&exclude);
+		CPU_SET(reader_cpu, &exclude);
+		processor_cpu = getCpuNear(reader_cpu, allowed, exclude);
+	}
+	if (processor_cpu < 0) {
+		processor_cpu = reader_cpu;
+	}
+	return true;
+}
+
 int setPolicyAndPriority(pthread_t thread, CORBA::Long priority, std::string thread_desc) {
 	struct sched_param param;
 	int retVal = 0;
@@ -0,0 +1,134 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * AttachedStream.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#include "AttachedStream.h"
+#include "SharedReaderEngine.h"
+#include <algorithm>
+#include <string.h>
+
+PREPARE_LOGGING(AttachedStream)
+
+AttachedStream::AttachedStream(const BULKIO::SDDSStreamDefinition& stream, std::string attach_id,
+		bulkio::OutOctetPort *octet_out, bulkio::OutShortPort *short_out, bulkio::OutFloatPort *float_out):
+	id(attach_id), multicastAddress(stream.multicastAddress), vlan(stream.vlan), port(stream.port),
+	sddsToBulkIO(octet_out, short_out, float_out), m_pool(NULL), m_running(false)
+{
+	sddsToBulkIO.setDefaultStreamId(id);
+}
+
+AttachedStream::~AttachedStream() {
+	stop();
+}
+
+/**
+ * Allocates the packet buffer, opens the socket and starts reading it on the shared reader engine, processing the
+ * packets on pool. The options are taken from the component properties as they are for the first stream, and with
+ * numa_placement the packet buffer is placed on numa_node.
+ *
+ * @throws BadParameterError if the socket could not be set up or added to the shared reader engine.
+ */
+void AttachedStream::start(StreamWorkerPool *pool, std::string interface, const advanced_optimizations_struct &optimizations,
+		const advanced_configuration_struct &configuration, int numa_node) throw (BadParameterError) {
+	if (m_running) {
+		return;
+	}
+
+	pktbuffer.pool().set_memory_options(optimizations.huge_page_buffer, optimizations.lock_buffer_memory);
+	pktbuffer.pool().set_numa_node(optimizations.numa_placement ? numa_node : -1);
+	pktbuffer.initialize(optimizations.buffer_size, optimizations.zero_copy_receive);
+	if (pktbuffer.pool().lock_error()) {
+		LOG_WARN(AttachedStream, "Could not lock the packet buffer of stream " << id << " into memory: " << strerror(pktbuffer.pool().lock_error()));
+	}
+
+	try {
+		socketReader.setSocketBufferSize(optimizations.udp_socket_buffer_size);
+		socketReader.setPktsPerRead(optimizations.pkts_per_socket_read);
+		socketReader.setOverflowPolicy(optimizations.overflow_policy);
+		socketReader.setConnectionInfo(interface, multicastAddress, vlan, port);
+	} catch (BadParameterError &e) {
+		pktbuffer.shutDown();
+		pktbuffer.pool().release();
+		throw;
+	}
+
+	sddsToBulkIO.setPktsPerRead(optimizations.sdds_pkts_per_bulkio_push);
+	sddsToBulkIO.setPushOnTTV(configuration.push_on_ttv);
+	sddsToBulkIO.setWaitForTTV(configuration.wait_on_ttv);
+	sddsToBulkIO.startShared(&pktbuffer);
+
+	m_pool = pool;
+	m_pool->add(this);
+
+	if (not SharedReaderEngine::instance().attach(&socketReader, &pktbuffer, optimizations.check_for_duplicate_sender,
+			std::max(optimizations.shared_reader_threads, (unsigned short) 1), optimizations.shared_reader_budget,
+			boost::bind(&AttachedStream::onRead, this))) {
+		m_pool->remove(this);
+		sddsToBulkIO.stopShared();
+		pktbuffer.shutDown();
+		pktbuffer.pool().release();
+		throw BadParameterError("Failed to add the socket of stream " + id + " to the shared reader engine");
+	}
+
+	m_running = true;
+	LOG_DEBUG(AttachedStream, "Started stream " << id << " on " << multicastAddress << ":" << port);
+}
+
+/**
+ * Stops reading the socket and processing the stream, pushing an EOS for it, then frees the packet buffer.
+ */
+void AttachedStream::stop() {
+	if (not m_running) {
+		return;
+	}
+
+	SharedReaderEngine::instance().detach(&socketReader);
+	m_pool->remove(this);
+	sddsToBulkIO.stopShared();
+	pktbuffer.shutDown();
+	m_running = false;
+	LOG_DEBUG(AttachedStream, "Stopped stream " << id);
+}
+
+bool AttachedStream::isRunning() {
+	return m_running;
+}
+
+/**
+ * Run by a stream worker, makes a few pushes from the packets waiting.
+ */
+bool AttachedStream::runTask() {
+	return sddsToBulkIO.processShared(ATTACHED_STREAM_PUSHES_PER_TURN);
+}
+
+/**
+ * Called by the shared reader engine after each read of the socket, queues the stream on a worker once there is
+ * enough for a push.
+ */
+void AttachedStream::onRead() {
+	if (sddsToBulkIO.sharedReady()) {
+		m_pool->schedule(this);
+	}
+}
@@ -0,0 +1,74 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * AttachedStream.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#ifndef ATTACHEDSTREAM_H_
+#define ATTACHEDSTREAM_H_
+
+#include "LockFreePacketBuffer.h"
+#include "SocketReader.h"
+#include "SddsToBulkIOProcessor.h"
+#include "StreamWorkerPool.h"
+#include "struct_props.h"
+#include "ossie/debug.h"
+
+// The most BulkIO pushes a stream makes each turn on a stream worker before the next queued stream gets its turn.
+#define ATTACHED_STREAM_PUSHES_PER_TURN 4
+
+/**
+ * One of the SDDS streams attached after the first. It has its own packet buffer, socket reader and SDDS to BulkIO
+ * processor like the first, but the socket is read by the shared reader engine and the packets are processed on the
+ * stream worker pool rather than on threads of its own.
+ */
+class AttachedStream : public StreamWorkerPool::Task {
+	ENABLE_LOGGING
+public:
+	AttachedStream(const BULKIO::SDDSStreamDefinition& stream, std::string attach_id,
+			bulkio::OutOctetPort *octet_out, bulkio::OutShortPort *short_out, bulkio::OutFloatPort *float_out);
+	virtual ~AttachedStream();
+
+	void start(StreamWorkerPool *pool, std::string interface, const advanced_optimizations_struct &optimizations,
+			const advanced_configuration_struct &configuration, int numa_node) throw (BadParameterError);
+	void stop();
+	bool isRunning();
+	bool runTask();
+
+	std::string id;
+	std::string multicastAddress;
+	uint16_t vlan;
+	uint16_t port;
+
+	LockFreePacketBuffer pktbuffer;
+	SocketReader socketReader;
+	SddsToBulkIOProcessor sddsToBulkIO;
+
+private:
+	void onRead();
+
+	StreamWorkerPool *m_pool;
+	bool m_running;
+};
+
+#endif /* ATTACHEDSTREAM_H_ */
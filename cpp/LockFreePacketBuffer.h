@@ -0,0 +1,377 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * LockFreePacketBuffer.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#ifndef LOCKFREEPACKETBUFFER_H_
+#define LOCKFREEPACKETBUFFER_H_
+
+#include <errno.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+#include <vector>
+#include "PacketBuffer.h"
+#include "ossie/debug.h"
+
+#define CACHE_LINE_SIZE 64
+
+// How many times a consumer re-checks a ring before going to sleep on the futex.
+#define SPSC_SPIN_COUNT 1000
+
+// The maximum time (in ms) spent asleep on the futex before re-checking for a shut down.
+#define SPSC_MAX_WAIT_MS 100
+
+// On x86 loads are not reordered with other loads and stores are not reordered with other stores
+// so acquire / release only needs to stop the compiler from reordering. Everywhere else use a full fence.
+#if defined(__x86_64__) || defined(__i386__)
+#define SPSC_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#define SPSC_BARRIER() __sync_synchronize()
+#endif
+
+// Tells the CPU a spin loop is running so it backs off the cache line being polled and gives the sibling hyperthread its share.
+#if defined(__x86_64__) || defined(__i386__)
+#define SPSC_PAUSE() __builtin_ia32_pause()
+#else
+#define SPSC_PAUSE() SPSC_BARRIER()
+#endif
+
+/**
+ * A bounded single producer, single consumer ring. The producer and consumer indexes live on
+ * their own cache lines and each side keeps a cached copy of the other sides index so that
+ * the shared cache line is only touched when the cached copy says the ring is full / empty.
+ *
+ * When a consumer cannot be satisfied it spins briefly and then sleeps on a futex. The producer
+ * only makes the futex wake system call if the consumer has flagged that it is asleep.
+ */
+template <class V>
+class SpscRing {
+public:
+	SpscRing(): m_mask(0) {
+		reset(0);
+	}
+
+	/**
+	 * Resizes the ring to hold at least capacity elements and empties it.
+	 * Must not be called while either side is in use.
+	 */
+	void reset(size_t capacity) {
+		size_t size = 1;
+		while (size < capacity) {
+			size <<= 1;
+		}
+
+		m_slots.clear();
+		m_slots.resize(size);
+		m_mask = size - 1;
+		m_prod.tail = 0;
+		m_prod.cached_head = 0;
+		m_cons.head = 0;
+		m_cons.cached_tail = 0;
+		m_wait.seq = 0;
+		m_wait.sleeping = 0;
+	}
+
+	/**
+	 * Number of elements currently in the ring. Only exact when called from one of the two sides.
+	 */
+	size_t size() const {
+		// Read the head first, it can never pass the tail that is read after it.
+		size_t head = m_cons.head;
+		SPSC_BARRIER();
+		return m_prod.tail - head;
+	}
+
+	/**
+	 * Producer side. Copies num elements starting at first into the ring, returns false and does
+	 * nothing if there is not room for all of them.
+	 */
+	template <typename Iterator>
+	bool push(Iterator first, size_t num) {
+		size_t tail = m_prod.tail;
+		if (m_slots.size() - (tail - m_prod.cached_head) < num) {
+			m_prod.cached_head = m_cons.head;
+			SPSC_BARRIER();
+			if (m_slots.size() - (tail - m_prod.cached_head) < num) {
+				return false;
+			}
+		}
+
+		for (size_t i = 0; i < num; ++i, ++first) {
+			m_slots[(tail + i) & m_mask] = *first;
+		}
+
+		SPSC_BARRIER();
+		m_prod.tail = tail + num;
+
+		// Full barrier so the check of the sleeping flag can not be reordered above the tail store.
+		__sync_fetch_and_add(&m_wait.seq, 1);
+		if (m_wait.sleeping) {
+			futex(FUTEX_WAKE_PRIVATE, 1, NULL);
+		}
+		return true;
+	}
+
+	/**
+	 * Consumer side. Returns the number of elements which can be popped without blocking.
+	 */
+	size_t available() {
+		size_t avail = m_cons.cached_tail - m_cons.head;
+		if (avail == 0) {
+			m_cons.cached_tail = m_prod.tail;
+			SPSC_BARRIER();
+			avail = m_cons.cached_tail - m_cons.head;
+		}
+		return avail;
+	}
+
+	/**
+	 * Consumer side. Element i of the next available elements, i must be less than available().
+	 */
+	V& peek(size_t i) {
+		return m_slots[(m_cons.head + i) & m_mask];
+	}
+
+	/**
+	 * Consumer side. Releases the first num elements back to the producer.
+	 */
+	void consume(size_t num) {
+		SPSC_BARRIER();
+		m_cons.head += num;
+	}
+
+	/**
+	 * Consumer side. Waits until at least num elements are available or abort becomes true. If a timeout
+	 * (in ms) is given the wait also ends after the first time the consumer sleeps, which is at most that long.
+	 * Returns true if num elements are available.
+	 */
+	bool wait_for(size_t num, const volatile bool &abort, long timeout_ms = -1) {
+		for (size_t spin = 0; spin < SPSC_SPIN_COUNT; ++spin) {
+			if (available_fresh() >= num || abort) {
+				return m_cons.cached_tail - m_cons.head >= num;
+			}
+			SPSC_PAUSE();
+		}
+
+		long wait_ms = (timeout_ms >= 0 && timeout_ms < SPSC_MAX_WAIT_MS) ? timeout_ms : SPSC_MAX_WAIT_MS;
+		struct timespec timeout;
+		timeout.tv_sec = 0;
+		timeout.tv_nsec = wait_ms * 1000000L;
+
+		bool slept = false;
+		while (true) {
+			int seq = m_wait.seq;
+			m_wait.sleeping = 1;
+			__sync_synchronize();
+			if (available_fresh() >= num || abort || (slept && timeout_ms >= 0)) {
+				break;
+			}
+			futex(FUTEX_WAIT_PRIVATE, seq, &timeout);
+			slept = true;
+		}
+		m_wait.sleeping = 0;
+		return m_cons.cached_tail - m_cons.head >= num;
+	}
+
+	/**
+	 * Wakes the consumer if it is sleeping, used on shut down.
+	 */
+	void wake() {
+		__sync_fetch_and_add(&m_wait.seq, 1);
+		futex(FUTEX_WAKE_PRIVATE, 1, NULL);
+	}
+
+private:
+	SpscRing(const SpscRing&);
+	SpscRing& operator = (const SpscRing&);
+
+	/**
+	 * The socket reader decides what to do based on errno after each read so the futex calls,
+	 * which are made in between reads, must leave it untouched.
+	 */
+	void futex(int op, int val, const struct timespec *timeout) {
+		int saved_errno = errno;
+		syscall(SYS_futex, &m_wait.seq, op, val, timeout, NULL, 0);
+		errno = saved_errno;
+	}
+
+	size_t available_fresh() {
+		m_cons.cached_tail = m_prod.tail;
+		SPSC_BARRIER();
+		return m_cons.cached_tail - m_cons.head;
+	}
+
+	std::vector<V> m_slots;
+	size_t m_mask;
+
+	// Padding on either side of each group so they can not share a cache line regardless of the alignment of the ring.
+	char m_pad0[CACHE_LINE_SIZE];
+	struct {
+		volatile size_t tail;
+		size_t cached_head;
+	} m_prod;
+	char m_pad1[CACHE_LINE_SIZE];
+	struct {
+		volatile size_t head;
+		size_t cached_tail;
+	} m_cons;
+	char m_pad2[CACHE_LINE_SIZE];
+	struct {
+		volatile int seq;
+		volatile int sleeping;
+	} m_wait;
+	char m_pad3[CACHE_LINE_SIZE];
+};
+
+/**
+ * A lock free alternative to the SmartPacketBuffer made from two single producer single consumer rings.
+ * The full ring is fed by the socket reader and drained by the SDDS to BulkIO processor and the free ring
+ * is fed by the processor and drained by the socket reader, so in the steady state neither thread ever
+ * takes a lock or makes a system call unless the other side has gone idle.
+ *
+ * The one exception is recycle_buffers, which the socket reader also calls to hand back its buffers when
+ * it exits. A spin lock that is uncontended in the steady state keeps the free ring single producer.
+ *
+ * Unlike the SmartPacketBuffer, shutDown does not empty the rings since the threads may still be using
+ * them. They are reset on the next call to initialize.
+ */
+class LockFreePacketBuffer : public PacketBuffer {
+public:
+
+	explicit LockFreePacketBuffer(): m_shuttingDown(false), m_recycle_lock(0) {}
+
+	/**
+	 * Sizes both rings to hold capacity buffers, allocates the pool and fills the
+	 * free ring with a handle to every packet in it. Must not be called while the
+	 * threads using this buffer are running. See SddsPacketPool for split_data.
+	 */
+	void initialize(size_type capacity, bool split_data) {
+		m_pool.initialize(capacity, split_data);
+		initialize_partition(m_pool, 0, capacity);
+	}
+
+	/**
+	 * As initialize but cycles the count packets starting at first of a pool owned
+	 * by the caller, so several packet buffers can share one pool.
+	 */
+	void initialize_partition(SddsPacketPool &pool, PacketHandle first, size_type count) {
+		m_poolp = &pool;
+		m_capacity = count;
+		m_full.reset(count);
+		m_free.reset(count);
+
+		for (PacketHandle h = first; h < first + count; ++h) {
+			m_free.push(&h, 1);
+		}
+		m_shuttingDown = false;
+	}
+
+	/**
+	 * Wakes any sleeping thread, after this call the pop methods return immediately
+	 * and the push / recycle methods drop what they are handed.
+	 */
+	void shutDown() {
+		m_shuttingDown = true;
+		__sync_synchronize();
+		m_full.wake();
+		m_free.wake();
+	}
+
+	void pop_empty_buffers(container_type &que, size_t len) {
+		if (m_shuttingDown || que.size() >= len) {return;}
+
+		size_t request = len - que.size();
+		m_free.wait_for(request, m_shuttingDown);
+		if (m_shuttingDown) {return;}
+
+		// Keep the order of the ring, the socket reader expects the new buffers at the front.
+		for (size_t i = request; i > 0; --i) {
+			que.push_front(m_free.peek(i - 1));
+		}
+		m_free.consume(request);
+	}
+
+	void push_full_buffers(container_type &que, size_t num) {
+		if (not m_shuttingDown) {
+			// The ring is sized to hold every buffer so this can only fail if a buffer was not
+			// obtained from pop_empty_buffers.
+			if (not m_full.push(que.begin(), num)) {
+				RH_NL_ERROR("LockFreePacketBuffer", "The full buffer ring has no room for " << num << " buffers, they were not taken from this buffer and are dropped");
+			}
+		}
+		que.erase(que.begin(), que.begin() + num);
+	}
+
+	void pop_full_buffers(container_type &que, size_t len) {
+		if (m_shuttingDown || que.size() >= len) {return;}
+
+		size_t request = len - que.size();
+		m_full.wait_for(request, m_shuttingDown);
+		if (m_shuttingDown) {return;}
+
+		for (size_t i = 0; i < request; ++i) {
+			que.push_back(m_full.peek(i));
+		}
+		m_full.consume(request);
+	}
+
+	void recycle_buffers(container_type &que) {
+		if (not m_shuttingDown and not que.empty()) {
+			while (__sync_lock_test_and_set(&m_recycle_lock, 1)) {
+				SPSC_PAUSE();
+			}
+			// As in push_full_buffers the ring can hold every buffer, so only buffers not taken from here can fail
+			bool pushed = m_free.push(que.begin(), que.size());
+			__sync_lock_release(&m_recycle_lock);
+			if (not pushed) {
+				RH_NL_ERROR("LockFreePacketBuffer", "The free buffer ring has no room for " << que.size() << " recycled buffers, they were not taken from this buffer and are dropped");
+			}
+		}
+		que.clear();
+	}
+
+	size_t get_num_full_buffers() {
+		return m_full.size();
+	}
+
+	size_t get_num_empty_buffers() {
+		return m_free.size();
+	}
+
+private:
+	// Merges several of these by reading their full rings directly.
+	friend class MergePacketBuffer;
+
+	LockFreePacketBuffer(const LockFreePacketBuffer&);              // Disabled copy constructor
+	LockFreePacketBuffer& operator = (const LockFreePacketBuffer&); // Disabled assign operator
+
+	volatile bool m_shuttingDown;
+	volatile int m_recycle_lock;
+	SpscRing<PacketHandle> m_full;
+	SpscRing<PacketHandle> m_free;
+};
+
+#endif /* LOCKFREEPACKETBUFFER_H_ */
@@ -0,0 +1,288 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * MergePacketBuffer.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#ifndef MERGEPACKETBUFFER_H_
+#define MERGEPACKETBUFFER_H_
+
+#include <time.h>
+#include <vector>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include "LockFreePacketBuffer.h"
+#include "socketUtils/sequenceshare.h"
+
+// How long (in ms) the merge waits for a lane whose turn it is while the other lanes have packets before it gives up
+// on the missing packets.
+#define MERGE_STALL_MS 10
+
+/**
+ * Combines the packets of several socket readers receiving on the same address back into a single stream in sequence
+ * number order. The kernel gives reader i the runs of SEQUENCE_SHARE_CHUNK sequence numbers which sequence_share
+ * assigns to it, see SocketReader::setReaderShare, and within a socket the packets stay in order. So the merge only
+ * has to follow the sequence numbers from lane to lane, one run at a time.
+ *
+ * Each socket reader gets its own lane, a LockFreePacketBuffer cycling its own partition of the shared pool, and the
+ * SDDS to BulkIO processor uses the MergePacketBuffer itself. No lock is shared between readers, pop_full_buffers
+ * reads the lanes directly and recycle_buffers hands each buffer back to the lane it came from.
+ *
+ * If the packets the merge is waiting for were lost it moves on to the next packet present once another lane holds
+ * half of its buffers or it has waited MERGE_STALL_MS, the SDDS to BulkIO processor then counts the gap as dropped
+ * packets just as it would with a single reader. Packets arriving after the merge has moved past them are recycled.
+ */
+class MergePacketBuffer : public PacketBuffer {
+public:
+
+	explicit MergePacketBuffer(): m_shuttingDown(false), m_partition(0), m_synced(false), m_restart(false), m_sync_start(0), m_expected(0) {
+		set_num_lanes(1);
+	}
+
+	/**
+	 * Sets the number of lanes, one per socket reader. Must not be called while the threads using this buffer are running.
+	 */
+	void set_num_lanes(size_t num) {
+		m_lanes.clear();
+		for (size_t i = 0; i < num; ++i) {
+			m_lanes.push_back(new LockFreePacketBuffer());
+		}
+		m_recycle.assign(num, container_type());
+		m_late.assign(num, container_type());
+	}
+
+	size_t get_num_lanes() {
+		return m_lanes.size();
+	}
+
+	/**
+	 * The packet buffer socket reader index must use.
+	 */
+	PacketBuffer& lane(size_t index) {
+		return m_lanes[index];
+	}
+
+	/**
+	 * Allocates the pool and gives each lane an equal share of it, any remainder is left unused.
+	 */
+	void initialize(size_type capacity, bool split_data) {
+		m_pool.initialize(capacity, split_data);
+		m_capacity = capacity;
+		m_partition = capacity / m_lanes.size();
+
+		for (size_t i = 0; i < m_lanes.size(); ++i) {
+			m_lanes[i].initialize_partition(m_pool, i * m_partition, m_partition);
+			m_recycle[i].clear();
+			m_recycle[i].set_capacity(m_partition);
+			m_late[i].clear();
+			m_late[i].set_capacity(m_partition);
+		}
+		m_synced = false;
+		m_restart = false;
+		m_sync_start = 0;
+		m_shuttingDown = false;
+	}
+
+	void shutDown() {
+		m_shuttingDown = true;
+		for (size_t i = 0; i < m_lanes.size(); ++i) {
+			m_lanes[i].shutDown();
+		}
+	}
+
+	/**
+	 * The socket readers use their lane, these forward to the first one.
+	 */
+	void pop_empty_buffers(container_type &que, size_t len) {
+		m_lanes[0].pop_empty_buffers(que, len);
+	}
+
+	void push_full_buffers(container_type &que, size_t num) {
+		m_lanes[0].push_full_buffers(que, num);
+	}
+
+	void pop_full_buffers(container_type &que, size_t len) {
+		uint64_t stall_start = 0;
+
+		while (que.size() < len and not m_shuttingDown) {
+			if (not m_synced and not sync(m_restart)) {
+				m_lanes[0].m_full.wait_for(1, m_shuttingDown, 1);
+				continue;
+			}
+
+			size_t l = sequence_share(m_expected, m_lanes.size());
+			SpscRing<PacketHandle> &full = m_lanes[l].m_full;
+
+			if (full.available() == 0) {
+				bool others = false;
+				bool others_filling = false;
+				for (size_t i = 0; i < m_lanes.size(); ++i) {
+					size_t avail = (i == l) ? 0 : m_lanes[i].m_full.available();
+					others = others or avail > 0;
+					others_filling = others_filling or (avail > 0 and avail >= m_partition / 2);
+				}
+
+				// The parity packet which ends each run is normally not sent
+				if (m_expected % SEQUENCE_SHARE_CHUNK == SEQUENCE_SHARE_CHUNK - 1) {
+					m_expected++;
+					continue;
+				}
+
+				if (others) {
+					uint64_t now = monotonicMillis();
+					if (stall_start == 0) {
+						stall_start = now;
+					}
+					if (others_filling or now - stall_start >= MERGE_STALL_MS) {
+						// Carry on from whichever packet is next
+						m_synced = false;
+						m_restart = true;
+						stall_start = 0;
+						continue;
+					}
+				}
+
+				full.wait_for(1, m_shuttingDown, others ? 1 : SPSC_MAX_WAIT_MS);
+				continue;
+			}
+			stall_start = 0;
+
+			PacketHandle handle = full.peek(0);
+			uint16_t seq = m_pool.header(handle)->get_seq();
+			uint16_t ahead = seq - m_expected;
+
+			if (ahead >= 0x8000) {
+				// Too late, the merge already moved past it
+				full.consume(1);
+				m_late[l].push_back(handle);
+				m_lanes[l].recycle_buffers(m_late[l]);
+			} else if (ahead < SEQUENCE_SHARE_CHUNK - m_expected % SEQUENCE_SHARE_CHUNK) {
+				full.consume(1);
+				que.push_back(handle);
+				m_expected = seq + 1;
+			} else {
+				// The rest of this run was lost, the lane has already started on its next one
+				m_expected += SEQUENCE_SHARE_CHUNK - m_expected % SEQUENCE_SHARE_CHUNK;
+			}
+		}
+	}
+
+	void recycle_buffers(container_type &que) {
+		for (container_type::iterator it = que.begin(); it != que.end(); ++it) {
+			m_recycle[lane_of(*it)].push_back(*it);
+		}
+		for (size_t i = 0; i < m_lanes.size(); ++i) {
+			if (not m_recycle[i].empty()) {
+				m_lanes[i].recycle_buffers(m_recycle[i]);
+			}
+		}
+		que.clear();
+	}
+
+	size_t get_num_full_buffers() {
+		size_t num = 0;
+		for (size_t i = 0; i < m_lanes.size(); ++i) {
+			num += m_lanes[i].get_num_full_buffers();
+		}
+		return num;
+	}
+
+	size_t get_num_empty_buffers() {
+		size_t num = 0;
+		for (size_t i = 0; i < m_lanes.size(); ++i) {
+			num += m_lanes[i].get_num_empty_buffers();
+		}
+		return num;
+	}
+
+private:
+	MergePacketBuffer(const MergePacketBuffer&);              // Disabled copy constructor
+	MergePacketBuffer& operator = (const MergePacketBuffer&); // Disabled assign operator
+
+	static uint64_t monotonicMillis() {
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+	}
+
+	size_t lane_of(PacketHandle handle) {
+		size_t l = handle / m_partition;
+		return (l < m_lanes.size()) ? l : m_lanes.size() - 1;
+	}
+
+	/**
+	 * Starts the merge from the earliest packet at the head of a lane, returns false if every lane is empty. When
+	 * restarting after packets were lost any packet the merge has already moved past is recycled.
+	 *
+	 * The readers do not all deliver their first packets at the same moment, so the very first time the lanes are
+	 * given MERGE_STALL_MS (or until one holds half its buffers) to catch up before picking where to start.
+	 */
+	bool sync(bool restart) {
+		bool found = false;
+		bool filling = false;
+		uint16_t earliest = 0;
+		for (size_t i = 0; i < m_lanes.size(); ++i) {
+			SpscRing<PacketHandle> &full = m_lanes[i].m_full;
+			while (restart and full.available() and (int16_t) (m_pool.header(full.peek(0))->get_seq() - m_expected) < 0) {
+				m_late[i].push_back(full.peek(0));
+				full.consume(1);
+			}
+			if (not m_late[i].empty()) {
+				m_lanes[i].recycle_buffers(m_late[i]);
+			}
+
+			filling = filling or full.available() >= m_partition / 2;
+			if (full.available()) {
+				uint16_t seq = m_pool.header(full.peek(0))->get_seq();
+				if (not found or (int16_t) (seq - earliest) < 0) {
+					earliest = seq;
+					found = true;
+				}
+			}
+		}
+		if (found and not restart and not filling) {
+			uint64_t now = monotonicMillis();
+			if (m_sync_start == 0) {
+				m_sync_start = now;
+			}
+			found = now - m_sync_start >= MERGE_STALL_MS;
+		}
+
+		if (found) {
+			m_expected = earliest;
+			m_synced = true;
+		}
+		return found;
+	}
+
+	volatile bool m_shuttingDown;
+	size_t m_partition;
+	bool m_synced;
+	bool m_restart;
+	uint64_t m_sync_start;
+	uint16_t m_expected;
+	boost::ptr_vector<LockFreePacketBuffer> m_lanes;
+	std::vector<container_type> m_recycle;
+	std::vector<container_type> m_late; // Packets the merge recycles itself, kept apart so recycle_buffers may run on another thread
+};
+
+#endif /* MERGEPACKETBUFFER_H_ */
@@ -0,0 +1,134 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * PacketBuffer.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#ifndef PACKETBUFFER_H_
+#define PACKETBUFFER_H_
+
+#include <stddef.h>
+#include "SddsPacketPool.h"
+
+/**
+ * The interface shared by the internal packet buffers which sit between the socket reader
+ * and the SDDS to BulkIO processor. Every method operates on a batch of buffers so the cost
+ * of the virtual call is paid once per socket read / BulkIO push and not once per packet.
+ *
+ * You MUST follow this cycle: pop_empty_buffers -> push_full_buffers -> pop_full_buffers -> recycle_buffers
+ * The socket reader is the only caller of pop_empty_buffers and push_full_buffers and the SDDS to BulkIO
+ * processor is the only caller of pop_full_buffers and recycle_buffers, implementations are allowed to
+ * rely on this. The one exception is that when the processor converts on several threads its sequencer
+ * thread makes the recycle_buffers calls, so recycle_buffers must not share state with pop_full_buffers.
+ *
+ * The buffers themselves live in the packet pool owned by this class, what moves between the containers
+ * are handles into that pool. Use get to turn a handle into a packet.
+ */
+class PacketBuffer {
+public:
+	typedef PacketHandleQueue container_type;
+	typedef container_type::size_type size_type;
+
+	PacketBuffer(): m_poolp(&m_pool), m_capacity(0) {}
+	virtual ~PacketBuffer() {}
+
+	/**
+	 * Allocates the pool with room for capacity packets and places a handle to each
+	 * of them in the empty buffers container. See SddsPacketPool for split_data.
+	 */
+	virtual void initialize(size_type capacity, bool split_data) = 0;
+
+	/**
+	 * Releases any thread blocked within the buffer. After a call to shutDown
+	 * initialize must be called again before the buffer can be used.
+	 */
+	virtual void shutDown() = 0;
+
+	/**
+	 * Fill the provided container until it is len in size of empty buffers. New buffers
+	 * are placed at the front of the container. Blocks until the request can be satisfied.
+	 */
+	virtual void pop_empty_buffers(container_type &que, size_t len) = 0;
+
+	/**
+	 * Moves the first num buffers of the provided container into the full buffers container.
+	 */
+	virtual void push_full_buffers(container_type &que, size_t num) = 0;
+
+	/**
+	 * Fill the provided container until it is len in size of full buffers. New buffers
+	 * are placed at the end of the container. Blocks until the request can be satisfied.
+	 */
+	virtual void pop_full_buffers(container_type &que, size_t len) = 0;
+
+	/**
+	 * Returns all buffers in the provided container to the empty buffers container and clears it.
+	 */
+	virtual void recycle_buffers(container_type &que) = 0;
+
+	/**
+	 * Moves the num oldest full buffers, those not yet taken by pop_full_buffers, back to the empty buffers
+	 * container if there are at least num of them, otherwise moves none. Returns the number moved. Only the
+	 * socket reader calls this, buffers which cannot take full buffers back from that side always return 0.
+	 */
+	virtual size_t reclaim_full_buffers(size_t num) { return 0; }
+
+	/**
+	 * Called by the socket reader when it is short of the num empty buffers it wants and is about to drop or reclaim
+	 * packets rather than wait for them, so an elastic buffer still sees the pressure, and with num 0 when a wait for
+	 * packets times out, so it sees the quiet. Does nothing by default.
+	 */
+	virtual void check_capacity(size_t num) {}
+
+	/**
+	 * Returns the number of buffers waiting to be worked.
+	 */
+	virtual size_t get_num_full_buffers() = 0;
+
+	/**
+	 * Returns the number of buffers available to be filled.
+	 */
+	virtual size_t get_num_empty_buffers() = 0;
+
+	/**
+	 * Returns the header / data of the packet the provided handle refers to.
+	 */
+	SDDSheader* header(PacketHandle handle) { return m_poolp->header(handle); }
+	uint8_t* data(PacketHandle handle) { return m_poolp->data(handle); }
+
+	SddsPacketPool& pool() { return *m_poolp; }
+
+	/**
+	 * Returns the number of buffers which cycle through this packet buffer.
+	 */
+	size_type capacity() const { return m_capacity; }
+
+protected:
+	SddsPacketPool m_pool;
+
+	// Points at m_pool unless the buffers belong to a pool shared with other packet buffers, see MergePacketBuffer.
+	SddsPacketPool *m_poolp;
+	size_type m_capacity;
+};
+
+#endif /* PACKETBUFFER_H_ */
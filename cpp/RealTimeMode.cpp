@@ -0,0 +1,212 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * RealTimeMode.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#include "RealTimeMode.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <stdint.h>
+#include <fstream>
+
+PREPARE_LOGGING(RealTimeMode)
+
+RealTimeMode::RealTimeMode():
+	m_enabled(false),
+	m_priority(0),
+	m_memory_locked(false),
+	m_dma_latency_fd(-1)
+{
+}
+
+/**
+ * Lets go of /dev/cpu_dma_latency, which puts the CPU idle states back as they were.
+ */
+RealTimeMode::~RealTimeMode() {
+	disable();
+}
+
+/**
+ * Applies the process wide parts of real time mode and readies the per thread parts for threads started after this
+ * call at the SCHED_FIFO priority given. Forgets the failures of any earlier start.
+ *
+ * Memory locked by mlockall stays locked for the life of the process, it cannot be undone for this component alone
+ * without also unlocking memory other components in the process locked.
+ */
+void RealTimeMode::enable(int priority) {
+	{
+		boost::mutex::scoped_lock lock(m_failures_lock);
+		m_failures.clear();
+	}
+	m_priority = priority;
+
+	// Once all future memory is locked any mapping past the memory lock limit fails, thread stacks included
+	if (not m_memory_locked) {
+		if (not canLockAllMemory()) {
+			addFailure("mlockall", "ulimit -l is not unlimited");
+		} else if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+			m_memory_locked = true;
+		} else {
+			addFailure("mlockall", strerror(errno));
+		}
+	}
+
+	// The requested latency only holds while the file is open
+	if (m_dma_latency_fd < 0) {
+		int32_t latency_us = 0;
+		m_dma_latency_fd = open("/dev/cpu_dma_latency", O_WRONLY);
+		if (m_dma_latency_fd < 0) {
+			addFailure("cpu_dma_latency", strerror(errno));
+		} else if (write(m_dma_latency_fd, &latency_us, sizeof(latency_us)) != sizeof(latency_us)) {
+			addFailure("cpu_dma_latency", strerror(errno));
+			close(m_dma_latency_fd);
+			m_dma_latency_fd = -1;
+		}
+	}
+
+	m_enabled = true;
+}
+
+/**
+ * Stops applying real time mode to new threads and closes /dev/cpu_dma_latency.
+ */
+void RealTimeMode::disable() {
+	m_enabled = false;
+	if (m_dma_latency_fd >= 0) {
+		close(m_dma_latency_fd);
+		m_dma_latency_fd = -1;
+	}
+}
+
+bool RealTimeMode::enabled() {
+	return m_enabled;
+}
+
+/**
+ * The entry point of a real time thread, readies the calling thread if real time mode is enabled then runs body.
+ */
+void RealTimeMode::run(boost::function<void ()> body) {
+	if (m_enabled) {
+		if (prctl(PR_SET_TIMERSLACK, 1UL, 0UL, 0UL, 0UL) != 0) {
+			addFailure("timer slack", strerror(errno));
+		}
+		prefaultStack();
+	}
+	body();
+}
+
+/**
+ * Schedules thread SCHED_FIFO at the real time priority. Returns 0 on success.
+ */
+int RealTimeMode::setThreadPolicy(pthread_t thread, const std::string &thread_desc) {
+	struct sched_param param;
+	param.sched_priority = m_priority;
+
+	int retVal = pthread_setschedparam(thread, SCHED_FIFO, &param);
+	if (retVal != 0) {
+		addFailure("SCHED_FIFO for the " + thread_desc, strerror(retVal));
+	}
+	return retVal;
+}
+
+/**
+ * Empty if real time mode is not enabled, applied if every part of it was, otherwise the parts which were not.
+ */
+std::string RealTimeMode::getStatus() {
+	if (not m_enabled) {
+		return "";
+	}
+
+	boost::mutex::scoped_lock lock(m_failures_lock);
+	if (m_failures.empty()) {
+		return "applied";
+	}
+
+	std::string status = "not applied: ";
+	for (size_t i = 0; i < m_failures.size(); ++i) {
+		if (i > 0) {
+			status += ", ";
+		}
+		status += m_failures[i];
+	}
+	return status;
+}
+
+/**
+ * Writes the first REAL_TIME_STACK_PREFAULT bytes below the calling frame so the thread takes its stack page faults now
+ * rather than part way through a read or a push. With memory locked the pages then stay resident. Never inlined, so the
+ * thread's body does not run below the written bytes.
+ */
+__attribute__((noinline)) void RealTimeMode::prefaultStack() {
+	volatile char stack[REAL_TIME_STACK_PREFAULT];
+	size_t page_size = sysconf(_SC_PAGESIZE);
+	for (size_t i = 0; i < sizeof(stack); i += page_size) {
+		stack[i] = 0;
+	}
+}
+
+/**
+ * True if the memory lock limit cannot stop the process mapping more memory once all of it is locked, either as the
+ * limit is unlimited or as the process has CAP_IPC_LOCK, which bypasses it.
+ */
+bool RealTimeMode::canLockAllMemory() {
+	struct rlimit limit;
+	if (getrlimit(RLIMIT_MEMLOCK, &limit) == 0 && limit.rlim_cur == RLIM_INFINITY) {
+		return true;
+	}
+
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line)) {
+		if (line.compare(0, 7, "CapEff:") == 0) {
+			unsigned long long caps = strtoull(line.c_str() + 7, NULL, 16);
+			return caps & (1ULL << CAP_IPC_LOCK_BIT);
+		}
+	}
+	return false;
+}
+
+/**
+ * Logs a part of real time mode which could not be applied and why, and keeps it for getStatus. The same failure on
+ * another thread is only kept once.
+ */
+void RealTimeMode::addFailure(const std::string &what, const std::string &reason) {
+	std::string failure = what + " (" + reason + ")";
+
+	boost::mutex::scoped_lock lock(m_failures_lock);
+	for (size_t i = 0; i < m_failures.size(); ++i) {
+		if (m_failures[i] == failure) {
+			return;
+		}
+	}
+	m_failures.push_back(failure);
+	LOG_WARN(RealTimeMode, "Real time mode could not apply " << failure << ", carrying on without it");
+}
@@ -0,0 +1,77 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * RealTimeMode.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#ifndef REALTIMEMODE_H_
+#define REALTIMEMODE_H_
+
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <boost/thread.hpp>
+#include <boost/function.hpp>
+#include "ossie/debug.h"
+
+// How much of each real time thread's stack is written when the thread starts so it never page faults on it later.
+#define REAL_TIME_STACK_PREFAULT (256*1024)
+
+// The bit of CAP_IPC_LOCK in the capability sets of /proc/self/status, see capabilities(7).
+#define CAP_IPC_LOCK_BIT 14
+
+/**
+ * Applies the real_time_mode advanced optimization. The process wide parts, locking all memory and holding
+ * /dev/cpu_dma_latency open at 0, are applied by enable. The per thread parts are applied to the component's threads,
+ * SCHED_FIFO by setThreadPolicy from the thread starting them and the timer slack and stack prefault by run on the
+ * thread itself. Threads the component's threads start inherit their policy and timer slack.
+ *
+ * Nothing which fails for want of a privilege stops the component, the failure is logged and kept for getStatus.
+ */
+class RealTimeMode {
+	ENABLE_LOGGING
+public:
+	RealTimeMode();
+	virtual ~RealTimeMode();
+
+	void enable(int priority);
+	void disable();
+	bool enabled();
+	void run(boost::function<void ()> body);
+	int setThreadPolicy(pthread_t thread, const std::string &thread_desc);
+	std::string getStatus();
+
+private:
+	volatile bool m_enabled;
+	int m_priority;
+	bool m_memory_locked;
+	int m_dma_latency_fd;
+	boost::mutex m_failures_lock;
+	std::vector<std::string> m_failures;
+
+	void prefaultStack();
+	static bool canLockAllMemory();
+	void addFailure(const std::string &what, const std::string &reason);
+};
+
+#endif /* REALTIMEMODE_H_ */
@@ -0,0 +1,414 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * SddsPacketPool.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#include "SddsPacketPool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#include <algorithm>
+#include <new>
+
+#define POOL_ALIGNMENT 64
+#define SDDS_DATA_BYTES (SDDS_psize - SDDS_hsize)
+
+static size_t roundUp(size_t value, size_t multiple) {
+	return (value + multiple - 1) / multiple * multiple;
+}
+
+/**
+ * The default huge page size of the kernel, 0 if it has none.
+ */
+static size_t hugePageSize() {
+	FILE *meminfo = fopen("/proc/meminfo", "r");
+	if (not meminfo) {
+		return 0;
+	}
+
+	char line[256];
+	unsigned long kb = 0;
+	while (fgets(line, sizeof(line), meminfo)) {
+		if (sscanf(line, "Hugepagesize: %lu kB", &kb) == 1) {
+			break;
+		}
+	}
+	fclose(meminfo);
+	return kb * 1024;
+}
+
+/**
+ * How many bytes of the mapping holding addr the kernel has backed with transparent huge pages.
+ */
+static size_t transparentHugeBytes(const void *addr) {
+	FILE *smaps = fopen("/proc/self/smaps", "r");
+	if (not smaps) {
+		return 0;
+	}
+
+	char line[512];
+	unsigned long start, end, kb = 0;
+	bool inside = false;
+	uintptr_t target = reinterpret_cast<uintptr_t>(addr);
+	while (fgets(line, sizeof(line), smaps)) {
+		if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+			if (inside) {
+				break;
+			}
+			inside = (start <= target and target < end);
+		} else if (inside and sscanf(line, "AnonHugePages: %lu kB", &kb) == 1) {
+			break;
+		}
+	}
+	fclose(smaps);
+	return kb * 1024;
+}
+
+SddsPacketPool::SddsPacketPool(): m_slab(NULL), m_mapped_bytes(0), m_header_base(NULL), m_data_base(NULL), m_header_stride(0),
+	m_data_stride(0), m_capacity(0), m_max_capacity(0), m_bytes(0), m_elastic(false), m_commit_align(0), m_data_offset(0),
+	m_header_committed(0), m_data_committed(0), m_split_data(false), m_huge_pages(true), m_lock_memory(true), m_numa_node(-1),
+	m_page_size(0), m_huge_tlb(false), m_locked_bytes(0), m_lock_error(0), m_mapped_huge_pages(false), m_mapped_lock_memory(false),
+	m_mapped_numa_node(-1), m_reused(false) {}
+
+SddsPacketPool::~SddsPacketPool() {
+	release();
+}
+
+/**
+ * Allocates a single slab large enough for capacity SDDS packets. Any previously
+ * allocated slab is freed first, unless it has the same capacity, max_capacity and layout and
+ * was mapped with the same memory options and NUMA node, in which case it is kept as it is
+ * (an elastic one back at capacity) and reused reports true.
+ * Throws std::bad_alloc if the memory cannot be allocated. See map_slab for how the memory is backed.
+ *
+ * When split_data is set the header array is placed at the start of the slab and the
+ * data array after it, starting on its own cache line.
+ *
+ * If max_capacity is more than capacity the slab is sized for max_capacity packets but only capacity are committed,
+ * see grow. Both arrays then start on a commit boundary, a huge page if huge pages are in use, so each can be committed
+ * a whole page at a time.
+ */
+void SddsPacketPool::initialize(size_t capacity, bool split_data, size_t max_capacity) {
+	if (m_slab and capacity and split_data == m_split_data and std::max(capacity, max_capacity) == m_max_capacity and
+			(m_elastic ? capacity < m_max_capacity : capacity == m_capacity) and m_huge_pages == m_mapped_huge_pages and
+			m_lock_memory == m_mapped_lock_memory and m_numa_node == m_mapped_numa_node) {
+		if (capacity < m_capacity) {
+			shrink(capacity);
+		} else if (capacity > m_capacity and not grow(capacity)) {
+			release();
+			throw std::bad_alloc();
+		}
+		m_reused = true;
+		return;
+	}
+
+	release();
+
+	if (capacity == 0) {
+		return;
+	}
+
+	m_max_capacity = std::max(capacity, max_capacity);
+	m_elastic = m_max_capacity > capacity;
+	if (m_elastic) {
+		m_commit_align = std::max(m_huge_pages ? hugePageSize() : 0, (size_t) sysconf(_SC_PAGESIZE));
+	}
+
+	size_t header_bytes = 0;
+	if (split_data) {
+		header_bytes = roundUp(m_max_capacity * SDDS_hsize, m_elastic ? m_commit_align : POOL_ALIGNMENT);
+	}
+	size_t bytes = split_data ? header_bytes + m_max_capacity * SDDS_DATA_BYTES : m_max_capacity * sizeof(SDDSpacket);
+
+	map_slab(bytes);
+	m_mapped_huge_pages = m_huge_pages;
+	m_mapped_lock_memory = m_lock_memory;
+	m_mapped_numa_node = m_numa_node;
+	m_data_offset = header_bytes;
+	m_split_data = split_data;
+	if (m_elastic) {
+		if (not grow(capacity)) {
+			release();
+			throw std::bad_alloc();
+		}
+	} else {
+		m_capacity = capacity;
+		m_bytes = bytes;
+	}
+
+	if (split_data) {
+		m_header_base = m_slab;
+		m_header_stride = SDDS_hsize;
+		m_data_base = m_slab + header_bytes;
+		m_data_stride = SDDS_DATA_BYTES;
+	} else {
+		m_header_base = m_slab;
+		m_header_stride = sizeof(SDDSpacket);
+		m_data_base = m_slab + SDDS_hsize;
+		m_data_stride = sizeof(SDDSpacket);
+	}
+}
+
+/**
+ * Commits the memory for the packets from the current capacity up to capacity, no more than max_capacity, binding,
+ * prefaulting and locking it as initialize does. Returns false, leaving the capacity as it was, if the pool is not
+ * elastic, is already that large or the memory could not be committed. The packets already in the pool do not move,
+ * so other threads may carry on using them while the pool grows.
+ */
+bool SddsPacketPool::grow(size_t capacity) {
+	capacity = std::min(capacity, m_max_capacity);
+	if (not m_elastic or capacity <= m_capacity) {
+		return false;
+	}
+
+	size_t header_end = m_split_data ? std::min(roundUp(capacity * SDDS_hsize, m_commit_align), m_data_offset) : 0;
+	size_t data_bytes = capacity * (m_split_data ? SDDS_DATA_BYTES : sizeof(SDDSpacket));
+	size_t data_end = std::min(roundUp(data_bytes, m_commit_align), m_mapped_bytes - m_data_offset);
+
+	if (header_end > m_header_committed) {
+		if (not commit_range(m_slab + m_header_committed, header_end - m_header_committed)) {
+			return false;
+		}
+		m_header_committed = header_end;
+	}
+	if (data_end > m_data_committed) {
+		if (not commit_range(m_slab + m_data_offset + m_data_committed, data_end - m_data_committed)) {
+			return false;
+		}
+		m_data_committed = data_end;
+	}
+
+	m_capacity = capacity;
+	m_bytes = m_header_committed + m_data_committed;
+	if (m_page_size == 0) {
+		size_t small_page = sysconf(_SC_PAGESIZE);
+		m_page_size = (m_commit_align > small_page and transparentHugeBytes(m_slab + m_data_offset) * 2 >= m_data_committed) ?
+				m_commit_align : small_page;
+	}
+	return true;
+}
+
+/**
+ * Gives the memory of the packets from capacity up back to the system, the pool then holds capacity packets. Every
+ * handle from capacity up must be out of use, the caller has to make sure no thread holds one.
+ */
+void SddsPacketPool::shrink(size_t capacity) {
+	if (not m_elastic or capacity >= m_capacity or capacity == 0) {
+		return;
+	}
+
+	size_t header_end = m_split_data ? roundUp(capacity * SDDS_hsize, m_commit_align) : 0;
+	size_t data_bytes = capacity * (m_split_data ? SDDS_DATA_BYTES : sizeof(SDDSpacket));
+	size_t data_end = roundUp(data_bytes, m_commit_align);
+
+	if (header_end < m_header_committed) {
+		decommit_range(m_slab + header_end, m_header_committed - header_end);
+		m_header_committed = header_end;
+	}
+	if (data_end < m_data_committed) {
+		decommit_range(m_slab + m_data_offset + data_end, m_data_committed - data_end);
+		m_data_committed = data_end;
+	}
+
+	m_capacity = capacity;
+	m_bytes = m_header_committed + m_data_committed;
+	m_locked_bytes = std::min(m_locked_bytes, m_bytes);
+}
+
+/**
+ * Frees the slab. Any handles still held by other threads are invalid after this call.
+ */
+void SddsPacketPool::release() {
+	if (m_slab) {
+		munmap(m_slab, m_mapped_bytes);
+	}
+	m_slab = NULL;
+	m_mapped_bytes = 0;
+	m_header_base = NULL;
+	m_data_base = NULL;
+	m_capacity = 0;
+	m_max_capacity = 0;
+	m_bytes = 0;
+	m_elastic = false;
+	m_commit_align = 0;
+	m_data_offset = 0;
+	m_header_committed = 0;
+	m_data_committed = 0;
+	m_page_size = 0;
+	m_huge_tlb = false;
+	m_locked_bytes = 0;
+	m_lock_error = 0;
+	m_reused = false;
+}
+
+/**
+ * Sets whether the next initialize backs the slab with huge pages and whether it locks the slab into memory, both
+ * are on by default. Neither is required, see map_slab for what happens when the system does not allow them.
+ */
+void SddsPacketPool::set_memory_options(bool huge_pages, bool lock_memory) {
+	m_huge_pages = huge_pages;
+	m_lock_memory = lock_memory;
+}
+
+/**
+ * Sets the NUMA node the next initialize places the slab on, -1 (the default) leaves it to the first thread to touch
+ * it. The node is preferred rather than required so a full node does not stop the component starting.
+ */
+void SddsPacketPool::set_numa_node(int node) {
+	m_numa_node = node;
+}
+
+/**
+ * Returns the NUMA node the start of the slab actually lives on, -1 if there is no slab or it cannot be found.
+ */
+int SddsPacketPool::numa_node() const {
+	int node = -1;
+	if (not m_slab or syscall(SYS_get_mempolicy, &node, NULL, 0, m_slab, MPOL_F_NODE | MPOL_F_ADDR) != 0) {
+		return -1;
+	}
+	return node;
+}
+
+/**
+ * Maps at least bytes of memory for the slab, binds it to the NUMA node if one is set and prefaults it. With huge pages requested the slab is first taken from
+ * the reserved huge pages (vm.nr_hugepages). If there are not enough it is mapped on a huge page boundary and the
+ * kernel is asked to back it with transparent huge pages, and if it will not the slab is left on normal pages. A slab
+ * smaller than one huge page always uses normal pages.
+ * page_size reports which it got. With lock_memory set the slab is then locked so it can never be swapped out, if
+ * that fails (usually RLIMIT_MEMLOCK) the error is kept in lock_error and the slab is left unlocked.
+ *
+ * The slab of an elastic pool is only reserved, inaccessible, and left to grow to commit. It is never taken from the
+ * reserved huge pages as those would all be set aside for max_capacity up front.
+ */
+void SddsPacketPool::map_slab(size_t bytes) {
+	size_t small_page = sysconf(_SC_PAGESIZE);
+	size_t huge_page = m_huge_pages ? hugePageSize() : 0;
+	if (bytes < huge_page) {
+		huge_page = 0; // Not worth rounding a small pool up to a huge page
+	}
+	if (m_elastic) {
+		huge_page = (m_commit_align > small_page) ? m_commit_align : 0;
+	}
+	void *mem = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+	if (huge_page and not m_elastic) {
+		m_mapped_bytes = roundUp(bytes, huge_page);
+		mem = mmap(NULL, m_mapped_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (mem != MAP_FAILED) {
+			m_page_size = huge_page;
+			m_huge_tlb = true;
+		}
+	}
+#endif
+
+	if (mem == MAP_FAILED) {
+		// Transparent huge pages are only used for whole aligned huge pages, so map enough extra to start on a boundary
+		size_t align = huge_page ? huge_page : small_page;
+		m_mapped_bytes = roundUp(bytes, align);
+		size_t len = m_mapped_bytes + align - small_page;
+		// An inaccessible mapping is not charged against the commit limit until grow makes part of it accessible
+		int prot = m_elastic ? PROT_NONE : PROT_READ | PROT_WRITE;
+		uint8_t *raw = static_cast<uint8_t*>(mmap(NULL, len, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+		if (raw == MAP_FAILED) {
+			m_mapped_bytes = 0;
+			throw std::bad_alloc();
+		}
+
+		uint8_t *aligned = reinterpret_cast<uint8_t*>(roundUp(reinterpret_cast<uintptr_t>(raw), align));
+		if (aligned > raw) {
+			munmap(raw, aligned - raw);
+		}
+		if (raw + len > aligned + m_mapped_bytes) {
+			munmap(aligned + m_mapped_bytes, (raw + len) - (aligned + m_mapped_bytes));
+		}
+
+#ifdef MADV_HUGEPAGE
+		if (huge_page) {
+			madvise(aligned, m_mapped_bytes, MADV_HUGEPAGE);
+		}
+#endif
+		mem = aligned;
+	}
+
+	m_slab = static_cast<uint8_t*>(mem);
+	if (m_elastic) {
+		return;
+	}
+
+	commit_range(m_slab, m_mapped_bytes);
+	if (not m_huge_tlb) {
+		m_page_size = (huge_page and transparentHugeBytes(m_slab) * 2 >= m_mapped_bytes) ? huge_page : small_page;
+	}
+}
+
+/**
+ * Readies len bytes of the slab from start for use: makes them accessible if the pool is elastic, binds them to the
+ * NUMA node, prefaults them and locks them. Only a failure to make them accessible returns false, a failure to lock is
+ * kept in lock_error and no later range is locked.
+ */
+bool SddsPacketPool::commit_range(uint8_t *start, size_t len) {
+	if (m_elastic and mprotect(start, len, PROT_READ | PROT_WRITE) != 0) {
+		return false;
+	}
+
+	// Pages are placed when they are first faulted in, so the slab must be bound before it is touched
+	if (m_numa_node >= 0) {
+		unsigned long nodemask[16] = {0};
+		size_t bits = sizeof(unsigned long) * 8;
+		if ((size_t) m_numa_node < sizeof(nodemask) * 8) {
+			nodemask[m_numa_node / bits] = 1UL << (m_numa_node % bits);
+			syscall(SYS_mbind, start, len, MPOL_PREFERRED, nodemask, sizeof(nodemask) * 8, 0);
+		}
+	}
+
+	// Reading would only map the shared zero page, each page must be written to be faulted in for real
+	size_t small_page = sysconf(_SC_PAGESIZE);
+	for (size_t i = 0; i < len; i += small_page) {
+		start[i] = 0;
+	}
+
+	if (m_lock_memory and not m_lock_error) {
+		if (mlock(start, len) == 0) {
+			m_locked_bytes += len;
+		} else {
+			m_lock_error = errno;
+		}
+	}
+	return true;
+}
+
+/**
+ * Hands len bytes of an elastic slab from start back to the system and makes them inaccessible again.
+ */
+void SddsPacketPool::decommit_range(uint8_t *start, size_t len) {
+	munlock(start, len);
+	madvise(start, len, MADV_DONTNEED);
+	mprotect(start, len, PROT_NONE);
+}
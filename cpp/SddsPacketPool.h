@@ -0,0 +1,125 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * SddsPacketPool.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#ifndef SDDSPACKETPOOL_H_
+#define SDDSPACKETPOOL_H_
+
+#include <boost/circular_buffer.hpp>
+#include <stdint.h>
+#include "sddspacket.h"
+
+/**
+ * Packets are passed between threads as 32 bit indexes into the pool rather than
+ * as pointers so that handing one off is a plain integer copy.
+ */
+typedef uint32_t PacketHandle;
+typedef boost::circular_buffer<PacketHandle> PacketHandleQueue;
+
+const PacketHandle INVALID_PACKET_HANDLE = 0xFFFFFFFF;
+
+/**
+ * A fixed size pool of SDDS packets allocated as a single cache line aligned slab.
+ * Memory is only allocated by initialize so there is no heap traffic once the
+ * socket reader and SDDS to BulkIO threads are running.
+ *
+ * The slab can be laid out two ways. By default each slot is a complete 1080 byte SDDS
+ * packet. With split_data set all the headers are kept in one array and all the data
+ * portions in another, so the data of packets in consecutive slots is contiguous in memory.
+ * Callers go through header and data so they do not need to know which layout is in use.
+ *
+ * The slab is mapped rather than taken from the heap so that, if asked for with set_memory_options, it can be backed
+ * by huge pages and locked into memory. It is always prefaulted by initialize so the socket reader never takes a page
+ * fault on its first pass through the pool, and it can be bound to a NUMA node with set_numa_node before it is faulted.
+ *
+ * A pool initialized with a max_capacity above its capacity is elastic. The address space for max_capacity packets is
+ * reserved up front but only the memory for the current capacity is committed, so grow and shrink change how many
+ * packets the pool holds without moving any of them and header and data stay a multiply and an add.
+ *
+ * The slab outlives a stop and is kept by the next initialize if that asks for the same layout with the same options,
+ * so restarting the component does not pay to map, fault and lock it all over again, see reused.
+ */
+class SddsPacketPool {
+public:
+	SddsPacketPool();
+	~SddsPacketPool();
+
+	void initialize(size_t capacity, bool split_data = false, size_t max_capacity = 0);
+	bool grow(size_t capacity);
+	void shrink(size_t capacity);
+	void release();
+	void set_memory_options(bool huge_pages, bool lock_memory);
+	void set_numa_node(int node);
+	int numa_node() const;
+
+	SDDSheader* header(PacketHandle handle) { return reinterpret_cast<SDDSheader*>(m_header_base + handle * m_header_stride); }
+	uint8_t* data(PacketHandle handle) { return m_data_base + handle * m_data_stride; }
+	bool split_data() const { return m_split_data; }
+	size_t capacity() const { return m_capacity; }
+	size_t max_capacity() const { return m_max_capacity; }
+	size_t bytes() const { return m_bytes; }
+	size_t page_size() const { return m_page_size; }
+	bool huge_tlb() const { return m_huge_tlb; }
+	size_t locked_bytes() const { return m_locked_bytes; }
+	int lock_error() const { return m_lock_error; }
+	bool reused() const { return m_reused; }
+
+private:
+	SddsPacketPool(const SddsPacketPool&);              // Disabled copy constructor
+	SddsPacketPool& operator = (const SddsPacketPool&); // Disabled assign operator
+
+	void map_slab(size_t bytes);
+	bool commit_range(uint8_t *start, size_t len);
+	void decommit_range(uint8_t *start, size_t len);
+
+	uint8_t *m_slab;
+	size_t m_mapped_bytes;
+	uint8_t *m_header_base;
+	uint8_t *m_data_base;
+	size_t m_header_stride;
+	size_t m_data_stride;
+	size_t m_capacity;
+	size_t m_max_capacity;
+	size_t m_bytes;
+	bool m_elastic;
+	size_t m_commit_align;
+	size_t m_data_offset;
+	size_t m_header_committed;
+	size_t m_data_committed;
+	bool m_split_data;
+	bool m_huge_pages;
+	bool m_lock_memory;
+	int m_numa_node;
+	size_t m_page_size;
+	bool m_huge_tlb;
+	size_t m_locked_bytes;
+	int m_lock_error;
+	bool m_mapped_huge_pages;
+	bool m_mapped_lock_memory;
+	int m_mapped_numa_node;
+	bool m_reused;
+};
+
+#endif /* SDDSPACKETPOOL_H_ */
@@ -26,25 +26,65 @@
 
 #include "SddsToBulkIOProcessor.h"
 #include "SddsToBulkIOUtils.h"
+#include "SwapCopy.h"
 #include <math.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+#include <algorithm>
 
 PREPARE_LOGGING(SddsToBulkIOProcessor)
 
+// How many packet headers the batch fast path decodes and checks at a time
+#define HEADER_BATCH_SIZE 64
+// The sequence numbers actually sent, every 32nd is skipped for the CRC packet
+#define SEQ_POSITIONS (2048 * 31)
+
+/**
+ * The header fields the batch fast path checks, pulled out of a batch of packets into flat arrays so that
+ * the checks are simple loops the compiler can vectorize.
+ */
+struct HeaderBatch {
+	uint16_t seq[HEADER_BATCH_SIZE];
+	uint16_t format[HEADER_BATCH_SIZE];	// The first two bytes, sf through cx including bps
+	uint16_t msptr[HEADER_BATCH_SIZE];
+	uint64_t freq[HEADER_BATCH_SIZE];
+	uint8_t plain[HEADER_BATCH_SIZE];
+};
+
+/**
+ * The position of seq amongst the sequence numbers actually sent.
+ */
+static inline uint32_t seqPosition(uint32_t seq) {
+	return (seq >> 5) * 31 + (seq & 31);
+}
+
+static uint64_t monotonicNanos() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
 //TODO: Should accum_error_tolerance be a setable property?  Should we report it back?
 SddsToBulkIOProcessor::SddsToBulkIOProcessor(bulkio::OutOctetPort *octet_out, bulkio::OutShortPort *short_out, bulkio::OutFloatPort *float_out):
 	m_pkts_per_read(DEFAULT_PKTS_PER_READ), m_running(false), m_shuttingDown(false), m_wait_for_ttv(false),
-	m_push_on_ttv(false), m_first_packet(true), m_current_ttv_flag(false),m_expected_seq_number(0),
-	m_last_sdds_time(0), m_pkts_dropped(0), m_bps(0), m_octet_out(octet_out), m_short_out(short_out),
+	m_push_on_ttv(false), m_process_loop(NULL), m_first_packet(true), m_current_ttv_flag(false),m_expected_seq_number(0),
+	m_bulkIO_len(0), m_last_sdds_time(0), m_pkts_dropped(0), m_bps(0), m_octet_out(octet_out), m_short_out(short_out),
 	m_float_out(float_out), m_upstream_sri_set(false), m_endianness(ENDIANNESS::ENDIAN_DEFAULT),
-	m_new_upstream_sri(false), m_use_upstream_sri(false), m_num_time_slips(0), m_current_sample_rate(0),
-	m_max_time_step(0), m_min_time_step(0), m_ideal_time_step(0), m_time_error_accum(0),
-	m_accum_error_tolerance(0.000001),m_non_conforming_device(false)
+	m_swap(needsSwap()), m_copy(swapCopyFunction(8)), m_new_upstream_sri(false), m_use_upstream_sri(false), m_num_time_slips(0), m_current_sample_rate(0),
+	m_accum_error_tolerance(0.000001),m_non_conforming_device(false), m_sri_header_valid(false),
+	m_sri_format(0), m_sri_freq(0), m_sri_changes(0), m_zero_copy(false), m_run_start(NULL), m_run_len(0),
+	m_auto_tune(false), m_min_pkts_per_read(1), m_max_pkts_per_read(1), m_tune_start_ns(0), m_tune_push_ns(0), m_tune_occupancy(0),
+	m_tune_samples(0), m_default_stream_id("DEFAULT_SDDS_STREAM_ID"), m_shared_pktbuffer(NULL), m_shared_pending(0),
+	m_conversion_threads(0), m_converting(false), m_conversion_stopping(false), m_conversion_pktbuffer(NULL), m_open_job(NULL),
+	m_sequencer(NULL)
 {
-	// reserve size so it is done at construct time
-	m_bulkIO_data.reserve(m_pkts_per_read * SDDS_DATA_SIZE);
+	// size it so it is done at construct time
+	sizeData(m_pkts_per_read * SDDS_DATA_SIZE);
 
 	// Needs to be initialized.
-	m_sri.streamID = "DEFAULT_SDDS_STREAM_ID";
+	m_sri.streamID = m_default_stream_id.c_str();
 	m_sri.xdelta = -1;
 	m_sri.mode = -1;
 
@@ -73,14 +113,67 @@ void SddsToBulkIOProcessor::setPktsPerRead(size_t pkts_per_read) {
 		m_pkts_per_read = pkts_per_read;
 	}
 
-	// This way we only ever allocate memory here with the reserve call
-	m_bulkIO_data.reserve(m_pkts_per_read * SDDS_DATA_SIZE);
+	// This way we only ever allocate memory here with the sizeData call
+	sizeData(m_pkts_per_read * SDDS_DATA_SIZE);
 }
 
+/**
+ * Returns the number of SDDS packets read off the packet buffer per push. While auto tuning this is
+ * the push size currently in use.
+ */
 size_t SddsToBulkIOProcessor::getPktsPerRead() {
 	return m_pkts_per_read;
 }
 
+/**
+ * Lets the processor adjust the packets per read while running, within the bounds given to
+ * setPktsPerReadBounds. Cannot be called while the run method is active.
+ */
+void SddsToBulkIOProcessor::setAutoTune(bool auto_tune) {
+	if (m_running) {
+		LOG_WARN(SddsToBulkIOProcessor, "Cannot set auto tuning while thread is running");
+		return;
+	}
+	m_auto_tune = auto_tune;
+}
+
+bool SddsToBulkIOProcessor::getAutoTune() {
+	return m_auto_tune;
+}
+
+/**
+ * Sets the number of threads which copy and byte swap the data for run, 0 does it all on the processor thread. Must
+ * not be called while running.
+ */
+void SddsToBulkIOProcessor::setConversionThreads(size_t conversion_threads) {
+	if (m_running) {
+		LOG_WARN(SddsToBulkIOProcessor, "Cannot set the number of conversion threads while thread is running");
+		return;
+	}
+	m_conversion_threads = conversion_threads;
+}
+
+size_t SddsToBulkIOProcessor::getConversionThreads() {
+	return m_conversion_threads;
+}
+
+/**
+ * Sets the smallest and largest packets per read auto tuning may choose, the largest is limited
+ * the same way as setPktsPerRead. Cannot be called while the run method is active.
+ */
+void SddsToBulkIOProcessor::setPktsPerReadBounds(size_t min_pkts_per_read, size_t max_pkts_per_read) {
+	if (m_running) {
+		LOG_WARN(SddsToBulkIOProcessor, "Cannot set packets per read bounds while thread is running");
+		return;
+	}
+	size_t corba_max = floorl((CORBA_MAX_XFER_BYTES) / (SDDS_DATA_SIZE));
+	m_max_pkts_per_read = std::max(std::min(max_pkts_per_read, corba_max), (size_t) 1);
+	m_min_pkts_per_read = std::min(std::max(min_pkts_per_read, (size_t) 1), m_max_pkts_per_read);
+
+	// The push may grow to the largest size so make room for it now
+	sizeData(m_max_pkts_per_read * SDDS_DATA_SIZE);
+}
+
 /**
  * Sets the shut down boolean to true so that during the next pass
  * the SDDS to BulkIO processor will exit cleanly. Any currently
@@ -122,24 +215,48 @@ void SddsToBulkIOProcessor::setPushOnTTV(bool push_on_ttv) {
  * used to pull full packets from, processed via the processPackets call, then the processed
  * packets will be recycled. This method does not return until the shutdown method is called.
  */
-void SddsToBulkIOProcessor::run(SmartPacketBuffer<SDDSpacket> *pktbuffer) {
+void SddsToBulkIOProcessor::run(PacketBuffer *pktbuffer) {
 	m_running = true;
 	m_shuttingDown = false;
 	pthread_setname_np(pthread_self(), "SddsToBulkIOProcessor");
+	selectProcessLoop();
+
+	// If the pool keeps the packet data contiguous we can push straight out of it, see appendData.
+	m_zero_copy = pktbuffer->pool().split_data();
+
+	// While auto tuning the push size moves between its bounds. The reader and the processor must not be able to hold
+	// the whole buffer between them, hence the half.
+	size_t max_pkts = m_pkts_per_read;
+	if (m_auto_tune) {
+		max_pkts = std::max(std::min(m_max_pkts_per_read, pktbuffer->capacity() / 2), (size_t) 1);
+		m_pkts_per_read = std::min(std::max((size_t) m_pkts_per_read, std::min(m_min_pkts_per_read, max_pkts)), max_pkts);
+		m_tune_start_ns = monotonicNanos();
+		m_tune_push_ns = 0;
+		m_tune_occupancy = 0;
+		m_tune_samples = 0;
+	}
 
 	// Feed in packets to process,
-	// Since these are deques there is no reserve so we can just throw it on the stack.
-	std::deque<SddsPacketPtr> pktsToProcess;
-	std::deque<SddsPacketPtr> pktsToRecycle;
+	// Neither container ever holds more than max_pkts handles so they are sized once up front.
+	PacketBuffer::container_type pktsToProcess(max_pkts);
+	PacketBuffer::container_type pktsToRecycle(max_pkts);
+
+	if (m_conversion_threads > 0) {
+		startConversion(pktbuffer, max_pkts);
+	}
 
 	while (not m_shuttingDown) {
+		if (m_auto_tune) {
+			tunePushSize(pktbuffer);
+		}
+
 		// We HAVE to recycle this buffer.
 		pktbuffer->pop_full_buffers(pktsToProcess, m_pkts_per_read);
 		if (not m_shuttingDown) {
-			processPackets(pktsToProcess, pktsToRecycle);
+			processPackets(pktbuffer->pool(), pktsToProcess, pktsToRecycle);
 		}
 
-		pktbuffer->recycle_buffers(pktsToRecycle);
+		recyclePackets(pktbuffer, pktsToRecycle);
 	}
 
 	//Push any remaining data and an EOS
@@ -147,13 +264,352 @@ void SddsToBulkIOProcessor::run(SmartPacketBuffer<SDDSpacket> *pktbuffer) {
 
 
 	// Shutting down, recycle all the packets
-	pktbuffer->recycle_buffers(pktsToProcess);
-	pktbuffer->recycle_buffers(pktsToRecycle);
+	recyclePackets(pktbuffer, pktsToProcess);
+	recyclePackets(pktbuffer, pktsToRecycle);
+	stopConversion();
 
 	m_running = false;
 	m_first_packet = true;
 }
 
+/**
+ * Prepares to process pktbuffer through processShared, for when a worker pool rather than a thread of our own drives
+ * the processing. Auto tuning is not done, every push is sdds_pkts_per_bulkio_push packets as set.
+ */
+void SddsToBulkIOProcessor::startShared(PacketBuffer *pktbuffer) {
+	m_running = true;
+	m_shuttingDown = false;
+	selectProcessLoop();
+	m_zero_copy = pktbuffer->pool().split_data();
+	m_shared_pktbuffer = pktbuffer;
+	m_shared_pkts_to_process.clear();
+	m_shared_pkts_to_recycle.clear();
+	m_shared_pkts_to_process.set_capacity(m_pkts_per_read);
+	m_shared_pkts_to_recycle.set_capacity(m_pkts_per_read);
+	m_shared_pending = 0;
+}
+
+/**
+ * Returns true if there are enough packets waiting for processShared to make a push. May be called from any thread.
+ */
+bool SddsToBulkIOProcessor::sharedReady() {
+	return m_shared_pktbuffer and m_shared_pktbuffer->get_num_full_buffers() + m_shared_pending >= m_pkts_per_read;
+}
+
+/**
+ * Processes the packets waiting in the packet buffer given to startShared, stopping after max_pushes pushes or
+ * when there are too few waiting to fill a push. Unlike run this never waits on the packet buffer. Returns true if
+ * there was still enough waiting for another push. Must not be called from two threads at once.
+ */
+bool SddsToBulkIOProcessor::processShared(size_t max_pushes) {
+	for (size_t i = 0; i < max_pushes and not m_shuttingDown; ++i) {
+		if (not sharedReady()) {
+			return false;
+		}
+		m_shared_pktbuffer->pop_full_buffers(m_shared_pkts_to_process, m_pkts_per_read);
+		processPackets(m_shared_pktbuffer->pool(), m_shared_pkts_to_process, m_shared_pkts_to_recycle);
+		m_shared_pktbuffer->recycle_buffers(m_shared_pkts_to_recycle);
+		m_shared_pending = m_shared_pkts_to_process.size();
+	}
+	return not m_shuttingDown and sharedReady();
+}
+
+/**
+ * Processes every packet waiting in the packet buffer given to startShared and pushes it straight away, for run to
+ * completion where the thread which read the packets also processes them before it reads again. Pushes are still at
+ * most sdds_pkts_per_bulkio_push packets but fewer waiting are pushed as they are rather than held for the next read.
+ * Must not be called from two threads at once.
+ */
+void SddsToBulkIOProcessor::processInline() {
+	while (not m_shuttingDown) {
+		size_t waiting = m_shared_pkts_to_process.size() + m_shared_pktbuffer->get_num_full_buffers();
+		if (waiting == 0) {
+			break;
+		}
+		m_shared_pktbuffer->pop_full_buffers(m_shared_pkts_to_process, std::min(waiting, (size_t) m_pkts_per_read));
+		processPackets(m_shared_pktbuffer->pool(), m_shared_pkts_to_process, m_shared_pkts_to_recycle);
+		m_shared_pktbuffer->recycle_buffers(m_shared_pkts_to_recycle);
+	}
+}
+
+/**
+ * Pushes any remaining data and an EOS then hands every packet back to the packet buffer given to startShared.
+ */
+void SddsToBulkIOProcessor::stopShared() {
+	if (not m_shared_pktbuffer) {
+		return;
+	}
+	pushPacket(true);
+	m_shared_pktbuffer->recycle_buffers(m_shared_pkts_to_process);
+	m_shared_pktbuffer->recycle_buffers(m_shared_pkts_to_recycle);
+	m_shared_pktbuffer = NULL;
+	m_shared_pending = 0;
+	m_running = false;
+	m_first_packet = true;
+}
+
+/**
+ * Starts conversion_threads conversion threads and the sequencer for run. From here on the processor thread only
+ * works through the packet headers, deciding as it always has where each push starts and ends, and hands each push
+ * to the conversion threads as a job. A conversion thread copies the packets of a whole push into the job and byte
+ * swaps them, while the sequencer makes the pushes, SRI pushes and packet recycling strictly in the order the
+ * processor thread submitted them, so the output is exactly that of a single thread.
+ */
+void SddsToBulkIOProcessor::startConversion(PacketBuffer *pktbuffer, size_t max_pkts) {
+	// Enough jobs to keep every conversion thread busy while the sequencer pushes and the processor fills the next
+	size_t num_jobs = 2 * m_conversion_threads + 2;
+	if (m_jobs.size() != num_jobs or (not m_jobs.empty() and m_jobs[0].packets.capacity() < max_pkts)) {
+		m_jobs.clear();
+		for (size_t i = 0; i < num_jobs; ++i) {
+			ConversionJob *job = new ConversionJob();
+			job->packets.reserve(max_pkts);
+			job->data.reserve(max_pkts * SDDS_DATA_SIZE);
+			job->recycle.set_capacity(max_pkts);
+			m_jobs.push_back(job);
+		}
+	}
+
+	m_free_jobs.clear();
+	m_convert_queue.clear();
+	m_sequence_queue.clear();
+	for (size_t i = 0; i < m_jobs.size(); ++i) {
+		m_free_jobs.push_back(&m_jobs[i]);
+	}
+
+	m_conversion_pktbuffer = pktbuffer;
+	m_conversion_stopping = false;
+	m_open_job = NULL;
+	m_converting = true;
+	for (size_t i = 0; i < m_conversion_threads; ++i) {
+		m_conversion_workers.push_back(new boost::thread(boost::bind(&SddsToBulkIOProcessor::runConversionWorker, this)));
+	}
+	m_sequencer = new boost::thread(boost::bind(&SddsToBulkIOProcessor::runSequencer, this));
+}
+
+/**
+ * Waits for every submitted job to be finished then stops the conversion threads and sequencer.
+ */
+void SddsToBulkIOProcessor::stopConversion() {
+	if (not m_converting) {
+		return;
+	}
+
+	{
+		boost::mutex::scoped_lock lock(m_conversion_lock);
+		m_conversion_stopping = true;
+		m_job_to_convert.notify_all();
+		m_job_to_sequence.notify_all();
+	}
+
+	m_sequencer->join();
+	delete m_sequencer;
+	m_sequencer = NULL;
+	for (size_t i = 0; i < m_conversion_workers.size(); ++i) {
+		m_conversion_workers[i]->join();
+		delete m_conversion_workers[i];
+	}
+	m_conversion_workers.clear();
+	m_converting = false;
+}
+
+/**
+ * Returns an unused job, waiting for the sequencer to finish one if they are all in use.
+ */
+SddsToBulkIOProcessor::ConversionJob* SddsToBulkIOProcessor::takeFreeJob(ConversionJob::Kind kind) {
+	boost::mutex::scoped_lock lock(m_conversion_lock);
+	while (m_free_jobs.empty()) {
+		m_job_freed.wait(lock);
+	}
+	ConversionJob *job = m_free_jobs.front();
+	m_free_jobs.pop_front();
+
+	job->kind = kind;
+	job->packets.clear();
+	job->recycle.clear();
+	job->push_data = NULL;
+	job->push_len = 0;
+	job->swap = false;
+	job->eos = false;
+	job->converted = false;
+	return job;
+}
+
+/**
+ * Queues job for the sequencer, and first for a conversion thread if it has packets to convert.
+ */
+void SddsToBulkIOProcessor::submitJob(ConversionJob *job) {
+	boost::mutex::scoped_lock lock(m_conversion_lock);
+	m_sequence_queue.push_back(job);
+	if (job->kind == ConversionJob::JOB_PUSH and not job->packets.empty()) {
+		m_convert_queue.push_back(job);
+		m_job_to_convert.notify_one();
+	} else {
+		job->converted = true;
+		m_job_to_sequence.notify_one();
+	}
+}
+
+/**
+ * Hands pkts back to pktbuffer. While converting on several threads the pushes using them may not have been made
+ * yet, so they are handed to the sequencer to recycle once they have.
+ */
+void SddsToBulkIOProcessor::recyclePackets(PacketBuffer *pktbuffer, PacketBuffer::container_type &pkts) {
+	if (not m_converting) {
+		pktbuffer->recycle_buffers(pkts);
+		return;
+	}
+	if (pkts.empty()) {
+		return;
+	}
+
+	ConversionJob *job = takeFreeJob(ConversionJob::JOB_RECYCLE);
+	job->recycle.insert(job->recycle.end(), pkts.begin(), pkts.end());
+	pkts.clear();
+	submitJob(job);
+}
+
+/**
+ * Gathers the packets of a push job into one block, byte swapping them as they are copied. When the pool keeps the
+ * packets of the push next to each other they are pushed, swapped in place, from where they are, as appendData does.
+ */
+void SddsToBulkIOProcessor::convertJob(ConversionJob *job) {
+	size_t num = job->packets.size();
+	bool contiguous = m_zero_copy;
+	for (size_t i = 1; i < num and contiguous; ++i) {
+		contiguous = job->packets[i] == job->packets[i - 1] + SDDS_DATA_SIZE;
+	}
+
+	if (contiguous) {
+		job->push_data = job->packets[0];
+	} else {
+		job->data.resize(num * SDDS_DATA_SIZE);
+		for (size_t i = 0; i < num; ++i) {
+			if (job->swap) {
+				swapCopy(job->bps, &job->data[i * SDDS_DATA_SIZE], job->packets[i], SDDS_DATA_SIZE);
+			} else {
+				memcpy(&job->data[i * SDDS_DATA_SIZE], job->packets[i], SDDS_DATA_SIZE);
+			}
+		}
+		job->push_data = &job->data[0];
+	}
+	job->push_len = num * SDDS_DATA_SIZE;
+
+	if (contiguous and job->swap) {
+		swapCopy(job->bps, job->push_data, job->push_data, job->push_len);
+	}
+}
+
+/**
+ * A conversion thread, converts push jobs in the order they are queued until stopConversion is called.
+ */
+void SddsToBulkIOProcessor::runConversionWorker() {
+	pthread_setname_np(pthread_self(), "SddsConversion");
+
+	// The conversion threads are there to use other cores, do not inherit the processor thread affinity if it was already set
+	cpu_set_t cpus;
+	if (sched_getaffinity(getpid(), sizeof(cpus), &cpus) == 0) {
+		pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+	}
+
+	boost::mutex::scoped_lock lock(m_conversion_lock);
+	while (true) {
+		while (m_convert_queue.empty() and not m_conversion_stopping) {
+			m_job_to_convert.wait(lock);
+		}
+		if (m_convert_queue.empty()) {
+			break;
+		}
+
+		ConversionJob *job = m_convert_queue.front();
+		m_convert_queue.pop_front();
+		lock.unlock();
+		convertJob(job);
+		lock.lock();
+
+		job->converted = true;
+		m_job_to_sequence.notify_one();
+	}
+}
+
+/**
+ * The sequencer thread, finishes the jobs in the order they were submitted. Once stopConversion is called it
+ * carries on until every job has been finished.
+ */
+void SddsToBulkIOProcessor::runSequencer() {
+	pthread_setname_np(pthread_self(), "SddsSequencer");
+	boost::mutex::scoped_lock lock(m_conversion_lock);
+	while (true) {
+		if (m_sequence_queue.empty() and m_conversion_stopping) {
+			break;
+		}
+		if (m_sequence_queue.empty() or not m_sequence_queue.front()->converted) {
+			m_job_to_sequence.wait(lock);
+			continue;
+		}
+
+		ConversionJob *job = m_sequence_queue.front();
+		m_sequence_queue.pop_front();
+		lock.unlock();
+
+		switch (job->kind) {
+		case ConversionJob::JOB_PUSH: {
+			uint64_t push_start = m_auto_tune ? monotonicNanos() : 0;
+			pushData(job->bps, job->sri, job->push_data, job->push_len, job->time_stamp, job->eos);
+			// tunePushSize takes this from the processing thread
+			if (m_auto_tune) {
+				__sync_fetch_and_add(&m_tune_push_ns, monotonicNanos() - push_start);
+			}
+			break;
+		}
+		case ConversionJob::JOB_SRI:
+			pushSriTo(job->bps, job->sri);
+			break;
+		case ConversionJob::JOB_RECYCLE:
+			m_conversion_pktbuffer->recycle_buffers(job->recycle);
+			break;
+		}
+
+		lock.lock();
+		m_free_jobs.push_back(job);
+		m_job_freed.notify_one();
+	}
+}
+
+/**
+ * Called before every pop of the packet buffer while auto tuning. Once every AUTO_TUNE_INTERVAL_MS this looks at how
+ * full the packet buffer has been and how much of the time went to pushPacket, and changes the push size.
+ *
+ * A filling buffer means the processor is falling behind and a busy pushPacket means the per push cost is eating the
+ * thread, either way the push size doubles so the cost is paid over more packets. When the buffer stays nearly empty
+ * and pushes take little time there is headroom, so the push size halves and data waits less for a push to fill.
+ */
+void SddsToBulkIOProcessor::tunePushSize(PacketBuffer *pktbuffer) {
+	m_tune_occupancy += (double) pktbuffer->get_num_full_buffers() / pktbuffer->capacity();
+	m_tune_samples++;
+
+	uint64_t now = monotonicNanos();
+	if (now - m_tune_start_ns < AUTO_TUNE_INTERVAL_MS * 1000000ULL) {
+		return;
+	}
+
+	// The sequencer adds to the push time while conversion threads are used, so it is taken and cleared in one step
+	uint64_t push_ns = __sync_lock_test_and_set(&m_tune_push_ns, 0);
+	double occupancy = m_tune_occupancy / m_tune_samples;
+	double busy = (double) push_ns / (now - m_tune_start_ns);
+	size_t max_pkts = std::max(std::min(m_max_pkts_per_read, pktbuffer->capacity() / 2), (size_t) 1);
+	size_t min_pkts = std::min(m_min_pkts_per_read, max_pkts);
+
+	if (occupancy >= 0.5 or busy >= 0.5) {
+		m_pkts_per_read = std::min(m_pkts_per_read * 2, max_pkts);
+	} else if (occupancy < 0.1 and busy < 0.1) {
+		m_pkts_per_read = std::max(m_pkts_per_read / 2, min_pkts);
+	}
+
+	m_tune_start_ns = now;
+	m_tune_occupancy = 0;
+	m_tune_samples = 0;
+}
+
 /**
  * Calculates the expected xdelta based on the provided rate, complex flag, and current m_bps.
  * The member variables max, ideal, and min time steps are updated which are used to deteremine
@@ -173,9 +629,10 @@ void SddsToBulkIOProcessor::updateExpectedXdelta(double rate, bool complex) {
 		samps_per_packet = samps_per_packet / 2;
 	}
 
-	m_max_time_step = ((double) (samps_per_packet + 1)) / m_current_sample_rate;
-	m_ideal_time_step = ((double) (samps_per_packet)) / m_current_sample_rate;
-	m_min_time_step = ((double) (samps_per_packet - 1)) / m_current_sample_rate;
+	// Worked out in seconds once here, the per packet checks are then integer compares on time tag ticks
+	m_max_time_step = SDDSTimeStep(((double) (samps_per_packet + 1)) / m_current_sample_rate);
+	m_ideal_time_step = SDDSTimeStep(((double) (samps_per_packet)) / m_current_sample_rate);
+	m_min_time_step = SDDSTimeStep(((double) (samps_per_packet - 1)) / m_current_sample_rate);
 }
 
 /**
@@ -183,7 +640,7 @@ void SddsToBulkIOProcessor::updateExpectedXdelta(double rate, bool complex) {
  * Increments the expected sequence number if true.
  * If the packet does not match the expected, we calculate packets dropped and reset first packet
  */
-bool SddsToBulkIOProcessor::orderIsValid(SddsPacketPtr &pkt) {
+bool SddsToBulkIOProcessor::orderIsValid(SDDSheader *pkt) {
 
 	// First packet, its valid.
 	if (m_first_packet) {
@@ -210,6 +667,23 @@ bool SddsToBulkIOProcessor::orderIsValid(SddsPacketPtr &pkt) {
 	return true;
 }
 
+/**
+ * Returns true if the header words the SRI is merged from, the format bits and the frequency, are not those it was
+ * last merged from, and remembers them. Compared raw, so any change to the stream is caught without converting the
+ * rate. Anything else that changes the SRI clears m_sri_header_valid so that the next packet is merged.
+ */
+bool SddsToBulkIOProcessor::sriHeaderChanged(SDDSheader *pkt) {
+	uint16_t format;
+	memcpy(&format, pkt, sizeof(format));
+	if (m_sri_header_valid && format == m_sri_format && pkt->freq == m_sri_freq) {
+		return false;
+	}
+	m_sri_header_valid = true;
+	m_sri_format = format;
+	m_sri_freq = pkt->freq;
+	return true;
+}
+
 /**
  * Checks the provided packet to see if a time slip has occured. This can either be a time
  * discontinuity between subsequent packets or a slow time slip over a number of packets by
@@ -217,7 +691,7 @@ bool SddsToBulkIOProcessor::orderIsValid(SddsPacketPtr &pkt) {
  * There is also a check, and adjustments for poorly behaving devices which may not abide by the SDDS standard (such as the MSDD)
  * see the note below for details.
  */
-void SddsToBulkIOProcessor::checkForTimeSlip(SddsPacketPtr &pkt) {
+void SddsToBulkIOProcessor::checkForTimeSlip(SDDSheader *pkt) {
 	// If time tag is not valid no need to check for time slips.
 	bool slip = false;
 
@@ -232,37 +706,40 @@ void SddsToBulkIOProcessor::checkForTimeSlip(SddsPacketPtr &pkt) {
 	}
 
 	SDDSTime curr_time = pkt->get_SDDSTime();
-	double deltaTime = curr_time.seconds() - m_last_sdds_time.seconds();
+	SDDSTimeStep deltaTime(m_last_sdds_time, curr_time);
 
 	m_last_sdds_time = curr_time;
 
-	if (deltaTime < 0) {
+	if (deltaTime.negative()) {
 		LOG_INFO(SddsToBulkIOProcessor, "Received a negative delta between packet time stamps, time is either going backwards or the year has rolled over");
 		m_last_sdds_time = curr_time;
 		return;
 	}
 
-	if (deltaTime > m_max_time_step || deltaTime < m_min_time_step) {
+	if (m_max_time_step < deltaTime || deltaTime < m_min_time_step) {
+		SDDSTimeStep twiceDeltaTime = deltaTime + deltaTime;
 		// XXX Special case here! Some devices, like the MSDD do not conform to the SDDS standard and the header contains a bad sample rate
 		// the sample rate is off by a factor of two which we detect here based on the xdelta and account for with the m_non_conforming_device boolean.
 		// we also check m_num_time_slips just in case we have a device that is slipping a lot and happens to fall into this position.
-		if (!m_non_conforming_device && pkt->cx != 0 && m_num_time_slips == 0 && 2*deltaTime < m_max_time_step && 2*deltaTime > m_min_time_step) {
+		if (!m_non_conforming_device && pkt->cx != 0 && m_num_time_slips == 0 && twiceDeltaTime < m_max_time_step && m_min_time_step < twiceDeltaTime) {
 			LOG_INFO(SddsToBulkIOProcessor, "Based on the received XDelta between packets, it appears that these SDDS packets do not conform to the spec. "
 						   "This is a known issue for some devices (eg. MSDD) where the sample rate in the header is off by a factor of two. "
 						   "The expected XDelta has been adjusted, this will also be reflected in the output SRI unless overridden via SRI Keywords, if the SRI is not overridden it will result in a single erroneous SRI push");
 			m_non_conforming_device = true;
+			m_sri_header_valid = false;
 			updateExpectedXdelta(2*m_current_sample_rate, pkt->cx != 0);
 		} else {
-			LOG_WARN(SddsToBulkIOProcessor, "Delta time of " << deltaTime << " occurred on packet: " << pkt->seq << " delta between packets expected to be between " << m_min_time_step  << " and " << m_max_time_step);
+			LOG_WARN(SddsToBulkIOProcessor, "Delta time of " << deltaTime.seconds() << " occurred on packet: " << pkt->seq << " delta between packets expected to be between " << m_min_time_step.seconds()  << " and " << m_max_time_step.seconds());
 			slip = true;
 		}
 	}
 
-	m_time_error_accum += deltaTime - m_ideal_time_step;
+	m_time_error_accum += deltaTime;
+	m_time_error_accum -= m_ideal_time_step;
 
-	if (std::abs(m_time_error_accum) > m_accum_error_tolerance) {
+	if (m_accum_error_tolerance < m_time_error_accum || m_time_error_accum < -m_accum_error_tolerance) {
 		LOG_WARN(SddsToBulkIOProcessor, "The time slip accumulator has exceeded the limit set, counting it as a time slip.");
-		m_time_error_accum = 0.0;
+		m_time_error_accum = SDDSTimeStep();
 		slip = true;
 	}
 
@@ -270,25 +747,62 @@ void SddsToBulkIOProcessor::checkForTimeSlip(SddsPacketPtr &pkt) {
 		m_num_time_slips++;
 	}
 }
+
 /**
- * This is the main method for processing the sdds packets. We want to push out in chunks of m_pkts_per_read so we try and keep
+ * Picks the packet loop compiled for the wait on TTV and push on TTV settings, so the loop never tests them per packet.
+ * Neither can be changed while running so this is done once as processing starts.
+ */
+void SddsToBulkIOProcessor::selectProcessLoop() {
+	static const ProcessLoop loops[2][2] = {
+		{&SddsToBulkIOProcessor::processPacketsAs<false, false>, &SddsToBulkIOProcessor::processPacketsAs<false, true>},
+		{&SddsToBulkIOProcessor::processPacketsAs<true, false>, &SddsToBulkIOProcessor::processPacketsAs<true, true>}
+	};
+	m_process_loop = loops[m_wait_for_ttv][m_push_on_ttv];
+}
+
+/**
+ * This is the main method for processing the sdds packets. It works through pktsToWork with the loop picked by
+ * selectProcessLoop.
+ */
+void SddsToBulkIOProcessor::processPackets(SddsPacketPool &pool, PacketHandleQueue &pktsToWork, PacketHandleQueue &pktsToRecycle) {
+	(this->*m_process_loop)(pool, pktsToWork, pktsToRecycle);
+}
+
+/**
+ * The packet loop for one setting of wait on TTV and push on TTV. We want to push out in chunks of m_pkts_per_read so we try and keep
  * pktsToWork that size by keeping a second container of pkts to recycle. When we find a time discontinuity or are waiting for
  * a TTV we can recycle what we've used and get a refill on pktsToWork to bring it back up to size.
  */
-void SddsToBulkIOProcessor::processPackets(std::deque<SddsPacketPtr> &pktsToWork, std::deque<SddsPacketPtr> &pktsToRecycle) {
-	std::deque<SddsPacketPtr>::iterator pkt_it = pktsToWork.begin();
-	while (pkt_it != pktsToWork.end()) {
-		SddsPacketPtr pkt = *pkt_it;
+template <bool WAIT_FOR_TTV, bool PUSH_ON_TTV>
+void SddsToBulkIOProcessor::processPacketsAs(SddsPacketPool &pool, PacketHandleQueue &pktsToWork, PacketHandleQueue &pktsToRecycle) {
+	// The last packet added to the pending push, the packets after it which need none of the checks below are taken together
+	SDDSheader *ref = NULL;
+
+	while (not pktsToWork.empty()) {
+		if (ref && not m_new_upstream_sri) {
+			size_t count = plainPackets(pool, pktsToWork, ref);
+			if (count) {
+				ref = takePlainPackets(pool, pktsToWork, pktsToRecycle, count);
+				if (pktsToWork.empty()) {
+					pushPacket(false);
+					return;
+				}
+			}
+		}
+
+		PacketHandle handle = pktsToWork.front();
+		SDDSheader *pkt = pool.header(handle);
 
 		// The user may have requested we not push when the timecode is invalid. If this is the case we just need to recycle
 		// the buffers that don't have good ttv's and continue with the next packet hoping the ttv is true.
 
-		if (m_wait_for_ttv && (pkt->get_ttv() == 0)) {
-			pktsToRecycle.push_back(pkt);
-			pkt_it = pktsToWork.erase(pkt_it);
-			if (m_bulkIO_data.size() > 0) {
+		if (WAIT_FOR_TTV && (pkt->get_ttv() == 0)) {
+			pktsToRecycle.push_back(handle);
+			pktsToWork.pop_front();
+			if (pendingBytes() > 0) {
 				pushPacket(false);
 			}
+			ref = NULL;
 			continue;
 		}
 
@@ -302,7 +816,7 @@ void SddsToBulkIOProcessor::processPackets(std::deque<SddsPacketPtr> &pktsToWork
 			// If the current ttv flag does not match this packets, there has been a state change.
 			// This only matters if the user has requested we push on ttv.
 			// If this is the case we need to push and restart with the new ttv state.
-			if (m_push_on_ttv && m_current_ttv_flag != (pkt->get_ttv() != 0) ) {
+			if (PUSH_ON_TTV && m_current_ttv_flag != (pkt->get_ttv() != 0) ) {
 				m_current_ttv_flag = (pkt->get_ttv() != 0);
 				pushPacket(false);
 				return;
@@ -313,20 +827,29 @@ void SddsToBulkIOProcessor::processPackets(std::deque<SddsPacketPtr> &pktsToWork
 			// We can assume that the SDDS streams SRI (xdelta) should stay the same for a given stream.
 			bool sriChanged = false;
 
-
-			{
+			// The lock is only taken once setUpstreamSri or unsetUpstreamSri has flagged a change
+			if (m_new_upstream_sri) {
 				boost::unique_lock<boost::mutex> lock(m_upstream_sri_lock);
-				if (m_upstream_sri_set && m_new_upstream_sri) {
+				if (m_new_upstream_sri) {
 					m_new_upstream_sri = false;
-					mergeUpstreamSRI(m_sri, m_upstream_sri, m_use_upstream_sri, sriChanged, m_endianness);
+					if (m_upstream_sri_set) {
+						mergeUpstreamSRI(m_sri, m_upstream_sri, m_use_upstream_sri, sriChanged, m_endianness);
+					}
+					m_swap = needsSwap();
+					m_sri_header_valid = false;
 				}
 			}
 
-			if (!m_use_upstream_sri) {
-				mergeSddsSRI(pkt.get(), m_sri, sriChanged, m_non_conforming_device);
+			// The rate and mode rarely change within a stream so the SRI is only merged when the header words they come from do.
+			// While the upstream SRI is used the words are forgotten, so the first packet after it is unset is merged.
+			if (m_use_upstream_sri) {
+				m_sri_header_valid = false;
+			} else if (sriHeaderChanged(pkt)) {
+				mergeSddsSRI(pkt, m_sri, sriChanged, m_non_conforming_device);
 			}
 
 			if (sriChanged) {
+				m_sri_changes++;
 				pushPacket(false);
 				pushSri();
 				updateExpectedXdelta(m_non_conforming_device ? pkt->get_rate() * 2 : pkt->get_rate(), pkt->cx != 0);
@@ -334,21 +857,21 @@ void SddsToBulkIOProcessor::processPackets(std::deque<SddsPacketPtr> &pktsToWork
 				return; // Refill our packets
 			}
 
-			// Create the bulkIO time stamp if this is the first packet to send.
-			if (m_bulkIO_data.size() == 0) {
-				m_bulkio_time_stamp = getBulkIOTimeStamp(pkt.get(), m_last_sdds_time, m_start_of_year);
+			// Create the bulkIO time stamp if this is the first packet to send, and pick how its data is copied.
+			if (pendingBytes() == 0) {
+				m_bulkio_time_stamp = getBulkIOTimeStamp(pkt, m_last_sdds_time, m_start_of_year);
+				m_copy = swapCopyFunction(m_swap ? m_bps : 8);
 			}
 
 			// Check for time slips
 			checkForTimeSlip(pkt);
 
-			// Did some quick testing to see if an insert or a resize + memcopy was faster, insert FTW.
-			//I wasn't sure if sizeof(pkt->d) would work but it does return 1024.
-			m_bulkIO_data.insert(m_bulkIO_data.end(), pkt->d, pkt->d + sizeof(pkt->d));
+			appendData(pool.data(handle), SDDS_DATA_SIZE);
 
 			// And we are done with this packet. Take it off the pktsToWork que and add it to the pktsToRecycle que.
-			pktsToRecycle.push_back(pkt);
-			pkt_it = pktsToWork.erase(pkt_it);
+			pktsToRecycle.push_back(handle);
+			pktsToWork.pop_front();
+			ref = pkt;
 
 			// Now that we are officially done with the packet we can increment our packet counter
 			m_expected_seq_number++;
@@ -358,88 +881,288 @@ void SddsToBulkIOProcessor::processPackets(std::deque<SddsPacketPtr> &pktsToWork
 				m_expected_seq_number++;
 
 			// We've worked through the full stack of packets, push the data and clear the buffer
-			if (pkt_it == pktsToWork.end()) {
+			if (pktsToWork.empty()) {
 				pushPacket(false);
-				m_bulkIO_data.clear();
 			}
 		}
 	}
 }
 
+/**
+ * Returns how many packets from the front of pktsToWork can follow ref, the last packet taken, with no checks but
+ * for time slips: their sequence numbers follow on, the CRC packet skip included, and they have ref's format, time
+ * tag valid flag and frequency so neither the SRI nor the TTV handling can change on them. The headers are decoded
+ * a batch at a time and the count stops at the first packet which fails, which is left to the per packet path.
+ */
+size_t SddsToBulkIOProcessor::plainPackets(SddsPacketPool &pool, const PacketHandleQueue &pktsToWork, SDDSheader *ref) {
+	HeaderBatch batch;
+	uint16_t format;
+	memcpy(&format, ref, sizeof(format));
+	const uint16_t ttv = ref->get_ttv();
+	const uint64_t freq = ref->freq;
+
+	// Can only be so when the first packet of the stream was a CRC packet, the per packet path deals with it
+	if (m_expected_seq_number % 32 == 31) {
+		return 0;
+	}
+
+	uint32_t expected = seqPosition(m_expected_seq_number);
+	size_t count = 0;
+	while (count < pktsToWork.size()) {
+		size_t len = std::min(pktsToWork.size() - count, (size_t) HEADER_BATCH_SIZE);
+		for (size_t i = 0; i < len; ++i) {
+			SDDSheader *pkt = pool.header(pktsToWork[count + i]);
+			memcpy(&batch.format[i], pkt, sizeof(batch.format[i]));
+			batch.seq[i] = pkt->get_seq();
+			batch.msptr[i] = pkt->msptr;
+			batch.freq[i] = pkt->freq;
+		}
+
+		for (size_t i = 0; i < len; ++i) {
+			uint32_t position = expected + i;
+			if (position >= SEQ_POSITIONS) {
+				position -= SEQ_POSITIONS;
+			}
+			batch.plain[i] = (seqPosition(batch.seq[i]) == position) & ((batch.seq[i] & 31) != 31) & (batch.format[i] == format) &
+					((batch.msptr[i] & 0x0040) == ttv) & (batch.freq[i] == freq);
+		}
+
+		size_t plain = 0;
+		while (plain < len && batch.plain[plain]) {
+			plain++;
+		}
+		count += plain;
+		if (plain < len) {
+			break;
+		}
+		expected = (expected + len) % SEQ_POSITIONS;
+	}
+	return count;
+}
+
+/**
+ * Takes the first count packets of pktsToWork, found by plainPackets, into the pending push. Their data is added a
+ * contiguous run at a time and their handles are moved to pktsToRecycle together. Should a time slip check find the
+ * device does not conform the packets after it are left for the per packet path, as the SRI has to change.
+ * Returns the header of the last packet taken.
+ */
+SDDSheader* SddsToBulkIOProcessor::takePlainPackets(SddsPacketPool &pool, PacketHandleQueue &pktsToWork, PacketHandleQueue &pktsToRecycle, size_t count) {
+	uint8_t *run = NULL;
+	size_t run_len = 0;
+	for (size_t i = 0; i < count; ++i) {
+		PacketHandle handle = pktsToWork[i];
+		bool non_conforming_device = m_non_conforming_device;
+		checkForTimeSlip(pool.header(handle));
+
+		uint8_t *data = pool.data(handle);
+		if (run_len && data != run + run_len) {
+			appendData(run, run_len);
+			run_len = 0;
+		}
+		if (run_len == 0) {
+			run = data;
+		}
+		run_len += SDDS_DATA_SIZE;
+
+		if (m_non_conforming_device != non_conforming_device) {
+			count = i + 1;
+			break;
+		}
+	}
+	if (run_len) {
+		appendData(run, run_len);
+	}
+
+	SDDSheader *last = pool.header(pktsToWork[count - 1]);
+	pktsToRecycle.insert(pktsToRecycle.end(), pktsToWork.begin(), pktsToWork.begin() + count);
+	pktsToWork.erase_begin(count);
+
+	m_expected_seq_number = last->get_seq() + 1;
+	if (m_expected_seq_number % 32 == 31) {
+		m_expected_seq_number++;
+	}
+	return last;
+}
+
 /**
  * Pushes the current SRI to the appropriate port based on m_bps.
  */
 void SddsToBulkIOProcessor::pushSri() {
+	if (m_converting) {
+		ConversionJob *job = takeFreeJob(ConversionJob::JOB_SRI);
+		job->bps = m_bps;
+		job->sri = m_sri;
+		submitJob(job);
+		return;
+	}
+	pushSriTo(m_bps, m_sri);
+}
+
+/**
+ * Pushes sri to the port for bps.
+ */
+void SddsToBulkIOProcessor::pushSriTo(unsigned short bps, const BULKIO::StreamSRI &sri) {
 	LOG_DEBUG(SddsToBulkIOProcessor, "Pushing SRI");
-	switch(m_bps) {
+	switch(bps) {
 	case 8:
-		m_octet_out->pushSRI(m_sri);
+		m_octet_out->pushSRI(sri);
 		break;
 	case 16:
-		m_short_out->pushSRI(m_sri);
+		m_short_out->pushSRI(sri);
 		break;
 	case 32:
-		m_float_out->pushSRI(m_sri);
+		m_float_out->pushSRI(sri);
 		break;
 	default:
-		LOG_ERROR(SddsToBulkIOProcessor, "Could not push sri, either the bits per sample is non-standard set to: " << m_bps);
+		LOG_ERROR(SddsToBulkIOProcessor, "Could not push sri, either the bits per sample is non-standard set to: " << bps);
 		break;
 	}
 
 }
 
+/**
+ * Adds the data portion of one or more packets, len bytes starting at data, to what will be sent on the next push.
+ *
+ * When zero copy is enabled and the data follows directly after the previous packet's data in the pool,
+ * which is the normal case since the socket reader fills the pool in order, we only extend the pointer / length
+ * of the run to push and nothing is copied. The packets stay in pktsToRecycle until processPackets returns, and
+ * it always pushes before returning, so the memory can not be reused out from under us. If the data is not
+ * contiguous (the pool wrapped) the run is copied into m_bulkIO_data and this push falls back to copying.
+ * A run is byte swapped in place when it is pushed, copied data is swapped as it is copied, see copyData.
+ */
+void SddsToBulkIOProcessor::appendData(uint8_t *data, size_t len) {
+	// The conversion threads do the copy, see convertJob
+	if (m_converting) {
+		if (not m_open_job) {
+			m_open_job = takeFreeJob(ConversionJob::JOB_PUSH);
+		}
+		for (size_t offset = 0; offset < len; offset += SDDS_DATA_SIZE) {
+			m_open_job->packets.push_back(data + offset);
+		}
+		return;
+	}
+
+	if (m_zero_copy && m_bulkIO_len == 0 && (m_run_len == 0 || data == m_run_start + m_run_len)) {
+		if (m_run_len == 0) {
+			m_run_start = data;
+		}
+		m_run_len += len;
+		return;
+	}
+
+	if (m_run_len) {
+		copyData(m_run_start, m_run_len);
+		m_run_len = 0;
+	}
+
+	copyData(data, len);
+}
+
+/**
+ * Appends len bytes of data to what will be sent on the next push, byte swapping it to host order on the way if need
+ * be so the data is only gone over once.
+ */
+void SddsToBulkIOProcessor::copyData(const uint8_t *data, size_t len) {
+	// Only if the push has outgrown the packets per read, which sizeData has already allowed for
+	if (m_bulkIO_len + len > m_bulkIO_data.size()) {
+		sizeData(m_bulkIO_len + len);
+	}
+
+	m_copy(&m_bulkIO_data[m_bulkIO_len], data, len);
+	m_bulkIO_len += len;
+}
+
+/**
+ * Makes room for at least len bytes in m_bulkIO_data. It is never shrunk.
+ */
+void SddsToBulkIOProcessor::sizeData(size_t len) {
+	if (m_bulkIO_data.size() < len) {
+		m_bulkIO_data.resize(len);
+	}
+}
+
 /**
  * Pushes bulkIO and possibly an SRI packet if SRI has never been sent to that port.
- * Will also clear the m_bulkIO_data vector.
+ * The data pushed is either the zero copy run or the m_bulkIO_data vector, both are cleared.
  */
 //TODO: Do we ever need to push an EOS flag?
 void SddsToBulkIOProcessor::pushPacket(bool eos) {
-	if (m_bulkIO_data.size() == 0 and !eos) {
+	if (pendingBytes() == 0 and !eos) {
 		return;
 	}
 
-	switch(m_bps) {
+	// The push is made by the sequencer once the conversion threads have the data ready
+	if (m_converting) {
+		ConversionJob *job = (m_open_job) ? m_open_job : takeFreeJob(ConversionJob::JOB_PUSH);
+		m_open_job = NULL;
+		job->bps = m_bps;
+		job->sri = m_sri;
+		job->swap = m_swap;
+		job->eos = eos;
+		job->time_stamp = m_bulkio_time_stamp;
+		submitJob(job);
+		return;
+	}
+
+	uint8_t *data = m_run_len ? m_run_start : &m_bulkIO_data[0];
+	size_t len = m_run_len ? m_run_len : m_bulkIO_len;
+	uint64_t push_start = m_auto_tune ? monotonicNanos() : 0;
+
+	// Copied data was swapped as it was copied
+	if (m_run_len) {
+		m_copy(data, data, len);
+	}
+	pushData(m_bps, m_sri, data, len, m_bulkio_time_stamp, eos);
+
+	if (m_auto_tune) {
+		__sync_fetch_and_add(&m_tune_push_ns, monotonicNanos() - push_start);
+	}
+
+	m_bulkIO_len = 0;
+	m_run_len = 0;
+}
+
+/**
+ * Pushes len bytes of data, already in host byte order, to the port for bps. The SRI is pushed first if the port
+ * has not seen the stream yet.
+ */
+void SddsToBulkIOProcessor::pushData(unsigned short bps, const BULKIO::StreamSRI &sri, uint8_t *data, size_t len,
+		const BULKIO::PrecisionUTCTime &time_stamp, bool eos) {
+	switch(bps) {
 	case 8:
-		if (m_octet_out->getCurrentSRI().count(m_sri.streamID.in())==0) {
-			m_octet_out->pushSRI(m_sri);
+		if (m_octet_out->getCurrentSRI().count(sri.streamID.in())==0) {
+			m_octet_out->pushSRI(sri);
 		}
 
-		m_octet_out->pushPacket(m_bulkIO_data, m_bulkio_time_stamp, eos, m_sri.streamID.in());
+		m_octet_out->pushPacket(data, len, time_stamp, eos, sri.streamID.in());
 		break;
 	case 16:
-		if (m_short_out->getCurrentSRI().count(m_sri.streamID.in())==0) {
-			m_short_out->pushSRI(m_sri);
-		}
-
-		// Ugh, we need to byte swap. At least there is a nice builtin for swapping bytes for shorts.
-		if (atol(m_endianness.c_str()) != __BYTE_ORDER) {
-			swab(&m_bulkIO_data[0], &m_bulkIO_data[0], m_bulkIO_data.size());
+		if (m_short_out->getCurrentSRI().count(sri.streamID.in())==0) {
+			m_short_out->pushSRI(sri);
 		}
 
-		m_short_out->pushPacket(reinterpret_cast<short*> (&m_bulkIO_data[0]), m_bulkIO_data.size()/sizeof(short), m_bulkio_time_stamp, eos, m_sri.streamID.in());
+		m_short_out->pushPacket(reinterpret_cast<short*> (data), len/sizeof(short), time_stamp, eos, sri.streamID.in());
 		break;
 	case 32:
-		if (m_float_out->getCurrentSRI().count(m_sri.streamID.in())==0) {
-			m_float_out->pushSRI(m_sri);
+		if (m_float_out->getCurrentSRI().count(sri.streamID.in())==0) {
+			m_float_out->pushSRI(sri);
 		}
 
-		// Ugh, we need to byte swap and for floats there is no nice method for us to use like there is for shorts. Time to iterate.
-		if (atol(m_endianness.c_str()) != __BYTE_ORDER) {
-			uint32_t *buf = reinterpret_cast<uint32_t*>(&m_bulkIO_data[0]);
-			for (size_t i = 0; i < m_bulkIO_data.size() / sizeof(float); ++i) {
-				buf[i] = __builtin_bswap32(buf[i]);
-			}
-		}
-
-		m_float_out->pushPacket(reinterpret_cast<float*>(&m_bulkIO_data[0]), m_bulkIO_data.size()/sizeof(float), m_bulkio_time_stamp, eos, m_sri.streamID.in());
+		m_float_out->pushPacket(reinterpret_cast<float*>(data), len/sizeof(float), time_stamp, eos, sri.streamID.in());
 		break;
 	default:
-		LOG_ERROR(SddsToBulkIOProcessor, "Could not push packet, the bits per sample are non-standard and set to: " << m_bps);
+		LOG_ERROR(SddsToBulkIOProcessor, "Could not push packet, the bits per sample are non-standard and set to: " << bps);
 		break;
 	}
+}
 
-	m_bulkIO_data.clear();
+/**
+ * True if the data must be byte swapped to host order before it is pushed.
+ */
+bool SddsToBulkIOProcessor::needsSwap() {
+	return atol(m_endianness.c_str()) != __BYTE_ORDER;
 }
+
 /**
  * Returns whether the processor is set to push on a time tag valid flag change.
  * See the documentation for details.
@@ -508,8 +1231,21 @@ void SddsToBulkIOProcessor::unsetUpstreamSri() {
 	boost::unique_lock<boost::mutex> lock(m_upstream_sri_lock);
 	m_use_upstream_sri = false;
 	m_upstream_sri_set = false;
+	m_new_upstream_sri = true;	// So the packets after this one are not taken without merging the SDDS SRI again
 	m_endianness = ENDIANNESS::ENDIAN_DEFAULT; // Default to big endian
-	m_sri.streamID = "DEFAULT_SDDS_STREAM_ID";
+	m_swap = needsSwap();
+	m_sri.streamID = m_default_stream_id.c_str();
+}
+
+/**
+ * Sets the stream ID used when there is no upstream SRI, DEFAULT_SDDS_STREAM_ID unless set.
+ */
+void SddsToBulkIOProcessor::setDefaultStreamId(std::string stream_id) {
+	boost::unique_lock<boost::mutex> lock(m_upstream_sri_lock);
+	m_default_stream_id = stream_id;
+	if (not m_upstream_sri_set) {
+		m_sri.streamID = m_default_stream_id.c_str();
+	}
 }
 
 /**
@@ -556,6 +1292,7 @@ void SddsToBulkIOProcessor::setEndianness(std::string endianness) {
 	}
 
 	m_endianness = endianness;
+	m_swap = needsSwap();
 }
 
 /**
@@ -566,3 +1303,10 @@ void SddsToBulkIOProcessor::setEndianness(std::string endianness) {
 long SddsToBulkIOProcessor::getTimeSlips() {
 	return m_num_time_slips;
 }
+
+/**
+ * Returns the number of times the SRI has changed, from either the SDDS headers or the upstream SRI, and been pushed again.
+ */
+uint64_t SddsToBulkIOProcessor::getSriChanges() {
+	return m_sri_changes;
+}
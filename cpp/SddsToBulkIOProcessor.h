@@ -27,13 +27,16 @@
 #ifndef SDDSTOBULKIOPROCESSOR_H_
 #define SDDSTOBULKIOPROCESSOR_H_
 
-#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
 #include <deque>
 #include <vector>
 
-#include "SmartPacketBuffer.h"
+#include "PacketBuffer.h"
+#include "SwapCopy.h"
 #include "ossie/debug.h"
 #include "sddspacket.h"
+#include "SddsToBulkIOUtils.h"
 #include "bulkio.h"
 
 #define SDDS_PACKET_SIZE 1080
@@ -41,21 +44,33 @@
 #define DEFAULT_PKTS_PER_READ 500
 #define CORBA_MAX_XFER_BYTES omniORB::giopMaxMsgSize() - 2048
 
-typedef boost::shared_ptr<SDDSpacket> SddsPacketPtr;
+// How often (in ms) auto tuning looks at the recent pushes and may change the push size.
+#define AUTO_TUNE_INTERVAL_MS 100
 
 class SddsToBulkIOProcessor {
 	ENABLE_LOGGING
 public:
 	SddsToBulkIOProcessor(bulkio::OutOctetPort *octet_out, bulkio::OutShortPort *short_out, bulkio::OutFloatPort *float_out);
 	virtual ~SddsToBulkIOProcessor();
-	void run(SmartPacketBuffer<SDDSpacket> *pktbuffer);
+	void run(PacketBuffer *pktbuffer);
+	void startShared(PacketBuffer *pktbuffer);
+	bool sharedReady();
+	bool processShared(size_t max_pushes);
+	void processInline();
+	void stopShared();
 	void setPktsPerRead(size_t pkts_per_read);
 	void shutDown();
 	void setWaitForTTV(bool wait_for_ttv);
 	void setPushOnTTV(bool push_on_ttv);
 	void setUpstreamSri(BULKIO::StreamSRI upstream_sri);
 	void unsetUpstreamSri();
+	void setDefaultStreamId(std::string stream_id);
 	size_t getPktsPerRead();
+	void setAutoTune(bool auto_tune);
+	bool getAutoTune();
+	void setPktsPerReadBounds(size_t min_pkts_per_read, size_t max_pkts_per_read);
+	void setConversionThreads(size_t conversion_threads);
+	size_t getConversionThreads();
 	bool getPushOnTTV();
 	bool getWaitOnTTV();
 	unsigned short getBps();
@@ -66,16 +81,21 @@ public:
 	std::string getEndianness();
 	void setEndianness(std::string endianness);
 	long getTimeSlips();
+	uint64_t getSriChanges();
 private:
-	size_t m_pkts_per_read;
+	typedef void (SddsToBulkIOProcessor::*ProcessLoop)(SddsPacketPool &pool, PacketHandleQueue &pktsToWork, PacketHandleQueue &pktsToRecycle);
+
+	volatile size_t m_pkts_per_read;
 	bool m_running;
 	bool m_shuttingDown;
 	bool m_wait_for_ttv;
 	bool m_push_on_ttv;
+	ProcessLoop m_process_loop;		// processPacketsAs for the TTV options above, picked as processing starts
 	bool m_first_packet;
 	bool m_current_ttv_flag;
 	uint16_t m_expected_seq_number;
-	std::vector<uint8_t> m_bulkIO_data;
+	std::vector<uint8_t> m_bulkIO_data;		// Sized up front, only the first m_bulkIO_len bytes are in use
+	size_t m_bulkIO_len;
 	SDDSTime m_last_sdds_time;
 	unsigned long long m_pkts_dropped;
 	time_t m_start_of_year;
@@ -88,19 +108,103 @@ private:
 	BULKIO::StreamSRI m_upstream_sri;
 	bool m_upstream_sri_set;
 	std::string m_endianness;
-	bool m_new_upstream_sri;
+	bool m_swap;				// m_endianness is not the host's, kept so the string is not parsed per push
+	SwapCopyFunction m_copy;	// Copies the data of the push being gathered, swapping it if need be
+	volatile bool m_new_upstream_sri;
 	bool m_use_upstream_sri;
 	long m_num_time_slips;
 	double m_current_sample_rate;
-	double m_max_time_step, m_min_time_step, m_ideal_time_step, m_time_error_accum, m_accum_error_tolerance;
+	SDDSTimeStep m_max_time_step, m_min_time_step, m_ideal_time_step, m_time_error_accum, m_accum_error_tolerance;
 	bool m_non_conforming_device;
+	bool m_sri_header_valid;	// The header words below are those the SRI was last merged from
+	uint16_t m_sri_format;		// The raw first two header bytes, sf through cx including bps and vw
+	uint64_t m_sri_freq;		// The raw frequency word
+	volatile uint64_t m_sri_changes;
+	bool m_zero_copy;
+	uint8_t *m_run_start;
+	size_t m_run_len;
+	bool m_auto_tune;
+	size_t m_min_pkts_per_read;
+	size_t m_max_pkts_per_read;
+	uint64_t m_tune_start_ns;
+	volatile uint64_t m_tune_push_ns;
+	double m_tune_occupancy;
+	size_t m_tune_samples;
 	boost::mutex m_upstream_sri_lock;
+	std::string m_default_stream_id;
+
+	// The packets being worked when processing is driven by processShared rather than run
+	PacketBuffer *m_shared_pktbuffer;
+	PacketBuffer::container_type m_shared_pkts_to_process;
+	PacketBuffer::container_type m_shared_pkts_to_recycle;
+	volatile size_t m_shared_pending;
+
+	/**
+	 * A unit of work handed to the conversion threads and sequencer when conversion_threads is set, see startConversion.
+	 * Jobs are handled by the sequencer strictly in the order they were submitted.
+	 */
+	struct ConversionJob {
+		enum Kind {
+			JOB_PUSH,		// Copy and byte swap the packets then push them
+			JOB_SRI,		// Push the SRI
+			JOB_RECYCLE		// Recycle the packets, every push using them has been made
+		};
+		Kind kind;
+		std::vector<uint8_t*> packets;
+		std::vector<uint8_t> data;
+		uint8_t *push_data;
+		size_t push_len;
+		unsigned short bps;
+		bool swap;
+		bool eos;
+		bool converted;
+		BULKIO::StreamSRI sri;
+		BULKIO::PrecisionUTCTime time_stamp;
+		PacketBuffer::container_type recycle;
+	};
+	size_t m_conversion_threads;
+	bool m_converting;
+	bool m_conversion_stopping;
+	PacketBuffer *m_conversion_pktbuffer;
+	ConversionJob *m_open_job;
+	boost::ptr_vector<ConversionJob> m_jobs;
+	std::deque<ConversionJob*> m_free_jobs;
+	std::deque<ConversionJob*> m_convert_queue;
+	std::deque<ConversionJob*> m_sequence_queue;
+	std::vector<boost::thread*> m_conversion_workers;
+	boost::thread *m_sequencer;
+	boost::mutex m_conversion_lock;
+	boost::condition_variable m_job_freed;
+	boost::condition_variable m_job_to_convert;
+	boost::condition_variable m_job_to_sequence;
 
-	void processPackets(std::deque<SddsPacketPtr> &pktsToWork, std::deque<SddsPacketPtr> &pktsToRecycle);
-	bool orderIsValid(SddsPacketPtr &pkt);
+	void selectProcessLoop();
+	void processPackets(SddsPacketPool &pool, PacketHandleQueue &pktsToWork, PacketHandleQueue &pktsToRecycle);
+	template <bool WAIT_FOR_TTV, bool PUSH_ON_TTV>
+	void processPacketsAs(SddsPacketPool &pool, PacketHandleQueue &pktsToWork, PacketHandleQueue &pktsToRecycle);
+	bool orderIsValid(SDDSheader *pkt);
+	bool sriHeaderChanged(SDDSheader *pkt);
+	size_t plainPackets(SddsPacketPool &pool, const PacketHandleQueue &pktsToWork, SDDSheader *ref);
+	SDDSheader* takePlainPackets(SddsPacketPool &pool, PacketHandleQueue &pktsToWork, PacketHandleQueue &pktsToRecycle, size_t count);
+	void appendData(uint8_t *data, size_t len);
+	void copyData(const uint8_t *data, size_t len);
+	void sizeData(size_t len);
+	size_t pendingBytes() const { return m_run_len + m_bulkIO_len + (m_open_job ? m_open_job->packets.size() * SDDS_DATA_SIZE : 0); }
 	void pushPacket(bool eos);
+	void pushData(unsigned short bps, const BULKIO::StreamSRI &sri, uint8_t *data, size_t len, const BULKIO::PrecisionUTCTime &time_stamp, bool eos);
+	void pushSriTo(unsigned short bps, const BULKIO::StreamSRI &sri);
+	bool needsSwap();
+	void startConversion(PacketBuffer *pktbuffer, size_t max_pkts);
+	void stopConversion();
+	ConversionJob* takeFreeJob(ConversionJob::Kind kind);
+	void submitJob(ConversionJob *job);
+	void recyclePackets(PacketBuffer *pktbuffer, PacketBuffer::container_type &pkts);
+	void convertJob(ConversionJob *job);
+	void runConversionWorker();
+	void runSequencer();
+	void tunePushSize(PacketBuffer *pktbuffer);
 	void pushSri();
-	void checkForTimeSlip(SddsPacketPtr &pkt);
+	void checkForTimeSlip(SDDSheader *pkt);
 	void updateExpectedXdelta(double rate, bool complex);
 };
 
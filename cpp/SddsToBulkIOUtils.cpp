@@ -55,7 +55,7 @@ time_t getStartOfYear() {
  * startOfYear is the value calculated from the getStartOfYear function and is updated if the year has rolled over.
  * lastWSec is the last whole number of seconds from the SDDS Packet and is updated each time. It is used to determine if the year has rolled over.
  */
-BULKIO::PrecisionUTCTime getBulkIOTimeStamp(SDDSpacket* sdds_pkt, const SDDSTime &last_sdds_time, time_t &startOfYear) {
+BULKIO::PrecisionUTCTime getBulkIOTimeStamp(SDDSheader* sdds_pkt, const SDDSTime &last_sdds_time, time_t &startOfYear) {
 	BULKIO::PrecisionUTCTime T;
 
 	// TODO: Originally the SourceNIC component always set this to TCS_VALID, why? Which is correct?
@@ -74,10 +74,10 @@ BULKIO::PrecisionUTCTime getBulkIOTimeStamp(SDDSpacket* sdds_pkt, const SDDSTime
 //	T.tfsec = modf(t.seconds(), &T.twsec);
 //	T.twsec += startOfYear; //add in the startofyear offset
 
-	unsigned long long frac_int = t.ps250() % 4000000000UL;
-	unsigned long long secs_int = t.ps250() - frac_int;
+	// The whole seconds are split off with integer arithmetic, which gives exactly what dividing them as a double did
+	unsigned long long secs_int = t.ps250() / 4000000000ULL;
+	unsigned long long frac_int = t.ps250() - secs_int * 4000000000ULL;
 	double frac_flt = frac_int / 4e9;
-	double secs_flt = secs_int / 4e9;
 	double ext_flt = 250e-12 * t.pf250() / SDDSTime_two32;
 	frac_flt += ext_flt;
 
@@ -87,13 +87,13 @@ BULKIO::PrecisionUTCTime getBulkIOTimeStamp(SDDSpacket* sdds_pkt, const SDDSTime
 		startOfYear = getStartOfYear();
 	}
 
-	T.twsec = secs_flt + startOfYear; //add in the startofyear offset
+	T.twsec = (double) secs_int + startOfYear; //add in the startofyear offset
 	T.tfsec = frac_flt;
 
 	return T;
 }
 
-void getWholeAndFracSec(SDDSpacket* sdds_pkt, uint64_t &whole_sec, uint64_t &frac_sec, time_t &startOfYear) {
+void getWholeAndFracSec(SDDSheader* sdds_pkt, uint64_t &whole_sec, uint64_t &frac_sec, time_t &startOfYear) {
 	SDDSTime t = sdds_pkt->get_SDDSTime();
 	unsigned long long frac_int = t.ps250() % 4000000000UL;
 	unsigned long long secs_int = t.ps250() - frac_int;
@@ -114,7 +114,7 @@ void getWholeAndFracSec(SDDSpacket* sdds_pkt, uint64_t &whole_sec, uint64_t &fra
  * Returns the bits per sample.
  * The SDDS packet only has 5 bits for this field so a value of 31 is equivalent to 32 bits.
  */
-unsigned short getBps(SDDSpacket* sdds_pkt) {
+unsigned short getBps(SDDSheader* sdds_pkt) {
 	return (sdds_pkt->bps == 31) ? (32) : (sdds_pkt->bps);
 }
 
@@ -124,7 +124,7 @@ unsigned short getBps(SDDSpacket* sdds_pkt) {
  * If values within the SRI object are changed, the changed boolean is set to true.
  * If no values within the SRI object is changed the boolean is set to false.
  */
-void mergeSddsSRI(SDDSpacket* sdds_pkt, BULKIO::StreamSRI &sri, bool &changed, bool non_conforming_device) {
+void mergeSddsSRI(SDDSheader* sdds_pkt, BULKIO::StreamSRI &sri, bool &changed, bool non_conforming_device) {
 
 	CORBA::Double recXdelta = (CORBA::Double)(1.0 / sdds_pkt->get_rate());
 
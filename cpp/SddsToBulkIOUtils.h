@@ -29,10 +29,59 @@ namespace ENDIANNESS {
 	const std::string ENDIAN_DEFAULT = BIG_ENDIAN_STR;
 }
 
+/**
+ * A signed difference between two SDDS times, kept as the time tag keeps time: whole 250 ps ticks and a 32 bit
+ * fraction of a tick, the value being ticks + frac / 2^32. Steps can be summed and compared exactly with integer
+ * arithmetic, so an accumulated error does not drift however long it runs.
+ */
+class SDDSTimeStep {
+public:
+	SDDSTimeStep() : m_ticks(0), m_frac(0) {}
+
+	explicit SDDSTimeStep(double seconds) {
+		double ticks = floor(seconds * 4000000000.0);
+		m_ticks = (int64_t) ticks;
+		m_frac = (uint32_t) ((seconds * 4000000000.0 - ticks) * SDDSTime_two32);
+	}
+
+	// The step from one time to the next, negative if next is earlier
+	SDDSTimeStep(const SDDSTime &from, const SDDSTime &to) {
+		m_ticks = (int64_t) (to.ps250() - from.ps250()) - (to.pf250() < from.pf250() ? 1 : 0);
+		m_frac = to.pf250() - from.pf250();
+	}
+
+	double seconds() const { return m_ticks * SDDSTime_tic + m_frac * (SDDSTime_tic / SDDSTime_two32); }
+	bool negative() const { return m_ticks < 0; }
+
+	SDDSTimeStep& operator+= (const SDDSTimeStep &other) {
+		uint64_t frac = (uint64_t) m_frac + other.m_frac;
+		m_ticks += other.m_ticks + (int64_t) (frac >> 32);
+		m_frac = (uint32_t) frac;
+		return *this;
+	}
+
+	SDDSTimeStep& operator-= (const SDDSTimeStep &other) {
+		m_ticks -= other.m_ticks + (m_frac < other.m_frac ? 1 : 0);
+		m_frac -= other.m_frac;
+		return *this;
+	}
+
+	SDDSTimeStep operator+ (const SDDSTimeStep &other) const { SDDSTimeStep sum(*this); return sum += other; }
+	SDDSTimeStep operator- () const { SDDSTimeStep zero; return zero -= *this; }
+
+	bool operator< (const SDDSTimeStep &other) const {
+		return (m_ticks == other.m_ticks) ? (m_frac < other.m_frac) : (m_ticks < other.m_ticks);
+	}
+
+private:
+	int64_t m_ticks;
+	uint32_t m_frac;
+};
+
 time_t getStartOfYear();
-BULKIO::PrecisionUTCTime getBulkIOTimeStamp(SDDSpacket* sdds_pkt, const SDDSTime &last_sdds_time, time_t &startOfYear);
-unsigned short getBps(SDDSpacket* sdds_pkt);
-void mergeSddsSRI(SDDSpacket* sdds_pkt, BULKIO::StreamSRI &sri, bool &changed, bool non_conforming_device);
+BULKIO::PrecisionUTCTime getBulkIOTimeStamp(SDDSheader* sdds_pkt, const SDDSTime &last_sdds_time, time_t &startOfYear);
+unsigned short getBps(SDDSheader* sdds_pkt);
+void mergeSddsSRI(SDDSheader* sdds_pkt, BULKIO::StreamSRI &sri, bool &changed, bool non_conforming_device);
 void mergeUpstreamSRI(BULKIO::StreamSRI &currSRI, BULKIO::StreamSRI &upstreamSRI, bool &useUpstream, bool &changed, std::string &endianness);
 
 
@@ -0,0 +1,262 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * SharedReaderEngine.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#include "SharedReaderEngine.h"
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <memory>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+PREPARE_LOGGING(SharedReaderEngine)
+
+SharedReaderEngine& SharedReaderEngine::instance() {
+	static SharedReaderEngine engine;
+	return engine;
+}
+
+SharedReaderEngine::SharedReaderEngine() {
+}
+
+/**
+ * Stops any engine thread still running, which only happens if a reader was never detached.
+ */
+SharedReaderEngine::~SharedReaderEngine() {
+	for (size_t i = 0; i < m_loops.size(); ++i) {
+		stopLoop(&m_loops[i]);
+		close(m_loops[i].epoll_fd);
+		close(m_loops[i].wake_fd);
+	}
+}
+
+/**
+ * Starts reading the socket of reader, which must already have its connection info set, into pktbuffer on one of
+ * the engine threads. The engine runs as many threads as the largest num_threads it has been given, each new reader
+ * going to the thread with the fewest streams. Returns false, with the socket closed, if the reader could not be added.
+ * If given, on_read is called on the engine thread after every read of the socket and must not call into the engine.
+ */
+bool SharedReaderEngine::attach(SocketReader *reader, PacketBuffer *pktbuffer, bool confirmHosts, size_t num_threads, size_t budget,
+		boost::function<void ()> on_read) {
+	boost::mutex::scoped_lock lock(m_lock);
+
+	Loop *loop = pickLoop(std::max(num_threads, (size_t) 1));
+	if (not loop) {
+		reader->stopShared();
+		return false;
+	}
+
+	if (not reader->startShared(pktbuffer, confirmHosts)) {
+		return false;
+	}
+	int socket = reader->getSharedSocket();
+
+	{
+		boost::mutex::scoped_lock loop_lock(loop->lock);
+		struct epoll_event ev;
+		memset(&ev, 0, sizeof(ev));
+		ev.events = EPOLLIN;
+		ev.data.fd = socket;
+		if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, socket, &ev) != 0) {
+			LOG_ERROR(SharedReaderEngine, "Failed to add the socket to the shared reader: " << strerror(errno));
+			reader->stopShared();
+			return false;
+		}
+
+		Stream stream;
+		stream.reader = reader;
+		stream.budget = std::max(budget, (size_t) 1);
+		stream.dead = false;
+		stream.on_read = on_read;
+		loop->streams[socket] = stream;
+	}
+	m_readers[reader] = std::make_pair(loop, socket);
+
+	if (not loop->thread) {
+		loop->stop = false;
+		loop->thread = new boost::thread(boost::bind(&SharedReaderEngine::run, this, loop));
+	}
+
+	LOG_DEBUG(SharedReaderEngine, "Added a stream to a shared reader thread, it now reads " << loop->streams.size());
+	return true;
+}
+
+/**
+ * Stops reading from reader and closes its socket. Once this returns the engine no longer touches the reader or its
+ * packet buffer. An engine thread left without streams is stopped.
+ */
+void SharedReaderEngine::detach(SocketReader *reader) {
+	boost::mutex::scoped_lock lock(m_lock);
+
+	std::map<SocketReader*, std::pair<Loop*, int> >::iterator it = m_readers.find(reader);
+	if (it == m_readers.end()) {
+		return;
+	}
+	Loop *loop = it->second.first;
+	int socket = it->second.second;
+	m_readers.erase(it);
+
+	{
+		boost::mutex::scoped_lock loop_lock(loop->lock);
+		std::map<int, Stream>::iterator stream = loop->streams.find(socket);
+		if (stream != loop->streams.end()) {
+			if (not stream->second.dead) {
+				epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, socket, NULL);
+			}
+			loop->streams.erase(stream);
+		}
+		loop->starved.erase(std::remove(loop->starved.begin(), loop->starved.end(), socket), loop->starved.end());
+	}
+	reader->stopShared();
+
+	if (loop->streams.empty()) {
+		stopLoop(loop);
+	}
+}
+
+/**
+ * Returns the loop for a new stream, adding one while there are fewer than num_threads, or NULL if one could not be
+ * created. Must be called with m_lock held.
+ */
+SharedReaderEngine::Loop* SharedReaderEngine::pickLoop(size_t num_threads) {
+	Loop *least = NULL;
+	for (size_t i = 0; i < m_loops.size(); ++i) {
+		if (not least or m_loops[i].streams.size() < least->streams.size()) {
+			least = &m_loops[i];
+		}
+	}
+	if (least and (least->streams.empty() or m_loops.size() >= num_threads)) {
+		return least;
+	}
+
+	std::auto_ptr<Loop> loop(new Loop());
+	loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	loop->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.fd = loop->wake_fd;
+	if (loop->epoll_fd < 0 or loop->wake_fd < 0 or epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->wake_fd, &ev) != 0) {
+		LOG_ERROR(SharedReaderEngine, "Failed to create a shared reader thread: " << strerror(errno));
+		if (loop->epoll_fd >= 0) close(loop->epoll_fd);
+		if (loop->wake_fd >= 0) close(loop->wake_fd);
+		return least;
+	}
+
+	m_loops.push_back(loop.release());
+	return &m_loops.back();
+}
+
+/**
+ * Wakes the thread of loop and waits for it to exit. Must be called with m_lock held.
+ */
+void SharedReaderEngine::stopLoop(Loop *loop) {
+	if (not loop->thread) {
+		return;
+	}
+	loop->stop = true;
+	uint64_t one = 1;
+	if (write(loop->wake_fd, &one, sizeof(one)) != sizeof(one)) {
+		LOG_WARN(SharedReaderEngine, "Failed to wake the shared reader thread, it will exit once it next wakes");
+	}
+	loop->thread->join();
+	delete loop->thread;
+	loop->thread = NULL;
+}
+
+/**
+ * The engine thread, reads from the ready sockets of loop until stopLoop is called.
+ */
+void SharedReaderEngine::run(Loop *loop) {
+	pthread_setname_np(pthread_self(), "SharedReader");
+	struct epoll_event events[SHARED_READER_MAX_EVENTS];
+	bool starved = false;
+
+	while (not loop->stop) {
+		int num = epoll_wait(loop->epoll_fd, events, SHARED_READER_MAX_EVENTS, starved ? SHARED_READER_STARVED_WAIT_MS : -1);
+		if (num < 0 and errno != EINTR) {
+			LOG_ERROR(SharedReaderEngine, "Unexpected error waiting on the shared reader sockets, the thread will stop reading: " << strerror(errno));
+			break;
+		}
+
+		boost::mutex::scoped_lock loop_lock(loop->lock);
+
+		// Streams with no empty buffers go back on the epoll set once their processor has freed some
+		for (size_t i = 0; i < loop->starved.size(); ) {
+			int socket = loop->starved[i];
+			std::map<int, Stream>::iterator stream = loop->streams.find(socket);
+			if (stream != loop->streams.end() and not stream->second.reader->sharedStarved()) {
+				struct epoll_event ev;
+				memset(&ev, 0, sizeof(ev));
+				ev.events = EPOLLIN;
+				ev.data.fd = socket;
+				epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, socket, &ev);
+				loop->starved[i] = loop->starved.back();
+				loop->starved.pop_back();
+			} else {
+				++i;
+			}
+		}
+
+		for (int i = 0; i < num; ++i) {
+			int socket = events[i].data.fd;
+			if (socket == loop->wake_fd) {
+				uint64_t count;
+				while (read(loop->wake_fd, &count, sizeof(count)) > 0) {}
+				continue;
+			}
+
+			// The stream may have been detached since the wait returned
+			std::map<int, Stream>::iterator stream = loop->streams.find(socket);
+			if (stream == loop->streams.end() or stream->second.dead) {
+				continue;
+			}
+
+			struct epoll_event ev;
+			memset(&ev, 0, sizeof(ev));
+			ev.data.fd = socket;
+
+			switch (stream->second.reader->readShared(stream->second.budget)) {
+			case SHARED_READ_STARVED:
+				epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, socket, &ev);
+				loop->starved.push_back(socket);
+				break;
+			case SHARED_READ_ERROR:
+				epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, socket, NULL);
+				stream->second.dead = true;
+				break;
+			default:
+				break;
+			}
+			if (stream->second.on_read and not stream->second.dead) {
+				stream->second.on_read();
+			}
+		}
+		starved = not loop->starved.empty();
+	}
+}
@@ -0,0 +1,100 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * SharedReaderEngine.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#ifndef SHAREDREADERENGINE_H_
+#define SHAREDREADERENGINE_H_
+
+#include <map>
+#include <vector>
+#include <boost/thread.hpp>
+#include <boost/function.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include "SocketReader.h"
+#include "ossie/debug.h"
+
+// The most socket events handled per wake up of an engine thread.
+#define SHARED_READER_MAX_EVENTS 64
+
+// How long (in ms) an engine thread waits before checking again on streams that had no empty buffers to read into.
+#define SHARED_READER_STARVED_WAIT_MS 1
+
+/**
+ * Reads the sockets of many socket readers from a few threads rather than a thread per reader. There is one engine per
+ * process, shared by every SourceSDDS instance in it which sets shared_reader_threads, so many low and medium rate
+ * streams can share a few cores.
+ *
+ * Each engine thread waits on an epoll set of sockets. When it wakes every ready socket is read, through its own
+ * SocketReader into its own packet buffer and so its own SDDS to BulkIO processor, until the socket is empty or its
+ * budget of packets for the wake up is used. The epoll set is level triggered, so a socket cut off by its budget is
+ * reported again on the next wake up after the others have had their turn. A stream whose packet buffer has no empty
+ * buffers is taken off the epoll set rather than wait, and put back once its processor has freed some.
+ *
+ * A stream may be given a callback which is called on the engine thread after each read of its socket, the attached
+ * streams use it to schedule their processing on the stream worker pool.
+ */
+class SharedReaderEngine {
+	ENABLE_LOGGING
+public:
+	static SharedReaderEngine& instance();
+
+	bool attach(SocketReader *reader, PacketBuffer *pktbuffer, bool confirmHosts, size_t num_threads, size_t budget,
+			boost::function<void ()> on_read = boost::function<void ()>());
+	void detach(SocketReader *reader);
+
+private:
+	struct Stream {
+		SocketReader *reader;
+		size_t budget;
+		bool dead;
+		boost::function<void ()> on_read;
+	};
+
+	struct Loop {
+		Loop(): epoll_fd(-1), wake_fd(-1), thread(NULL), stop(false) {}
+		int epoll_fd;
+		int wake_fd;
+		boost::thread *thread;
+		volatile bool stop;
+		boost::mutex lock; // Held while the thread reads, so a stream is never removed part way through
+		std::map<int, Stream> streams;
+		std::vector<int> starved;
+	};
+
+	SharedReaderEngine();
+	~SharedReaderEngine();
+	SharedReaderEngine(const SharedReaderEngine&);              // Disabled copy constructor
+	SharedReaderEngine& operator = (const SharedReaderEngine&); // Disabled assign operator
+
+	Loop* pickLoop(size_t num_threads);
+	void stopLoop(Loop *loop);
+	void run(Loop *loop);
+
+	boost::mutex m_lock;
+	boost::ptr_vector<Loop> m_loops;
+	std::map<SocketReader*, std::pair<Loop*, int> > m_readers;
+};
+
+#endif /* SHAREDREADERENGINE_H_ */
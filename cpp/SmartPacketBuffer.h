@@ -35,16 +35,24 @@
 #include <string>
 #include <stdio.h>
 #include <iostream>
-#include <deque>
+#include <time.h>
+#include "PacketBuffer.h"
+
+// An elastic buffer grows once fewer than 1/ELASTIC_LOW_WATERMARK of its buffers have stayed empty for ELASTIC_PRESSURE_MS.
+#define ELASTIC_LOW_WATERMARK 8
+#define ELASTIC_PRESSURE_MS 10
+
+// An elastic buffer shrinks once at least half its buffers have stayed empty for ELASTIC_QUIET_MS.
+#define ELASTIC_QUIET_MS 10000
 
 
 /**
- * Two deques of boost smart pointers
- * One deque full of empty buffers to be used
- * One deque where filled buffers are placed.
+ * Two circular buffers of packet handles
+ * One full of empty buffers to be used
+ * One where filled buffers are placed.
  * You MUST follow this cycle: pop_empty_buffer -> push_full_buffer -> pop_full_buffer -> recycle_buffer
- * Memory is only allocated at construction so if you do not follow the above cycle and a smart pointer goes
- * out of scope it will free itself.
+ * Memory is only allocated by initialize, if you do not follow the above cycle the handle is simply lost
+ * until the next call to initialize.
  *
  * The locking here is done with conditional variables so that it should be quick however if this ends up being
  * a point of thread contention it could be reimplemented using a no-wait no-locking queue. I've tested it at
@@ -54,44 +62,76 @@
  * There is no license or copyright shown however after emailing him regarding use he responded with
  * "Hi Youssef, it’s “as is” for you to use. Thanks,"
  *
+ * See LockFreePacketBuffer for the single producer single consumer alternative, this class is kept as the default.
+ *
+ * Given a max capacity above the capacity it is initialized with the buffer is elastic, see set_max_capacity.
  */
-template <class T >
-class SmartPacketBuffer {
+class SmartPacketBuffer : public PacketBuffer {
 public:
 
-	typedef boost::shared_ptr<T> TypePtr;
-    typedef std::deque<TypePtr> container_type;
-    typedef typename container_type::size_type size_type;
-    typedef typename container_type::value_type value_type;
+    explicit SmartPacketBuffer():m_shuttingDown(false), m_max_capacity(0), m_base_capacity(0), m_high_water(0),
+    		m_elastic(false), m_pressure_start(0), m_quiet_start(0), m_shrink_to(0) {}
 
-    explicit SmartPacketBuffer():m_shuttingDown(false) {}
+    /**
+     * Makes the next initialize create an elastic buffer which can hold up to max_capacity buffers, 0 (the default)
+     * keeps it at the capacity initialize is given.
+     *
+     * An elastic buffer starts at the capacity it is initialized with and grows by that many buffers, up to
+     * max_capacity, whenever the socket reader finds the empty buffers have stayed below the low watermark for
+     * ELASTIC_PRESSURE_MS. The packets in use do not move as it grows, see SddsPacketPool. Once it has been at least half
+     * empty for ELASTIC_QUIET_MS it shrinks by the same step: the buffers above the new capacity are taken out of
+     * circulation as they come back empty and their memory is given back once the last one has.
+     */
+    void set_max_capacity(size_type max_capacity) {
+    	m_max_capacity = max_capacity;
+    }
 
     /**
-     * Initializes the empty buffers container with capacity
-     * new Boost shared pointers of the templated type provided.
+     * The largest capacity the buffer has reached since it was initialized.
+     */
+    size_type capacity_high_water() const {
+    	return m_high_water;
+    }
+
+    /**
+     * Allocates the packet pool with room for capacity packets and fills
+     * the empty buffers container with a handle to each of them.
+     * See SddsPacketPool for split_data.
      * If this Smart Packet Buffer was previously initialized,
-     * one should call destroy buffers before the call to initialize.
-     * Only the empty buffer container is cleared prior to initialization.
+     * one should call shutDown and join the threads using it before the call to initialize
+     * since the previous pool is freed.
      *
      * @param capacity The size of the emtpy buffers container after initialization
      */
-    void initialize(size_type capacity) {
-    	boost::unique_lock<boost::mutex> lock(m_empty_buffer_mutex);
+    void initialize(size_type capacity, bool split_data) {
+    	boost::unique_lock<boost::mutex> lock1(m_full_buffer_mutex);
+    	boost::unique_lock<boost::mutex> lock2(m_empty_buffer_mutex);
 		m_shuttingDown = false;
+    	m_pool.initialize(capacity, split_data, m_max_capacity);
+    	m_capacity = capacity;
+    	m_base_capacity = capacity;
+    	m_high_water = capacity;
+    	m_elastic = m_pool.max_capacity() > capacity;
+    	m_pressure_start = m_quiet_start = 0;
+    	m_shrink_to = 0;
+
+    	// The containers can hold every handle the buffer may grow to so they never allocate after this point
+    	m_full_buffers.clear();
+    	m_full_buffers.set_capacity(m_pool.max_capacity());
     	m_empty_buffers.clear();
+    	m_empty_buffers.set_capacity(m_pool.max_capacity());
+    	m_retired_buffers.clear();
+    	m_retired_buffers.set_capacity(m_pool.max_capacity());
 
-    	// Allocate the memory and fill the empty buffers
-    	for (size_t i = 0; i < capacity; ++i) {
-    		m_empty_buffers.push_back(TypePtr(new T()));
+    	for (PacketHandle h = 0; h < capacity; ++h) {
+    		m_empty_buffers.push_back(h);
     	}
-    	lock.unlock();
     }
 
     /**
      * Notifies any waiting thread that the packet buffer is shutting down and
-     * frees all the memory that the smart buffer currently is keeping track of.
-     * This does not include any buffers currently held by other threads which
-     * would need to be recycled or returned prior to calling destroyBuffers.
+     * empties both internal containers. The packet pool itself is kept until the next
+     * call to initialize since other threads may still hold handles into it.
      * There is no harm in calling shutDown more than once if one needs
      * to free the thread holding the data to recycle it.
      *
@@ -109,6 +149,7 @@ public:
 
     	boost::unique_lock<boost::mutex> lock2(m_empty_buffer_mutex);
     	m_empty_buffers.clear();
+    	m_retired_buffers.clear();
 		lock2.unlock();
     }
 
@@ -118,12 +159,12 @@ public:
      * if no empty buffers are available.
      * NOTE: Not as well tested as pop_empty_buffers but included for completness.
      */
-    TypePtr pop_empty_buffer() {
-    	if (m_shuttingDown) {return NULL;}
+    PacketHandle pop_empty_buffer() {
+    	if (m_shuttingDown) {return INVALID_PACKET_HANDLE;}
     	boost::unique_lock<boost::mutex> lock(m_empty_buffer_mutex);
-    	m_no_empty_buffers.wait(lock, boost::bind(&SmartPacketBuffer<T>::empties_available, this));
-    	if (m_shuttingDown) {return NULL;}
-    	TypePtr retVal = *m_empty_buffers.begin();
+    	m_no_empty_buffers.wait(lock, boost::bind(&SmartPacketBuffer::empties_available, this));
+    	if (m_shuttingDown) {return INVALID_PACKET_HANDLE;}
+    	PacketHandle retVal = *m_empty_buffers.begin();
     	m_empty_buffers.pop_front();
     	lock.unlock();
     	return retVal;
@@ -133,8 +174,7 @@ public:
      * Fill the provided container until it is len in size of empty buffers.
      * Will block until the request can be satisified (ie. there are len buffers available)
      */
-    template<typename Container>
-    void pop_empty_buffers(Container &que, size_t len) {
+    void pop_empty_buffers(container_type &que, size_t len) {
     		if (m_shuttingDown) {return;}
 
     		// Maybe they have what they want already
@@ -144,7 +184,16 @@ public:
         	size_t request = len - que.size();
 
         	boost::unique_lock<boost::mutex> lock(m_empty_buffer_mutex);
-        	m_no_empty_buffers.wait(lock, boost::bind(&SmartPacketBuffer<T>::empties_available, this, request));
+
+        	// An elastic buffer wakes up while it waits to see if it is time to grow
+        	if (m_elastic) {
+        		resize_elastic(request);
+        		while (not empties_available(request)) {
+        			m_no_empty_buffers.timed_wait(lock, boost::posix_time::milliseconds(ELASTIC_PRESSURE_MS));
+        			resize_elastic(request);
+        		}
+        	}
+        	m_no_empty_buffers.wait(lock, boost::bind(&SmartPacketBuffer::empties_available, this, request));
         	if (m_shuttingDown) {return;}
 
         	// Really wish we could use c++11 and just use move :-p
@@ -160,7 +209,7 @@ public:
      * if anther thread has the full buffer container lock.
      * NOTE: Not as well tested as push_full_buffers but included for completness.
      */
-    void push_full_buffer(TypePtr b) {
+    void push_full_buffer(PacketHandle b) {
     	if (m_shuttingDown) {return;}
     	boost::unique_lock<boost::mutex> lock(m_full_buffer_mutex);
     	m_full_buffers.push_back(b);
@@ -172,8 +221,7 @@ public:
      * Pushes all the buffers contained in provided container onto the internal full buffer container
      * and clears the povided container. Will block if another thread has the full buffer lock.
      */
-    template<typename Container>
-    void push_full_buffers(Container &que, size_t num) {
+    void push_full_buffers(container_type &que, size_t num) {
     	if (m_shuttingDown) {
     		que.erase(que.begin(), que.begin() + num);
     		return;
@@ -190,12 +238,12 @@ public:
      * Returns a single full buffer. Will block if a full buffer is not available.
      * NOTE: Not as well tested as pop_full_buffers but included for completness.
      */
-    TypePtr pop_full_buffer() {
-    	if (m_shuttingDown) {return NULL;}
+    PacketHandle pop_full_buffer() {
+    	if (m_shuttingDown) {return INVALID_PACKET_HANDLE;}
     	boost::unique_lock<boost::mutex> lock(m_full_buffer_mutex);
-		m_no_full_buffers.wait(lock, boost::bind(&SmartPacketBuffer<T>::full_available, this));
-		if (m_shuttingDown) {return NULL;}
-		TypePtr retVal = *m_full_buffers.begin();
+		m_no_full_buffers.wait(lock, boost::bind(&SmartPacketBuffer::full_available, this));
+		if (m_shuttingDown) {return INVALID_PACKET_HANDLE;}
+		PacketHandle retVal = *m_full_buffers.begin();
 		m_full_buffers.pop_front();
 		lock.unlock();
 		return retVal;
@@ -206,8 +254,7 @@ public:
      * Fill the provided container until it is len in size of full buffers.
      * Will block until len buffers are available.
      */
-    template<typename Container>
-    void pop_full_buffers(Container &que, size_t len) {
+    void pop_full_buffers(container_type &que, size_t len) {
     	if (m_shuttingDown) {return;}
 		// Maybe they have what they want already
     	if (que.size() >= len)
@@ -216,7 +263,7 @@ public:
     	size_t request = len - que.size();
 
     	boost::unique_lock<boost::mutex> lock(m_full_buffer_mutex);
-		m_no_full_buffers.wait(lock, boost::bind(&SmartPacketBuffer<T>::full_available, this, request));
+		m_no_full_buffers.wait(lock, boost::bind(&SmartPacketBuffer::full_available, this, request));
 		if (m_shuttingDown) {return;}
 
 		que.insert(que.end(), m_full_buffers.begin(), m_full_buffers.begin() + request);
@@ -230,7 +277,7 @@ public:
      * Will block if a nother thread holds the empty buffer lock.
      * NOTE: Not as well tested as recycle_buffers but included for completness.
      */
-    void recycle_buffer(TypePtr b) {
+    void recycle_buffer(PacketHandle b) {
     	if (m_shuttingDown) {return;}
     	boost::unique_lock<boost::mutex> lock(m_empty_buffer_mutex);
     	m_empty_buffers.push_back(b);
@@ -242,20 +289,51 @@ public:
      * Returns all buffers in provided que container to the internal empty buffer container.
      * Will block if another thread holds the empty buffer lock.
      */
-    template<typename Container>
-    void recycle_buffers(Container &que) {
+    void recycle_buffers(container_type &que) {
     	if (m_shuttingDown) {
     		que.clear();
     		return;
     	}
 
     	boost::unique_lock<boost::mutex> lock(m_empty_buffer_mutex);
+    	if (m_shrink_to) {
+    		retire(que);
+    	}
     	m_empty_buffers.insert(m_empty_buffers.end(), que.begin(), que.end());
     	que.clear();
     	lock.unlock();
     	m_no_empty_buffers.notify_one();
     }
 
+    /**
+     * Moves the num oldest buffers of the internal full buffer container to the empty buffer container,
+     * or none if there are fewer than num. Takes both locks, the full buffer lock first as initialize does.
+     */
+    size_t reclaim_full_buffers(size_t num) {
+    	if (m_shuttingDown) {return 0;}
+
+    	boost::unique_lock<boost::mutex> lock1(m_full_buffer_mutex);
+    	if (m_full_buffers.size() < num) {return 0;}
+
+    	boost::unique_lock<boost::mutex> lock2(m_empty_buffer_mutex);
+    	m_empty_buffers.insert(m_empty_buffers.end(), m_full_buffers.begin(), m_full_buffers.begin() + num);
+    	m_full_buffers.erase(m_full_buffers.begin(), m_full_buffers.begin() + num);
+    	lock2.unlock();
+    	lock1.unlock();
+    	m_no_empty_buffers.notify_one();
+    	return num;
+    }
+
+    /**
+     * Lets an elastic buffer grow when the socket reader does not wait for empty buffers, see set_max_capacity.
+     */
+    void check_capacity(size_t num) {
+    	if (not m_elastic or m_shuttingDown) {return;}
+
+    	boost::unique_lock<boost::mutex> lock(m_empty_buffer_mutex);
+    	resize_elastic(num);
+    }
+
     /**
      * Returns the number of buffers in the internal full buffers container.
      */
@@ -284,9 +362,99 @@ private:
     bool full_available() const { return m_full_buffers.size() > 0 						|| m_shuttingDown; }
     bool full_available(size_t num) const { return m_full_buffers.size() >= num 		|| m_shuttingDown; }
 
+    static uint64_t monotonicMillis() {
+    	struct timespec ts;
+    	clock_gettime(CLOCK_MONOTONIC, &ts);
+    	return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+    }
+
+    /**
+     * Called by the socket reader, with the empty buffer lock held, each time it asks for request empty buffers and
+     * again every ELASTIC_PRESSURE_MS while it waits for them. Grows or starts shrinking the buffer as the time the
+     * empty buffers have spent below the low watermark or above half the capacity says, see set_max_capacity.
+     * The pressure only lets up once the empty buffers are back above twice the low watermark, as the processor
+     * hands them back a push at a time. Pressure during a shrink calls it off and puts the buffers already taken
+     * out back into circulation.
+     */
+    void resize_elastic(size_t request) {
+    	uint64_t now = monotonicMillis();
+    	size_t empty = m_empty_buffers.size();
+    	size_t low = m_capacity / ELASTIC_LOW_WATERMARK;
+
+    	if (empty < request or empty < low) {
+    		m_quiet_start = 0;
+    		if (m_shrink_to) {
+    			m_empty_buffers.insert(m_empty_buffers.end(), m_retired_buffers.begin(), m_retired_buffers.end());
+    			m_retired_buffers.clear();
+    			m_shrink_to = 0;
+    		}
+    		if (m_pressure_start == 0) {
+    			m_pressure_start = now;
+    		} else if (now - m_pressure_start >= ELASTIC_PRESSURE_MS) {
+    			size_type target = std::min(m_capacity + m_base_capacity, m_pool.max_capacity());
+    			if (target > m_capacity and m_pool.grow(target)) {
+    				for (PacketHandle h = m_capacity; h < target; ++h) {
+    					m_empty_buffers.push_back(h);
+    				}
+    				m_capacity = target;
+    				m_high_water = std::max(m_high_water, m_capacity);
+    			}
+    			m_pressure_start = now;
+    		}
+    		return;
+    	}
+
+    	if (empty < 2 * low) {
+    		m_quiet_start = 0;
+    		return;
+    	}
+
+    	m_pressure_start = 0;
+    	if (m_shrink_to or m_capacity <= m_base_capacity or empty < m_capacity / 2) {
+    		m_quiet_start = 0;
+    	} else if (m_quiet_start == 0) {
+    		m_quiet_start = now;
+    	} else if (now - m_quiet_start >= ELASTIC_QUIET_MS) {
+    		m_shrink_to = std::max(m_capacity - m_base_capacity, m_base_capacity);
+    		m_quiet_start = 0;
+    		retire(m_empty_buffers);
+    	}
+    }
+
+    /**
+     * Moves the buffers in que which are above the capacity being shrunk to out of circulation, with the empty buffer
+     * lock held. Once every one of them is out the pool gives back their memory and the shrink is done.
+     */
+    void retire(container_type &que) {
+    	container_type::iterator keep = que.begin();
+    	for (container_type::iterator it = que.begin(); it != que.end(); ++it) {
+    		if (*it >= m_shrink_to) {
+    			m_retired_buffers.push_back(*it);
+    		} else {
+    			*keep++ = *it;
+    		}
+    	}
+    	que.erase(keep, que.end());
+
+    	if (m_retired_buffers.size() == m_capacity - m_shrink_to) {
+    		m_pool.shrink(m_shrink_to);
+    		m_capacity = m_shrink_to;
+    		m_retired_buffers.clear();
+    		m_shrink_to = 0;
+    	}
+    }
+
 
     container_type m_empty_buffers;
     container_type m_full_buffers;
+    container_type m_retired_buffers;
+    size_type m_max_capacity;
+    size_type m_base_capacity;
+    size_type m_high_water;
+    bool m_elastic;
+    uint64_t m_pressure_start;
+    uint64_t m_quiet_start;
+    size_type m_shrink_to;
     boost::mutex m_empty_buffer_mutex;
     boost::mutex m_full_buffer_mutex;
     boost::condition_variable m_no_empty_buffers;
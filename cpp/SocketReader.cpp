@@ -35,26 +35,58 @@
 #include <linux/sockios.h>
 #include <fcntl.h>
 #include <poll.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+#include "socketUtils/packetring.h"
+#include "socketUtils/sequenceshare.h"
+#include <netinet/udp.h>
+#include "socketUtils/uringrecv.h"
 
 
 PREPARE_LOGGING(SocketReader)
 
+// How long a blocking read waits before giving the loop a chance to notice a shut down.
+#define READ_TIMEOUT_MS 100
+
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+// Buffers given to each UDP GRO message, the most segments the kernel coalesces. At the SDDS packet size this is also
+// more than the largest datagram, anything which did not fit would be truncated.
+#define GRO_MAX_SEGMENTS 64
+
+static uint64_t monotonicNanos() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
 /**
  * Creates the socket reader with default options set. You must set the connection info prior to starting the run
  * method.
  */
-SocketReader::SocketReader(): m_shuttingDown(false), m_running(false), m_timeout(1), m_pkts_per_read(1), m_socket_buffer_size(-1) {
+SocketReader::SocketReader(): m_shuttingDown(false), m_running(false), m_timeout(1), m_pkts_per_read(1), m_socket_buffer_size(-1),
+		m_receive_backend(RECEIVE_BACKEND_RECVMMSG), m_active_backend(RECEIVE_BACKEND_RECVMMSG), m_port(0), m_share_index(0), m_share_count(1), m_wait_policy(WAIT_POLICY_ADAPTIVE), m_spin_time_us(50),
+		m_busy_poll_time_us(0), m_busy_poll_set(0), m_idle_avg_ns(0), m_spin_ns(0), m_busy_poll_ns(0), m_blocked_ns(0),
+		m_udp_gro(false), m_gro_datagrams(0), m_gro_packets(0), m_auto_tune(false), m_min_pkts_per_read(1), m_max_pkts_per_read(1),
+		m_tune_start_ns(0), m_tune_reads(0), m_tune_pkts(0), m_overflow_policy(OVERFLOW_POLICY_BLOCK), m_reclaim_size(1),
+		m_dropped_newest(0), m_reclaimed_oldest(0), m_dropping(false), m_block_pos(0), m_batch(0), m_msg_start(0), m_split_data(false), m_confirm_hosts(false),
+		m_shared_socket(-1), m_shared_pktbuffer(NULL) {
 	memset(&m_multicast_connection, 0, sizeof(m_multicast_connection));
 	memset(&m_unicast_connection, 0, sizeof(m_unicast_connection));
 	m_host_addr.s_addr = 0;
+	m_dst_addr.s_addr = 0;
 }
 
 
 /**
- * Calls the shutdown method and exits.
+ * Calls the shutdown method and closes the socket if it was never handed to the run method.
  */
 SocketReader::~SocketReader() {
 	shutDown();
+	closeSockets();
 }
 
 /**
@@ -80,12 +112,42 @@ void SocketReader::setPktsPerRead(size_t pkts_per_read) {
 }
 
 /**
- * Returns the maximum number of UDP packets read per socket read.
+ * Returns the maximum number of UDP packets read per socket read. While auto tuning this is the
+ * read batch size currently in use.
  */
 size_t SocketReader::getPktsPerRead() {
 	return m_pkts_per_read;
 }
 
+/**
+ * Lets the read loop adjust the packets per read while running, within the bounds given to
+ * setPktsPerReadBounds. This cannot be changed once the thread is up and running.
+ */
+void SocketReader::setAutoTune(bool auto_tune) {
+	if (m_running) {
+		LOG_WARN(SocketReader, "Cannot change auto tuning while the socket reader thread is running");
+		return;
+	}
+	m_auto_tune = auto_tune;
+}
+
+bool SocketReader::getAutoTune() {
+	return m_auto_tune;
+}
+
+/**
+ * Sets the smallest and largest packets per read auto tuning may choose. This cannot be changed
+ * once the thread is up and running.
+ */
+void SocketReader::setPktsPerReadBounds(size_t min_pkts_per_read, size_t max_pkts_per_read) {
+	if (m_running) {
+		LOG_WARN(SocketReader, "Cannot change the packets per read bounds while the socket reader thread is running");
+		return;
+	}
+	m_min_pkts_per_read = std::max(min_pkts_per_read, (size_t) 1);
+	m_max_pkts_per_read = std::max(max_pkts_per_read, m_min_pkts_per_read);
+}
+
 /**
  * Sets up and opens the socket based on the provided interfance, IP, vlan, and port. If there are issues
  * setting up the socket a BadParameterError is thrown and the problem logged.
@@ -123,13 +185,18 @@ void SocketReader::setConnectionInfo(std::string interface, std::string ip, uint
 		if (interface.empty()) {
 			interface = getMcastIfaceFromRoutes(ip);
 		}
-		m_multicast_connection = multicast_client(interface.c_str(), ip.c_str(), port, interface);
+		m_multicast_connection = multicast_client(interface.c_str(), ip.c_str(), port, interface, m_share_count > 1);
 	} else {
-		m_unicast_connection = unicast_client(interface.c_str(), ip.c_str(), port, interface);
+		m_unicast_connection = unicast_client(interface.c_str(), ip.c_str(), port, interface, m_share_count > 1);
 	}
 
 	int socket = (m_multicast_connection.sock != 0) ? (m_multicast_connection.sock) : (m_unicast_connection.sock);
 
+	// Kept for the packet ring backend which needs to bind to the vlan interface itself and filter on the address
+	m_ring_interface = interface;
+	m_dst_addr.s_addr = inet_addr(ip.c_str());
+	m_port = port;
+
 	if (socket < 0) {
 		memset(&m_multicast_connection, 0, sizeof(m_multicast_connection));
 		memset(&m_unicast_connection, 0, sizeof(m_unicast_connection));
@@ -139,10 +206,44 @@ void SocketReader::setConnectionInfo(std::string interface, std::string ip, uint
 		LOG_ERROR(SocketReader, ss.str());
 		throw BadParameterError(ss.str());
 	}
+
+	// Every reader of a multicast group receives a copy of each packet so each drops what is not its share. Unicast
+	// packets go to a single socket of the reuseport group, the program attached by the first reader picks which.
+	if (m_share_count > 1) {
+		int ret = 0;
+		if (m_multicast_connection.sock != 0) {
+			ret = attach_sequence_share_filter(socket, m_share_index, m_share_count);
+		} else if (m_share_index == 0) {
+			ret = attach_reuseport_share_program(socket, m_share_count);
+		}
+
+		if (ret != 0) {
+			closeSockets();
+			std::stringstream ss;
+			ss << "Could not attach the filter sharing packets between " << m_share_count << " socket readers, errno: " << errno;
+			LOG_ERROR(SocketReader, ss.str());
+			throw BadParameterError(ss.str());
+		}
+	}
+
 	LOG_INFO(SocketReader, "Set connection interface: " << interface << " IP: " << ip << " Port: " << port << " VLAN: " << vlan);
 	m_interface = interface;
 }
 
+/**
+ * Makes this the reader at position index of count socket readers receiving on the same address, each taking the
+ * packets sequence_share assigns to it. Must be called before setConnectionInfo, which must then be called on the
+ * readers in index order. The packets are put back in order by a MergePacketBuffer.
+ */
+void SocketReader::setReaderShare(size_t index, size_t count) {
+	if (m_running) {
+		LOG_WARN(SocketReader, "Cannot change the reader share while the socket reader thread is running");
+		return;
+	}
+	m_share_index = index;
+	m_share_count = count;
+}
+
 /**
  * Sets the target socket buffer size. Cannot be set while the socket reader is running.
  * See the documentation for additional information.
@@ -165,6 +266,217 @@ size_t SocketReader::getSocketBufferSize() {
 	return m_socket_buffer_size;
 }
 
+/**
+ * Selects how packets are read, either "recvmmsg" (the default) to read from the UDP socket, "packet_mmap"
+ * to read from a memory mapped AF_PACKET receive ring or "io_uring" to read from the UDP socket with an io_uring
+ * multishot receive. Throws a BadParameterError if the backend is not known.
+ * Cannot be changed while the socket reader is running.
+ */
+void SocketReader::setReceiveBackend(std::string backend) throw (BadParameterError) {
+	if (m_running) {
+		LOG_WARN(SocketReader, "Cannot change the receive backend while the socket reader thread is running");
+		return;
+	}
+
+	if (backend == "recvmmsg") {
+		m_receive_backend = RECEIVE_BACKEND_RECVMMSG;
+	} else if (backend == "packet_mmap") {
+		m_receive_backend = RECEIVE_BACKEND_PACKET_MMAP;
+	} else if (backend == "io_uring") {
+		m_receive_backend = RECEIVE_BACKEND_IO_URING;
+	} else {
+		throw BadParameterError("Unknown receive backend: " + backend);
+	}
+}
+
+static std::string receiveBackendName(ReceiveBackend backend) {
+	switch (backend) {
+	case RECEIVE_BACKEND_PACKET_MMAP:
+		return "packet_mmap";
+	case RECEIVE_BACKEND_IO_URING:
+		return "io_uring";
+	default:
+		return "recvmmsg";
+	}
+}
+
+/**
+ * Returns the currently selected receive backend.
+ */
+std::string SocketReader::getReceiveBackend() {
+	return receiveBackendName(m_receive_backend);
+}
+
+/**
+ * Returns the receive backend the running socket reader actually reads with, which is recvmmsg if the selected
+ * backend could not be set up and the reader fell back, or if the socket is read by the shared reader engine.
+ */
+std::string SocketReader::getActiveReceiveBackend() {
+	return receiveBackendName(m_active_backend);
+}
+
+/**
+ * Selects how the recvmmsg reader waits when the socket is empty, either "poll" to sleep in poll straight away or
+ * "adaptive" to spin, then busy poll, then block, skipping the stages the recent packet rate says are not worth it.
+ * Throws a BadParameterError if the policy is not known. Cannot be changed while the socket reader is running.
+ */
+void SocketReader::setWaitPolicy(std::string policy) throw (BadParameterError) {
+	if (m_running) {
+		LOG_WARN(SocketReader, "Cannot change the wait policy while the socket reader thread is running");
+		return;
+	}
+
+	if (policy == "poll") {
+		m_wait_policy = WAIT_POLICY_POLL;
+	} else if (policy == "adaptive") {
+		m_wait_policy = WAIT_POLICY_ADAPTIVE;
+	} else {
+		throw BadParameterError("Unknown wait policy: " + policy);
+	}
+}
+
+/**
+ * Returns the currently selected wait policy.
+ */
+std::string SocketReader::getWaitPolicy() {
+	return (m_wait_policy == WAIT_POLICY_POLL) ? "poll" : "adaptive";
+}
+
+/**
+ * Selects what the reader does when the pktbuffer has too few empty buffers to replace the ones just read into, either
+ * "block" to wait for them, "drop_newest" to drop the packets just read or "reclaim_oldest" to take back the oldest
+ * packets still waiting to be processed. Only block stops reading the socket. Throws a BadParameterError if the policy
+ * is not known. Cannot be changed while the socket reader is running.
+ */
+void SocketReader::setOverflowPolicy(std::string policy) throw (BadParameterError) {
+	if (m_running) {
+		LOG_WARN(SocketReader, "Cannot change the overflow policy while the socket reader thread is running");
+		return;
+	}
+
+	if (policy == "block") {
+		m_overflow_policy = OVERFLOW_POLICY_BLOCK;
+	} else if (policy == "drop_newest") {
+		m_overflow_policy = OVERFLOW_POLICY_DROP_NEWEST;
+	} else if (policy == "reclaim_oldest") {
+		m_overflow_policy = OVERFLOW_POLICY_RECLAIM_OLDEST;
+	} else {
+		throw BadParameterError("Unknown overflow policy: " + policy);
+	}
+}
+
+/**
+ * Returns the currently selected overflow policy.
+ */
+std::string SocketReader::getOverflowPolicy() {
+	switch (m_overflow_policy) {
+	case OVERFLOW_POLICY_DROP_NEWEST:
+		return "drop_newest";
+	case OVERFLOW_POLICY_RECLAIM_OLDEST:
+		return "reclaim_oldest";
+	default:
+		return "block";
+	}
+}
+
+/**
+ * Sets how many packets the reclaim oldest policy takes back at a time, and how many empty buffers beyond a read either
+ * policy waits for before it stops dropping. Set to the SDDS to BulkIO processor's push size so whole pushes are dropped
+ * and the packets between drops make at least a whole push.
+ */
+void SocketReader::setReclaimSize(size_t reclaim_size) {
+	m_reclaim_size = std::max(reclaim_size, (size_t) 1);
+}
+
+/**
+ * The number of packets dropped as they were read since the reader was started, by the drop newest policy or by the
+ * reclaim oldest policy when there was not a whole reclaim block to take back.
+ */
+uint64_t SocketReader::getDroppedNewest() {
+	return m_dropped_newest;
+}
+
+/**
+ * The number of packets the reclaim oldest policy has taken back before they were processed since the reader was started.
+ */
+uint64_t SocketReader::getReclaimedOldest() {
+	return m_reclaimed_oldest;
+}
+
+/**
+ * Sets the longest the adaptive wait policy spins on the socket before blocking. Zero disables spinning.
+ * Cannot be changed while the socket reader is running.
+ */
+void SocketReader::setSpinTime(size_t spin_time_us) {
+	if (m_running) {
+		LOG_WARN(SocketReader, "Cannot change the spin time while the socket reader thread is running");
+		return;
+	}
+	m_spin_time_us = spin_time_us;
+}
+
+size_t SocketReader::getSpinTime() {
+	return m_spin_time_us;
+}
+
+/**
+ * Sets the SO_BUSY_POLL time the adaptive wait policy uses for the blocking read. Zero disables busy polling.
+ * Cannot be changed while the socket reader is running.
+ */
+void SocketReader::setBusyPollTime(size_t busy_poll_time_us) {
+	if (m_running) {
+		LOG_WARN(SocketReader, "Cannot change the busy poll time while the socket reader thread is running");
+		return;
+	}
+	m_busy_poll_time_us = busy_poll_time_us;
+}
+
+size_t SocketReader::getBusyPollTime() {
+	return m_busy_poll_time_us;
+}
+
+/**
+ * Return the total time the reader has spent spinning, busy polling and blocked waiting for packets since it was started.
+ */
+uint64_t SocketReader::getSpinMicros() {
+	return m_spin_ns / 1000;
+}
+
+uint64_t SocketReader::getBusyPollMicros() {
+	return m_busy_poll_ns / 1000;
+}
+
+uint64_t SocketReader::getBlockedMicros() {
+	return m_blocked_ns / 1000;
+}
+
+/**
+ * Enables UDP GRO on the socket so the kernel may deliver several packets of the stream as one datagram. Only used by
+ * the recvmmsg receive backend. This cannot be changed once the thread is up and running.
+ */
+void SocketReader::setUdpGro(bool udp_gro) {
+	if (m_running) {
+		LOG_WARN(SocketReader, "Cannot change UDP GRO while the socket reader thread is running");
+		return;
+	}
+	m_udp_gro = udp_gro;
+}
+
+bool SocketReader::getUdpGro() {
+	return m_udp_gro;
+}
+
+/**
+ * The number of datagrams and the number of SDDS packets read from them since the reader was last started with UDP GRO.
+ */
+uint64_t SocketReader::getGroDatagrams() {
+	return m_gro_datagrams;
+}
+
+uint64_t SocketReader::getGroPackets() {
+	return m_gro_packets;
+}
+
 /**
  * Returns the currently set socket interface. If the run method has been called,
  * this value should reflect the actual interface, otherwise it reflects what the user
@@ -182,33 +494,295 @@ std::string SocketReader::getInterface() {
  * Full packet buffers will be placed back into the pktbuffer's full buffer container for the SDDS to BulkIO
  * processor to consume.
  */
-void SocketReader::run(SmartPacketBuffer<SDDSpacket> *pktbuffer, const bool confirmHosts) {
+void SocketReader::run(PacketBuffer *pktbuffer, const bool confirmHosts) {
 	LOG_DEBUG(SocketReader, "Starting to run");
 	pthread_setname_np(pthread_self(), "SocketReader");
 	m_shuttingDown = false;
 	m_running = true;
+	m_spin_ns = m_busy_poll_ns = m_blocked_ns = 0;
+	m_gro_datagrams = m_gro_packets = 0;
+	m_dropped_newest = m_reclaimed_oldest = 0;
+	m_dropping = false;
+	m_block_pos = 0;
+	m_idle_avg_ns = 0;
+	m_busy_poll_set = 0;
 	struct pollfd poll_struct[1];
 	errno = 0;
 
-	int socket = (m_multicast_connection.sock != 0) ? (m_multicast_connection.sock) : (m_unicast_connection.sock);
+	int socket = prepareSocket();
 
 	poll_struct[0].events = POLLIN | POLLERR | POLLHUP;
 	poll_struct[0].fd = socket;
 
+	// The selected backend is only reported as in use once it has been set up
+	m_active_backend = RECEIVE_BACKEND_RECVMMSG;
+	if (m_receive_backend == RECEIVE_BACKEND_PACKET_MMAP) {
+		if (runPacketRing(pktbuffer, socket, confirmHosts)) {
+			m_running = false;
+			closeSockets();
+			return;
+		}
+		LOG_WARN(SocketReader, "Falling back to reading from the UDP socket with recvmmsg");
+	} else if (m_receive_backend == RECEIVE_BACKEND_IO_URING) {
+		// The multishot receive fills one provided buffer per packet and does not report the source address
+		if (confirmHosts) {
+			LOG_WARN(SocketReader, "The io_uring receive backend cannot check for a duplicate sender");
+		} else if (pktbuffer->pool().split_data()) {
+			LOG_WARN(SocketReader, "The io_uring receive backend cannot be used with zero copy receive");
+		} else if (runUring(pktbuffer, socket)) {
+			m_running = false;
+			closeSockets();
+			return;
+		}
+		LOG_WARN(SocketReader, "Falling back to reading from the UDP socket with recvmmsg");
+		m_active_backend = RECEIVE_BACKEND_RECVMMSG;
+	}
+
+	// The adaptive wait policy does its own spinning and blocks in the read itself, waking up periodically to check for
+	// a shut down. Reads which should not block pass MSG_DONTWAIT.
+	if (m_wait_policy == WAIT_POLICY_ADAPTIVE) {
+		struct timeval tv;
+		tv.tv_sec = 0;
+		tv.tv_usec = READ_TIMEOUT_MS * 1000;
+		if (not setSocketBlockingEnabled(socket, true) or setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) != 0) {
+			LOG_WARN(SocketReader, "Failed to set up the socket for blocking reads, using the poll wait policy");
+			setSocketBlockingEnabled(socket, false);
+			m_wait_policy = WAIT_POLICY_POLL;
+		}
+	}
+
+	// With several readers the kernel shares the stream out by the first packet of each datagram, which must not hold more
+	if (m_udp_gro and m_share_count > 1) {
+		LOG_WARN(SocketReader, "UDP GRO cannot be used with more than one socket reader");
+	} else if (m_udp_gro) {
+		if (runGro(pktbuffer, socket, poll_struct, confirmHosts)) {
+			m_running = false;
+			closeSockets();
+			return;
+		}
+		LOG_WARN(SocketReader, "Falling back to reading a single packet per datagram");
+	}
+
+    int pktsReadThisPass = 0;
+
+	if (not setupReadLoop(pktbuffer, confirmHosts)) {
+		m_shuttingDown = true; // The packet buffer is shutting down
+	}
+
+	LOG_DEBUG(SocketReader, "Entering socket read while loop");
+    while (not m_shuttingDown) {
+
+		// Get packets, waiting for them as the wait policy says if there are none
+		pktsReadThisPass = receivePackets(socket, &m_msgs[m_msg_start], m_batch, poll_struct);
+
+		switch(errno) {
+		case 0: // This is the happy path, things went really well.
+			finishRead(pktbuffer, pktsReadThisPass, m_auto_tune);
+			break;
+
+		// Same value as EAGAIN
+		case EWOULDBLOCK: // No data arrived while waiting, go round again to check for a shut down.
+			errno = 0;
+			pktbuffer->check_capacity(0); // An idle elastic buffer can still shrink
+			break;
+		case EINTR:
+		// Someone is trying to kill us.
+			LOG_ERROR(SocketReader, "Socket read was killed by an interrupt. Will stop reading.");
+			m_shuttingDown = true;
+			m_running = false;
+			break;
+		default:
+			LOG_ERROR(SocketReader, "Received unexpected errno from socket read: " << errno);
+			m_shuttingDown = true;
+			m_running = false;
+			break;
+		}
+    }
+
+    // Shutting down
+	// Don't drop the buffers! Put them back where you found them.
+	// The lock free buffer allows this as a special case, see LockFreePacketBuffer::recycle_buffers.
+	pktbuffer->recycle_buffers(m_bufQue);
+	m_running = false;
+	closeSockets();
+}
+
+/**
+ * Prepares the socket and the recvmmsg read loop for the shared reader engine, which then calls readShared whenever
+ * the socket has packets waiting rather than this reader running its own thread. The wait policy, receive backend and
+ * UDP GRO are not used and the read batch is not auto tuned, the engine decides when to read and how much.
+ * Returns false if the pktbuffer is shutting down.
+ */
+bool SocketReader::startShared(PacketBuffer *pktbuffer, const bool confirmHosts) {
+	m_shuttingDown = false;
+	m_running = true;
+	m_spin_ns = m_busy_poll_ns = m_blocked_ns = 0;
+	m_gro_datagrams = m_gro_packets = 0;
+	m_dropped_newest = m_reclaimed_oldest = 0;
+	m_dropping = false;
+	m_block_pos = 0;
+	m_active_backend = RECEIVE_BACKEND_RECVMMSG;
+	m_shared_socket = prepareSocket();
+	m_shared_pktbuffer = pktbuffer;
+
+	bool auto_tune = m_auto_tune;
+	m_auto_tune = false;
+	bool ready = setupReadLoop(pktbuffer, confirmHosts);
+	m_auto_tune = auto_tune;
+	if (not ready) {
+		stopShared();
+	}
+	return ready;
+}
+
+/**
+ * The socket the shared reader engine should wait on, -1 if the reader is not started.
+ */
+int SocketReader::getSharedSocket() {
+	return m_running ? m_shared_socket : -1;
+}
+
+/**
+ * Reads up to budget packets from the socket without blocking, a batch at a time, taking only as many packets per
+ * read as there are empty buffers to replace them so the engine thread never waits on this stream's processor.
+ */
+SharedReadResult SocketReader::readShared(size_t budget) {
+	size_t total = 0;
+	while (total < budget and not m_shuttingDown) {
+		size_t vlen = std::min(m_batch, budget - total);
+		if (m_overflow_policy == OVERFLOW_POLICY_BLOCK) {
+			vlen = std::min(vlen, m_shared_pktbuffer->get_num_empty_buffers());
+		}
+		if (vlen == 0) {
+			return SHARED_READ_STARVED;
+		}
+
+		errno = 0;
+		int num = recvmmsg(m_shared_socket, &m_msgs[m_msg_start], vlen, MSG_DONTWAIT, NULL);
+		if (num < 0) {
+			if (errno == EWOULDBLOCK or errno == EINTR) {
+				return SHARED_READ_DRAINED;
+			}
+			LOG_ERROR(SocketReader, "Received unexpected errno from socket read: " << errno);
+			return SHARED_READ_ERROR;
+		}
+
+		if (not finishRead(m_shared_pktbuffer, num, false)) {
+			return SHARED_READ_ERROR; // The packet buffer is shutting down
+		}
+
+		total += num;
+		if ((size_t) num < vlen) {
+			return SHARED_READ_DRAINED;
+		}
+	}
+	return m_shuttingDown ? SHARED_READ_ERROR : SHARED_READ_BUDGET;
+}
+
+/**
+ * True if readShared has no empty buffers to read into. Never with an overflow policy other than block, which always
+ * has the buffers of the last read to read into again.
+ */
+bool SocketReader::sharedStarved() {
+	return m_overflow_policy == OVERFLOW_POLICY_BLOCK and m_shared_pktbuffer->get_num_empty_buffers() == 0;
+}
+
+/**
+ * Hands the buffers of the read loop back and closes the socket, called by the shared reader engine once it no
+ * longer reads from this reader.
+ */
+void SocketReader::stopShared() {
+	if (m_shared_pktbuffer) {
+		m_shared_pktbuffer->recycle_buffers(m_bufQue);
+		m_shared_pktbuffer = NULL;
+	}
+	m_shared_socket = -1;
+	m_running = false;
+	closeSockets();
+}
+
+/**
+ * Reads the socket and calls on_read after every read on this same thread, for run to completion where one thread
+ * reads, processes and pushes with no handoff in between. Uses the non-blocking recvmmsg read loop of the shared reader
+ * engine and waits for the socket once it is empty as the wait policy says, see waitReadable. The receive backend, UDP
+ * GRO and busy poll time are not used and the read batch is not auto tuned. Does not return until the shutDown method
+ * is called.
+ */
+void SocketReader::runToCompletion(PacketBuffer *pktbuffer, const bool confirmHosts, boost::function<void ()> on_read) {
+	pthread_setname_np(pthread_self(), "SddsRunToCompl");
+	if (not startShared(pktbuffer, confirmHosts)) {
+		return;
+	}
+	m_idle_avg_ns = 0;
+
+	struct pollfd poll_struct[1];
+	poll_struct[0].events = POLLIN | POLLERR | POLLHUP;
+	poll_struct[0].fd = m_shared_socket;
+
+	while (not m_shuttingDown) {
+		SharedReadResult result = readShared(m_batch);
+		if (result == SHARED_READ_ERROR) {
+			break;
+		}
+
+		// Whatever was read is processed and pushed before the next read, so the buffers are free again
+		on_read();
+
+		if (result == SHARED_READ_DRAINED) {
+			waitReadable(poll_struct);
+		}
+	}
+
+	stopShared();
+}
+
+/**
+ * Waits for the socket to be readable without reading it, as receivePackets does under the wait policy. With the poll
+ * policy it sleeps in poll straight away. With the adaptive policy it first spins polling the socket for up to the
+ * spin time, skipped while the average idle time is longer, then sleeps in poll. The kernel only busy polls the device
+ * queue from poll when the net.core.busy_poll sysctl is set, so the busy poll time is not used.
+ */
+void SocketReader::waitReadable(struct pollfd *poll_struct) {
+	const uint64_t idle_start = monotonicNanos();
+	uint64_t now = idle_start;
+	const int64_t spin_ns = (int64_t) m_spin_time_us * 1000;
+
+	if (m_wait_policy == WAIT_POLICY_ADAPTIVE and spin_ns > 0 and m_idle_avg_ns <= spin_ns) {
+		int ready;
+		do {
+			ready = poll(poll_struct, 1, 0);
+			now = monotonicNanos();
+		} while (ready == 0 and not m_shuttingDown and (int64_t) (now - idle_start) < spin_ns);
+
+		m_spin_ns += now - idle_start;
+		if (ready != 0) {
+			m_idle_avg_ns += ((int64_t) (now - idle_start) - m_idle_avg_ns) / 8;
+			return;
+		}
+	}
+
+	const uint64_t block_start = now;
+	int ready = poll(poll_struct, 1, READ_TIMEOUT_MS);
+	now = monotonicNanos();
+	m_blocked_ns += now - block_start;
+	if (ready > 0) {
+		m_idle_avg_ns += ((int64_t) (now - idle_start) - m_idle_avg_ns) / 8;
+	}
+}
+
+/**
+ * Returns the socket opened by setConnectionInfo after making it non-blocking and setting its buffer size. The size
+ * the kernel actually gave the socket replaces the requested one.
+ */
+int SocketReader::prepareSocket() {
+	int socket = (m_multicast_connection.sock != 0) ? (m_multicast_connection.sock) : (m_unicast_connection.sock);
+
 	// While a blocking socket is more simple / nicer, it forces the thread into a sleep state which can
 	// cause a thread context switch. This thread has a need for speed!
 	if (not setSocketBlockingEnabled(socket, false)) {
 		LOG_ERROR(SocketReader, "Error when setting the socket to non-blocking");
 	}
 
-    std::deque<SddsPacketPtr> bufQue;
-    int pktsReadThisPass = 0;
-    size_t i;
-
-    struct mmsghdr msgs[m_pkts_per_read];
-    struct iovec iovecs[m_pkts_per_read];
-	sockaddr_in source_addrs[m_pkts_per_read];
-
     if (m_socket_buffer_size) {
     	if (setsockopt(socket, SOL_SOCKET, SO_RCVBUF, &m_socket_buffer_size, sizeof(m_socket_buffer_size)) != 0) {
     		LOG_WARN(SocketReader, "Failed to set socket buffer size to the requested size: " << m_socket_buffer_size);
@@ -217,78 +791,690 @@ void SocketReader::run(SmartPacketBuffer<SDDSpacket> *pktbuffer, const bool conf
 
     socklen_t optlen = sizeof(m_socket_buffer_size);
     getsockopt(socket, SOL_SOCKET, SO_RCVBUF, &m_socket_buffer_size, &optlen);
+    return socket;
+}
+
+/**
+ * Sets up the messages of the recvmmsg read loop and fills them with buffers from pktbuffer.
+ * Returns false if the pktbuffer is shutting down.
+ *
+ * Every message (and its iovecs and source address) appears twice, message i and message i + m_batch
+ * always point at the same buffer. This lets recvmmsg be handed m_batch consecutive messages starting at
+ * any offset so the buffers are filled in the same order they came out of the packet buffer. See finishRead.
+ */
+bool SocketReader::setupReadLoop(PacketBuffer *pktbuffer, bool confirmHosts) {
+	// While auto tuning the read batch moves between its bounds, so everything is sized for the largest it may be.
+	// The reader and the processor must not be able to hold the whole buffer between them, hence the half.
+	m_batch = m_pkts_per_read;
+	size_t maxBatch = m_pkts_per_read;
+	if (m_auto_tune) {
+		maxBatch = std::max(std::min(m_max_pkts_per_read, pktbuffer->capacity() / 2), (size_t) 1);
+		m_batch = std::min(std::max(m_batch, std::min(m_min_pkts_per_read, maxBatch)), maxBatch);
+		m_pkts_per_read = m_batch;
+		m_tune_start_ns = monotonicNanos();
+		m_tune_reads = m_tune_pkts = 0;
+	}
 
-	memset(msgs, 0, sizeof(msgs));
+	// When the pool keeps the headers and data apart each packet is received with two iovecs.
+	m_split_data = pktbuffer->pool().split_data();
+	m_confirm_hosts = confirmHosts;
+	m_msg_start = 0;
+
+	struct mmsghdr empty_msg;
+	memset(&empty_msg, 0, sizeof(empty_msg));
+	m_msgs.assign(2 * maxBatch, empty_msg);
+	m_iovecs.resize(2 * 2 * maxBatch);
+	m_source_addrs.resize(2 * maxBatch);
 
 	// Fill our buffer with free packets
-	pktbuffer->pop_empty_buffers(bufQue, m_pkts_per_read);
+	m_bufQue.clear();
+	m_bufQue.set_capacity(m_batch);
+	pktbuffer->pop_empty_buffers(m_bufQue, m_batch);
+	if (m_bufQue.size() < m_batch) {
+		return false;
+	}
 
-	for (i = 0; i < m_pkts_per_read; i++) {
-		iovecs[i].iov_len          = SDDS_PACKET_SIZE;
-		iovecs[i].iov_base         = bufQue[i].get();
-		msgs[i].msg_hdr.msg_iov    = &iovecs[i];
-		msgs[i].msg_hdr.msg_iovlen = 1;
+	for (size_t i = 0; i < 2 * maxBatch; i++) {
+		if (i < 2 * m_batch) {
+			pointIovecs(&m_iovecs[2 * i], pktbuffer, m_bufQue[i % m_batch], m_split_data);
+		}
+		m_msgs[i].msg_hdr.msg_iov    = &m_iovecs[2 * i];
+		m_msgs[i].msg_hdr.msg_iovlen = m_split_data ? 2 : 1;
 
 		if (confirmHosts) {
-			msgs[i].msg_hdr.msg_name = &source_addrs[i];
-			msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+			m_msgs[i].msg_hdr.msg_name = &m_source_addrs[i];
+			m_msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
 		}
 	}
+	return true;
+}
 
-	LOG_DEBUG(SocketReader, "Entering socket read while loop");
-    while (not m_shuttingDown) {
-
-		// Get packets, the MSG_DONTWAIT does nothing since we already set this to non-blocking socket. Same with the timeout.
-		pktsReadThisPass = recvmmsg(socket, msgs, m_pkts_per_read, MSG_DONTWAIT, NULL);
+/**
+ * Hands the num packets just read into the messages starting at m_msg_start to the pktbuffer and moves the read
+ * loop on to the next message. If tune is set the read batch may be resized, see tuneReadBatch.
+ * Returns false if the pktbuffer is shutting down.
+ */
+bool SocketReader::finishRead(PacketBuffer *pktbuffer, size_t num, bool tune) {
+	// Push the packets we've received and refill our buffer with free packets
+	if (not pushAndRefill(pktbuffer, m_bufQue, num)) {
+		return false;
+	}
 
-		switch(errno) {
-		case 0: // This is the happy path, things went really well.
+	// Its possible that you have two different hosts sending multicast to the same address. This feature was added to
+	// aid in debugging situations where you want to know who is missconfigured.
+	if (m_confirm_hosts) {
+		confirmSingleHost(&m_msgs[m_msg_start], num);
+	}
 
-			// I don't think doing this in a single call would help any, we still need to protect two queues.
-			// Push the packets onto the queue that we've received.
-			pktbuffer->push_full_buffers(bufQue, pktsReadThisPass);
+	// Re-point the messages we just read into at the new buffers, which now sit at the end of the bufQue.
+	// Only these messages have to change and the next read starts right after them.
+	for (size_t i = 0; i < num; ++i) {
+		size_t msg = (m_msg_start + i) % m_batch;
+		PacketHandle handle = m_bufQue[m_batch - num + i];
+		pointIovecs(&m_iovecs[2 * msg], pktbuffer, handle, m_split_data);
+		pointIovecs(&m_iovecs[2 * (msg + m_batch)], pktbuffer, handle, m_split_data);
+	}
+	m_msg_start = (m_msg_start + num) % m_batch;
 
-			// Fill our buffer with free packets
-			pktbuffer->pop_empty_buffers(bufQue, m_pkts_per_read);
+	if (tune) {
+		size_t tuned = tuneReadBatch(pktbuffer, m_batch, num);
+		if (tuned != m_batch) {
+			if (not resizeReadBatch(pktbuffer, m_bufQue, tuned)) {
+				return false;
+			}
 
-			// Re-point the iovecs to the new buffers
-			// Note that we've added pktsReadThisPass to the top of the bufQue so we only have to repoint the new buffers
-			for (i = 0; i < (size_t) pktsReadThisPass; ++i) {
-				iovecs[i].iov_base = bufQue[i].get();
+			// The bufQue now starts with the buffer the next read should fill, start the messages over from it
+			m_batch = tuned;
+			for (size_t i = 0; i < 2 * m_batch; ++i) {
+				pointIovecs(&m_iovecs[2 * i], pktbuffer, m_bufQue[i % m_batch], m_split_data);
 			}
+			m_msg_start = 0;
+			m_pkts_per_read = m_batch;
+		}
+	}
+	return true;
+}
 
-			// Its possible that you have two different hosts sending multicast to the same address. This feature was added to
-			// aid in debugging situations where you want to know who is missconfigured.
-			if (confirmHosts) {
-				confirmSingleHost(msgs, (size_t) pktsReadThisPass);
+/**
+ * Reads packets out of a TPACKET_V3 memory mapped AF_PACKET receive ring instead of the UDP socket. The kernel hands
+ * over whole blocks of packets without a system call per batch and the UDP stack is skipped entirely. The UDP headers
+ * are parsed here and each SDDS packet is copied from the ring into a buffer from the pktbuffer so the block can be
+ * given straight back to the kernel.
+ *
+ * The UDP socket is left open so the multicast group stays joined (and for unicast the port stays bound) however a
+ * filter is attached to it so that it does not queue a second copy of every packet.
+ *
+ * Returns false without reading anything if the ring could not be set up, eg. the user lacks CAP_NET_RAW.
+ */
+bool SocketReader::runPacketRing(PacketBuffer *pktbuffer, int socket, const bool confirmHosts) {
+	packetring_t ring;
+	try {
+		ring = packetring_client(m_ring_interface.c_str(), m_dst_addr, m_port, m_share_index, m_share_count);
+	} catch (BadParameterError &e) {
+		LOG_WARN(SocketReader, "Could not set up the packet receive ring: " << e.what());
+		return false;
+	}
+
+	if (attach_drop_all_filter(socket) != 0) {
+		LOG_WARN(SocketReader, "Failed to attach a filter to the UDP socket, packets will be queued on it as well as the receive ring");
+	}
+	m_active_backend = RECEIVE_BACKEND_PACKET_MMAP;
+
+	PacketBuffer::container_type bufQue(m_pkts_per_read);
+	size_t filled = 0;
+	size_t len = 0;
+	struct in_addr src;
+
+	pktbuffer->pop_empty_buffers(bufQue, m_pkts_per_read);
+
+	LOG_DEBUG(SocketReader, "Entering packet ring read while loop");
+	while (not m_shuttingDown and bufQue.size() == m_pkts_per_read) {
+		struct tpacket_block_desc *block = packetring_next_block(&ring);
+		if (block == NULL) {
+			packetring_poll_in(ring, 100); // 100 ms max wait poll if no data is available.
+			continue;
+		}
+
+		uint8_t *pkt_ptr = reinterpret_cast<uint8_t*>(block) + block->hdr.bh1.offset_to_first_pkt;
+		for (uint32_t n = 0; n < block->hdr.bh1.num_pkts; ++n) {
+			struct tpacket3_hdr *pkt = reinterpret_cast<struct tpacket3_hdr*>(pkt_ptr);
+			const uint8_t *payload = packetring_udp_payload(pkt, &len, &src);
+
+			if (payload != NULL and bufQue.size() == m_pkts_per_read) {
+				copyPacket(pktbuffer, bufQue[filled], payload, len);
+
+				if (confirmHosts) {
+					confirmHost(src);
+				}
+
+				if (++filled == m_pkts_per_read) {
+					pushAndRefill(pktbuffer, bufQue, filled);
+					filled = 0;
+				}
 			}
-			break;
+			pkt_ptr += pkt->tp_next_offset;
+		}
 
-		// Same value as EAGAIN
-		case EWOULDBLOCK: // No data was available. Wait for data.
-			poll(poll_struct, 1, 100); // 100 ms max wait poll if no data is available.
-			errno = 0;
-			break;
-		case EINTR:
-		// Someone is trying to kill us.
-			LOG_ERROR(SocketReader, "Socket read was killed by an interrupt. Will stop reading.");
-			m_shuttingDown = true;
-			m_running = false;
-			break;
-		default:
+		packetring_release_block(&ring, block);
+
+		// Don't hold on to a partial batch waiting for the next block, the block timeout already sets the latency
+		if (filled) {
+			pushAndRefill(pktbuffer, bufQue, filled);
+			filled = 0;
+		}
+	}
+
+	// Don't drop the buffers! Put them back where you found them.
+	pktbuffer->recycle_buffers(bufQue);
+	packetring_close(ring);
+	return true;
+}
+
+/**
+ * Reads the UDP socket with UDP_GRO enabled so the kernel can hand over a run of packets from the same sender as a single
+ * datagram, only the first of which makes the trip through the UDP stack. Each message is given the iovecs of
+ * GRO_MAX_SEGMENTS buffers. When the segment size in the UDP_GRO control message is the SDDS packet size every segment
+ * lands in its own buffer and nothing is copied, any other segment size is copied out and split into the buffers.
+ *
+ * Returns false without reading anything if UDP_GRO could not be enabled on the socket.
+ */
+bool SocketReader::runGro(PacketBuffer *pktbuffer, int socket, struct pollfd *poll_struct, const bool confirmHosts) {
+	int one = 1;
+	if (setsockopt(socket, SOL_UDP, UDP_GRO, &one, sizeof(one)) != 0) {
+		LOG_WARN(SocketReader, "Failed to enable UDP GRO on the socket: " << strerror(errno));
+		return false;
+	}
+
+	const bool splitData = pktbuffer->pool().split_data();
+	const size_t iovsPerPkt = splitData ? 2 : 1;
+	const size_t segs = GRO_MAX_SEGMENTS;
+	const size_t numMsgs = (m_pkts_per_read + segs - 1) / segs;
+	const size_t numBufs = numMsgs * segs;
+	const size_t controlLen = CMSG_SPACE(sizeof(int));
+
+	PacketBuffer::container_type bufQue(numBufs);
+	PacketBuffer::container_type ordered(numBufs);
+	std::vector<struct mmsghdr> msgs(numMsgs);
+	std::vector<struct iovec> iovecs(iovsPerPkt * numBufs);
+	std::vector<sockaddr_in> source_addrs(numMsgs);
+	std::vector<uint64_t> controls((numMsgs * controlLen + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+	std::vector<size_t> msgPkts(numMsgs);
+	std::vector<uint8_t> bounce(65536);
+	size_t i, j;
+
+	memset(&msgs[0], 0, numMsgs * sizeof(struct mmsghdr));
+	for (j = 0; j < numMsgs; ++j) {
+		msgs[j].msg_hdr.msg_iov = &iovecs[j * segs * iovsPerPkt];
+		msgs[j].msg_hdr.msg_iovlen = segs * iovsPerPkt;
+		if (confirmHosts) {
+			msgs[j].msg_hdr.msg_name = &source_addrs[j];
+			msgs[j].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+		}
+	}
+
+	pktbuffer->pop_empty_buffers(bufQue, numBufs);
+
+	LOG_DEBUG(SocketReader, "Entering UDP GRO read while loop");
+	while (not m_shuttingDown and bufQue.size() == numBufs) {
+		for (i = 0; i < numBufs; ++i) {
+			pointIovecs(&iovecs[i * iovsPerPkt], pktbuffer, bufQue[i], splitData);
+		}
+		for (j = 0; j < numMsgs; ++j) {
+			msgs[j].msg_hdr.msg_control = reinterpret_cast<uint8_t*>(&controls[0]) + j * controlLen;
+			msgs[j].msg_hdr.msg_controllen = controlLen;
+		}
+
+		int num = receivePackets(socket, &msgs[0], numMsgs, poll_struct);
+		if (num <= 0) {
+			if (errno == EWOULDBLOCK) {
+				errno = 0;
+				continue;
+			}
 			LOG_ERROR(SocketReader, "Received unexpected errno from socket read: " << errno);
 			m_shuttingDown = true;
 			m_running = false;
 			break;
 		}
-    }
 
-    // Shutting down
+		for (j = 0; j < (size_t) num; ++j) {
+			size_t len = msgs[j].msg_len;
+			size_t segSize = len;
+			for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msgs[j].msg_hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&msgs[j].msg_hdr, cmsg)) {
+				if (cmsg->cmsg_level == SOL_UDP and cmsg->cmsg_type == UDP_GRO) {
+					int gso_size;
+					memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+					segSize = gso_size;
+				}
+			}
+
+			size_t pkts = (len == 0 or segSize == 0) ? 0 : std::min((len + segSize - 1) / segSize, segs);
+			PacketHandle *handles = &bufQue[j * segs];
+
+			if (segSize != SDDS_PACKET_SIZE and pkts > 1) {
+				// The segments straddle the buffers, gather the datagram back up and split it properly
+				struct iovec *iov = msgs[j].msg_hdr.msg_iov;
+				size_t off = 0;
+				for (i = 0; off < len; ++i) {
+					size_t n = std::min(iov[i].iov_len, len - off);
+					memcpy(&bounce[off], iov[i].iov_base, n);
+					off += n;
+				}
+				for (i = 0; i < pkts; ++i) {
+					copyPacket(pktbuffer, handles[i], &bounce[i * segSize], std::min(segSize, len - i * segSize));
+				}
+			}
+
+			if (confirmHosts) {
+				confirmHost(source_addrs[j].sin_addr);
+			}
+
+			msgPkts[j] = pkts;
+			m_gro_datagrams++;
+			m_gro_packets += pkts;
+		}
+
+		// Move the filled buffers to the front, keeping their order, and hand them over
+		ordered.clear();
+		for (j = 0; j < (size_t) num; ++j) {
+			for (i = 0; i < msgPkts[j]; ++i) {
+				ordered.push_back(bufQue[j * segs + i]);
+			}
+		}
+		size_t filled = ordered.size();
+		for (j = 0; j < numMsgs; ++j) {
+			for (i = (j < (size_t) num) ? msgPkts[j] : 0; i < segs; ++i) {
+				ordered.push_back(bufQue[j * segs + i]);
+			}
+		}
+		bufQue.swap(ordered);
+
+		if (not pushAndRefill(pktbuffer, bufQue, filled)) {
+			break; // The packet buffer is shutting down
+		}
+	}
+
 	// Don't drop the buffers! Put them back where you found them.
-	// XXX If we ever switch to a single producer single consumer no-lock no-wait data structure this may mess things up.
 	pktbuffer->recycle_buffers(bufQue);
-	m_running = false;
+	return true;
+}
+
+/**
+ * Reads up to vlen messages into msgs, waiting for the first one according to the wait policy. Returns the
+ * result of recvmmsg with errno as it left it, if nothing arrived in time -1 is returned with errno set to EWOULDBLOCK.
+ *
+ * With the poll policy a non-blocking read is made and poll used to wait if it came back empty. With the adaptive policy
+ * the reader first spins on non-blocking reads then makes a blocking read, which busy polls the device queue for the
+ * SO_BUSY_POLL time before sleeping. Spinning and busy polling are only worth it if packets arrive before they run out so
+ * each is skipped while the average idle time is longer; at low rates the thread goes straight to sleep and at high
+ * rates it never pays for a wake up. The time spent in each state is added to the status counters.
+ */
+int SocketReader::receivePackets(int socket, struct mmsghdr *msgs, size_t vlen, struct pollfd *poll_struct) {
+	errno = 0;
+	int num = recvmmsg(socket, msgs, vlen, MSG_DONTWAIT, NULL);
+	if (num > 0 or errno != EWOULDBLOCK) {
+		return num;
+	}
+
+	const uint64_t idle_start = monotonicNanos();
+	uint64_t now = idle_start;
+
+	if (m_wait_policy == WAIT_POLICY_POLL) {
+		poll(poll_struct, 1, READ_TIMEOUT_MS);
+		m_blocked_ns += monotonicNanos() - idle_start;
+		errno = EWOULDBLOCK;
+		return -1;
+	}
+
+	const int64_t spin_ns = (int64_t) m_spin_time_us * 1000;
+	const int64_t busy_poll_ns = (int64_t) m_busy_poll_time_us * 1000;
+
+	if (spin_ns > 0 and m_idle_avg_ns <= spin_ns) {
+		do {
+			errno = 0;
+			num = recvmmsg(socket, msgs, vlen, MSG_DONTWAIT, NULL);
+			now = monotonicNanos();
+		} while (num <= 0 and errno == EWOULDBLOCK and (int64_t) (now - idle_start) < spin_ns);
+
+		m_spin_ns += now - idle_start;
+		if (num > 0 or errno != EWOULDBLOCK) {
+			m_idle_avg_ns += ((int64_t) (now - idle_start) - m_idle_avg_ns) / 8;
+			return num;
+		}
+	}
 
+	setBusyPoll(socket, (busy_poll_ns > 0 and m_idle_avg_ns <= spin_ns + busy_poll_ns) ? m_busy_poll_time_us : 0);
+
+	const uint64_t block_start = now;
+	errno = 0;
+	num = recvmmsg(socket, msgs, vlen, MSG_WAITFORONE, NULL);
+	now = monotonicNanos();
+
+	// The kernel busy polls first and then sleeps, the split between the two is an estimate
+	uint64_t waited = now - block_start;
+	uint64_t polled = (m_busy_poll_set > 0) ? std::min(waited, (uint64_t) m_busy_poll_set * 1000) : 0;
+	m_busy_poll_ns += polled;
+	m_blocked_ns += waited - polled;
+
+	// A signal is not a reason to stop reading, treat it like the timeout
+	if (num < 0 and errno == EINTR) {
+		errno = EWOULDBLOCK;
+	}
+
+	if (num > 0 or errno == EWOULDBLOCK) {
+		m_idle_avg_ns += ((int64_t) (now - idle_start) - m_idle_avg_ns) / 8;
+	}
+	return num;
+}
+
+/**
+ * Sets SO_BUSY_POLL (and SO_PREFER_BUSY_POLL where available) on the socket if it is not already set to busy_poll_us.
+ * Raising it above the net.core.busy_read sysctl needs CAP_NET_ADMIN, if it fails busy polling is not tried again.
+ */
+void SocketReader::setBusyPoll(int socket, int busy_poll_us) {
+	if (busy_poll_us == m_busy_poll_set or m_busy_poll_set < 0) {
+		return;
+	}
+
+	if (setsockopt(socket, SOL_SOCKET, SO_BUSY_POLL, &busy_poll_us, sizeof(busy_poll_us)) != 0) {
+		LOG_WARN(SocketReader, "Failed to set SO_BUSY_POLL on the socket, busy polling is disabled: " << strerror(errno));
+		m_busy_poll_set = -1;
+		return;
+	}
+
+#ifdef SO_PREFER_BUSY_POLL
+	int prefer = (busy_poll_us > 0) ? 1 : 0;
+	setsockopt(socket, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer, sizeof(prefer));
+#endif
+
+	m_busy_poll_set = busy_poll_us;
+}
+
+/**
+ * Receives with an io_uring multishot receive rather than recvmmsg. The buffers handed to the kernel through a provided
+ * buffer ring are slots of the packet pool, so the kernel writes each datagram straight into the pool as it arrives and
+ * the completions are reaped from shared memory in batches without a system call. The thread only enters the kernel to
+ * re-arm the receive or when there is nothing to reap and it has to wait.
+ *
+ * The kernel uses the provided buffers in the order they are added to the ring, so the buffers completed are always the
+ * first ones in the bufQue and the buffer ids do not need to be mapped back to handles. Each completion's buffer id is
+ * still checked against the one expected, if the kernel ever uses a buffer out of order the packets from there on
+ * cannot be matched to their handles and the reader falls back to recvmmsg rather than push the wrong buffers.
+ *
+ * Returns false if io_uring is unavailable, either at setup or because the kernel rejected the multishot receive before
+ * any packet was read, or if a buffer was used out of order, after returning all the buffers to the pktbuffer.
+ */
+bool SocketReader::runUring(PacketBuffer *pktbuffer, int socket) {
+	// Keep enough buffers with the kernel for it to carry on filling them while a batch is pushed, but no more than
+	// half the pool so the SDDS to BulkIO processor is not starved.
+	size_t entries = 1;
+	while (entries < 2 * m_pkts_per_read && entries < URINGRECV_MAX_BUFFERS) {
+		entries <<= 1;
+	}
+	while (entries > 1 && entries > pktbuffer->capacity() / 2) {
+		entries >>= 1;
+	}
+
+	uringrecv_t ring;
+	try {
+		ring = uringrecv_client(socket, entries);
+	} catch (BadParameterError &e) {
+		LOG_WARN(SocketReader, "Could not set up the io_uring receive: " << e.what());
+		return false;
+	}
+
+	PacketBuffer::container_type bufQue(entries);
+	std::vector<uringrecv_completion_t> completions(entries + 1);
+	bool armed = false;
+	bool unsupported = false;
+	bool out_of_order = false;
+	uint16_t next_bid = 0;
+	size_t pktsRead = 0;
+	size_t i;
+
+	pktbuffer->pop_empty_buffers(bufQue, entries);
+	for (i = 0; i < bufQue.size(); ++i) {
+		uringrecv_provide(&ring, pktbuffer->header(bufQue[i]), SDDS_PACKET_SIZE);
+	}
+	uringrecv_commit(&ring);
+
+	LOG_DEBUG(SocketReader, "Entering io_uring read while loop");
+	while (not m_shuttingDown and not unsupported and not out_of_order) {
+		if (not armed) {
+			int ret = uringrecv_arm(&ring);
+			if (ret != 0) {
+				LOG_ERROR(SocketReader, "Failed to submit the io_uring receive: " << -ret);
+				m_shuttingDown = true;
+				m_running = false;
+				break;
+			}
+			armed = true;
+		}
+
+		size_t num = uringrecv_reap(&ring, &completions[0], completions.size());
+		if (num == 0) {
+			uringrecv_wait(&ring, 100); // 100 ms max wait if no data is available.
+			continue;
+		}
+
+		size_t filled = 0;
+		for (i = 0; i < num; ++i) {
+			const uringrecv_completion_t &c = completions[i];
+			if ((c.flags & URINGRECV_F_BUFFER) && not out_of_order) {
+				if (c.bid == next_bid) {
+					next_bid = (next_bid + 1) & (entries - 1);
+					++filled;
+				} else {
+					LOG_ERROR(SocketReader, "The io_uring receive used buffer " << c.bid << " when buffer " << next_bid << " was next");
+					out_of_order = true;
+				}
+			}
+			if (not (c.flags & URINGRECV_F_MORE)) {
+				armed = false;
+			}
+
+			// Running out of buffers just ends the receive, what has not been read waits in the socket until it is re-armed
+			if (c.res < 0 && c.res != -ENOBUFS) {
+				if (c.res == -EINVAL && pktsRead == 0) {
+					LOG_WARN(SocketReader, "The kernel does not support the io_uring multishot receive");
+					unsupported = true;
+				} else {
+					LOG_ERROR(SocketReader, "Received unexpected error from the io_uring receive: " << -c.res);
+					m_shuttingDown = true;
+					m_running = false;
+				}
+			}
+		}
+
+		if (filled) {
+			// Past the first packet the kernel can no longer reject the multishot receive
+			if (pktsRead == 0) {
+				m_active_backend = RECEIVE_BACKEND_IO_URING;
+			}
+			pktsRead += filled;
+			if (not pushAndRefill(pktbuffer, bufQue, filled)) {
+				break; // The packet buffer is shutting down
+			}
+
+			// The new buffers are at the end of the bufQue, the same order they are added to the ring
+			for (i = bufQue.size() - filled; i < bufQue.size(); ++i) {
+				uringrecv_provide(&ring, pktbuffer->header(bufQue[i]), SDDS_PACKET_SIZE);
+			}
+			uringrecv_commit(&ring);
+		}
+	}
+
+	// The kernel must be done with our buffers before they go back to the pktbuffer
+	if (armed and uringrecv_cancel(&ring) == 0) {
+		for (int tries = 0; armed and tries < 10; ++tries) {
+			size_t num = uringrecv_reap(&ring, &completions[0], completions.size());
+			for (i = 0; i < num; ++i) {
+				if (not (completions[i].flags & URINGRECV_F_MORE)) {
+					armed = false;
+				}
+			}
+			if (armed and num == 0) {
+				uringrecv_wait(&ring, 100);
+			}
+		}
+	}
+
+	uringrecv_close(ring);
+
+	// Don't drop the buffers! Put them back where you found them.
+	pktbuffer->recycle_buffers(bufQue);
+	return not unsupported and not out_of_order;
+}
+
+/**
+ * Pushes the first num buffers of the bufQue to the pktbuffer and refills it with empty buffers, up to its capacity.
+ * The new buffers are added to the front of the bufQue by the pktbuffer, they are moved to the back so that the
+ * bufQue stays in the order the buffers came out of the packet buffer. The buffers are handed out in order so when
+ * the pool keeps the data contiguous, consecutive packets off the socket end up in consecutive memory.
+ *
+ * With an overflow policy other than block this never waits. The packets read are counted off in blocks of the reclaim
+ * size, and as each block starts it is either kept or dropped whole, depending on whether there are empty buffers for
+ * all of it once the reclaim oldest policy has taken back what it can. The blocks are counted from the first packet
+ * read, as the processor counts its pushes, so the drops start and end on push boundaries. Dropped packets have their
+ * buffers moved to the back of the bufQue to be read into again, so the socket is still drained.
+ * Returns false if the bufQue could not be refilled because the pktbuffer is shutting down.
+ */
+bool SocketReader::pushAndRefill(PacketBuffer *pktbuffer, PacketBuffer::container_type &bufQue, size_t num) {
+	const size_t len = bufQue.capacity();
+	size_t kept = num;
+	if (m_overflow_policy != OVERFLOW_POLICY_BLOCK) {
+		// The kept packets are moved up to the front of the bufQue, ahead of the dropped ones
+		kept = 0;
+		for (size_t done = 0; done < num;) {
+			if (m_block_pos >= m_reclaim_size) {
+				m_block_pos = 0;
+			}
+			if (m_block_pos == 0) {
+				haveEmptyBuffers(pktbuffer, kept + m_reclaim_size);
+			}
+
+			size_t seg = std::min(num - done, m_reclaim_size - m_block_pos);
+			if (m_dropping) {
+				m_dropped_newest += seg;
+			} else {
+				for (size_t i = 0; i < seg; ++i) {
+					std::swap(bufQue[kept + i], bufQue[done + i]);
+				}
+				kept += seg;
+			}
+			done += seg;
+			m_block_pos += seg;
+		}
+	}
+
+	if (kept) {
+		pktbuffer->push_full_buffers(bufQue, kept);
+		pktbuffer->pop_empty_buffers(bufQue, len);
+
+		if (bufQue.size() < len) {
+			return false;
+		}
+	}
+
+	if (num < len) {
+		bufQue.rotate(bufQue.begin() + num);
+	}
+	return true;
+}
+
+/**
+ * True if the pktbuffer has num empty buffers, which only the socket reader takes so they can then be popped without
+ * waiting. An elastic pktbuffer is given the chance to grow first. Under the reclaim oldest policy any shortfall is
+ * made up by taking back the oldest full buffers, in whole reclaim blocks so the processor loses whole pushes. Once a
+ * block has been dropped the reader carries on dropping until there is a further reclaim block of empty buffers, so
+ * a single block is not let through between drops.
+ */
+bool SocketReader::haveEmptyBuffers(PacketBuffer *pktbuffer, size_t num) {
+	size_t need = m_dropping ? num + m_reclaim_size : num;
+	size_t empty = pktbuffer->get_num_empty_buffers();
+
+	if (empty < need) {
+		pktbuffer->check_capacity(need);
+		empty = pktbuffer->get_num_empty_buffers();
+	}
+
+	if (empty < need and m_overflow_policy == OVERFLOW_POLICY_RECLAIM_OLDEST) {
+		size_t blocks = (need - empty + m_reclaim_size - 1) / m_reclaim_size;
+		m_reclaimed_oldest += pktbuffer->reclaim_full_buffers(blocks * m_reclaim_size);
+		empty = pktbuffer->get_num_empty_buffers();
+	}
+
+	m_dropping = empty < need;
+	return not m_dropping;
+}
+
+/**
+ * Called after every read while auto tuning. Once every AUTO_TUNE_INTERVAL_MS this looks at how full the reads came back
+ * and how full the packet buffer is, and returns the read batch size to use from now on.
+ *
+ * Reads which keep coming back full mean the socket has more waiting than a read takes, so the batch doubles. Reads
+ * which come back mostly empty only leave the extra buffers sitting idle in the reader, so it halves. When the packet
+ * buffer is nearly full the processor is behind and empty buffers are scarce, so it also halves, letting the reader
+ * carry on with fewer free buffers rather than wait for a whole batch of them.
+ */
+size_t SocketReader::tuneReadBatch(PacketBuffer *pktbuffer, size_t batch, size_t pkts) {
+	m_tune_reads++;
+	m_tune_pkts += pkts;
+
+	uint64_t now = monotonicNanos();
+	if (now - m_tune_start_ns < AUTO_TUNE_INTERVAL_MS * 1000000ULL) {
+		return batch;
+	}
+
+	double fill = (double) m_tune_pkts / (m_tune_reads * batch);
+	double occupancy = (double) pktbuffer->get_num_full_buffers() / pktbuffer->capacity();
+	size_t max_batch = std::max(std::min(m_max_pkts_per_read, pktbuffer->capacity() / 2), (size_t) 1);
+	size_t min_batch = std::min(m_min_pkts_per_read, max_batch);
+
+	m_tune_start_ns = now;
+	m_tune_reads = m_tune_pkts = 0;
+
+	if (occupancy >= 0.75 or fill < 0.25) {
+		return std::max(batch / 2, min_batch);
+	} else if (fill >= 0.9 and occupancy < 0.5) {
+		return std::min(batch * 2, max_batch);
+	}
+	return batch;
+}
+
+/**
+ * Changes the number of buffers held in the bufQue to batch, handing back the buffers at the end of it or taking more
+ * from the pktbuffer. The buffers left keep their order. Returns false if the pktbuffer is shutting down.
+ */
+bool SocketReader::resizeReadBatch(PacketBuffer *pktbuffer, PacketBuffer::container_type &bufQue, size_t batch) {
+	if (batch < bufQue.size()) {
+		PacketBuffer::container_type surplus(bufQue.begin() + batch, bufQue.end());
+		bufQue.erase_end(bufQue.size() - batch);
+		pktbuffer->recycle_buffers(surplus);
+	}
+
+	bufQue.set_capacity(batch);
+	pktbuffer->pop_empty_buffers(bufQue, batch);
+	return bufQue.size() == batch;
+}
+
+/**
+ * Copies a received SDDS packet into the buffer for handle. Anything past the size of an SDDS packet is dropped, the same
+ * as if it had been read off the socket.
+ */
+void SocketReader::copyPacket(PacketBuffer *pktbuffer, PacketHandle handle, const uint8_t *payload, size_t len) {
+	len = std::min(len, (size_t) SDDS_PACKET_SIZE);
+	size_t header_len = std::min(len, (size_t) SDDS_HEADER_SIZE);
+
+	memcpy(pktbuffer->header(handle), payload, header_len);
+	if (len > header_len) {
+		memcpy(pktbuffer->data(handle), payload + header_len, len - header_len);
+	}
+}
+
+/**
+ * Closes whichever socket was opened by setConnectionInfo.
+ */
+void SocketReader::closeSockets() {
 	LOG_DEBUG(SocketReader, "Closing socket");
 	if (m_multicast_connection.sock) { multicast_close(m_multicast_connection); 	memset(&m_multicast_connection, 0, sizeof(m_multicast_connection)); }
 	if (m_unicast_connection.sock) { unicast_close(m_unicast_connection); 			memset(&m_unicast_connection, 0, sizeof(m_unicast_connection)); }
@@ -309,6 +1495,22 @@ bool SocketReader::setSocketBlockingEnabled(int fd, bool blocking)
    return (fcntl(fd, F_SETFL, flags) == 0) ? true : false;
 }
 
+/**
+ * Points the iovecs for a single message at the provided packet. If splitData is set two iovecs are used,
+ * one for the header and one for the data, otherwise a single iovec covers the whole packet.
+ */
+void SocketReader::pointIovecs(struct iovec *iov, PacketBuffer *pktbuffer, PacketHandle handle, bool splitData) {
+	if (splitData) {
+		iov[0].iov_base = pktbuffer->header(handle);
+		iov[0].iov_len  = SDDS_HEADER_SIZE;
+		iov[1].iov_base = pktbuffer->data(handle);
+		iov[1].iov_len  = SDDS_DATA_SIZE;
+	} else {
+		iov[0].iov_base = pktbuffer->header(handle);
+		iov[0].iov_len  = SDDS_PACKET_SIZE;
+	}
+}
+
 /**
  * Runs through the list of received messages and confirms that they all came from
  * the expected host address. The expected host address is initially empty and set
@@ -320,17 +1522,23 @@ void SocketReader::confirmSingleHost(struct mmsghdr msgs[], size_t len) {
 
 	for (size_t i = 0; i < len; ++i) {
 		sockaddr_in * rcv_host_struct = reinterpret_cast<sockaddr_in *>(msgs[i].msg_hdr.msg_name);
+		confirmHost(rcv_host_struct->sin_addr);
+	}
+}
 
-		if (rcv_host_struct->sin_addr.s_addr != m_host_addr.s_addr) {
-			if (m_host_addr.s_addr != 0) {
-				//XXX: Do not combine these into a single log statement. The inet_ntoa returns a pointer to an internal array containing the string so if you call it twice
-				// on the same line it will overwrite itself, display the same value twice in the log statement, and cause the developer debugging to question their sanity.
-				LOG_WARN(SocketReader, "Expected packets to come from: " << inet_ntoa(m_host_addr));
-				LOG_WARN(SocketReader, "Received packet from: " << inet_ntoa(rcv_host_struct->sin_addr));
-			}
-
-			m_host_addr = rcv_host_struct->sin_addr;
+/**
+ * Confirms a single packet came from the expected host address, see confirmSingleHost.
+ */
+void SocketReader::confirmHost(const struct in_addr &rcv_addr) {
+	if (rcv_addr.s_addr != m_host_addr.s_addr) {
+		if (m_host_addr.s_addr != 0) {
+			//XXX: Do not combine these into a single log statement. The inet_ntoa returns a pointer to an internal array containing the string so if you call it twice
+			// on the same line it will overwrite itself, display the same value twice in the log statement, and cause the developer debugging to question their sanity.
+			LOG_WARN(SocketReader, "Expected packets to come from: " << inet_ntoa(m_host_addr));
+			LOG_WARN(SocketReader, "Received packet from: " << inet_ntoa(rcv_addr));
 		}
+
+		m_host_addr = rcv_addr;
 	}
 }
 
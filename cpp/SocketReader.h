@@ -29,17 +29,48 @@
 
 #define MAX_ALLOWED_TIMEOUT 3
 
-#include <boost/shared_ptr.hpp>
+#include <vector>
+#include <sys/socket.h>
+#include <boost/function.hpp>
 #include "sddspacket.h"
-#include "SmartPacketBuffer.h"
+#include "PacketBuffer.h"
 #include "ossie/debug.h"
 #include "socketUtils/multicast.h"
 #include "socketUtils/unicast.h"
 #include "socketUtils/SourceNicUtils.h"
 
 #define SDDS_PACKET_SIZE 1080
+#define SDDS_HEADER_SIZE 56
+#define SDDS_DATA_SIZE 1024
 
-typedef boost::shared_ptr<SDDSpacket> SddsPacketPtr;
+// How often (in ms) auto tuning looks at the recent reads and may change the read batch size.
+#define AUTO_TUNE_INTERVAL_MS 100
+
+enum ReceiveBackend {
+	RECEIVE_BACKEND_RECVMMSG,
+	RECEIVE_BACKEND_PACKET_MMAP,
+	RECEIVE_BACKEND_IO_URING
+};
+
+enum WaitPolicy {
+	WAIT_POLICY_POLL,
+	WAIT_POLICY_ADAPTIVE
+};
+
+// What the socket reader does when there are not enough empty buffers to replace the ones it has just filled
+enum OverflowPolicy {
+	OVERFLOW_POLICY_BLOCK,			// Wait for them, the socket is not read meanwhile
+	OVERFLOW_POLICY_DROP_NEWEST,	// Drop the packets just read and read into their buffers again
+	OVERFLOW_POLICY_RECLAIM_OLDEST	// Take back the oldest packets not yet processed, a reclaim block at a time
+};
+
+// What SocketReader::readShared stopped on
+enum SharedReadResult {
+	SHARED_READ_DRAINED,	// The socket is empty
+	SHARED_READ_BUDGET,		// The budget was used up, there may be more waiting
+	SHARED_READ_STARVED,	// There are no empty buffers to read into
+	SHARED_READ_ERROR		// The reader can not carry on
+};
 
 class SocketReader {
 	ENABLE_LOGGING
@@ -47,26 +78,116 @@ public:
 	SocketReader();
 	virtual ~SocketReader();
 
-    void run(SmartPacketBuffer<SDDSpacket> *pktbuffer, const bool confirmHosts);
+    void run(PacketBuffer *pktbuffer, const bool confirmHosts);
     void shutDown();
+    bool startShared(PacketBuffer *pktbuffer, const bool confirmHosts);
+    int getSharedSocket();
+    SharedReadResult readShared(size_t budget);
+    bool sharedStarved();
+    void stopShared();
+    void runToCompletion(PacketBuffer *pktbuffer, const bool confirmHosts, boost::function<void ()> on_read);
     void setPktsPerRead(size_t pkts_per_read);
     size_t getPktsPerRead();
+    void setAutoTune(bool auto_tune);
+    bool getAutoTune();
+    void setPktsPerReadBounds(size_t min_pkts_per_read, size_t max_pkts_per_read);
     void setConnectionInfo(std::string interface, std::string ip, uint16_t vlan, uint16_t port) throw (BadParameterError);
+    void setReaderShare(size_t index, size_t count);
     void setSocketBufferSize(int socket_buffer_size);
     size_t getSocketBufferSize();
     std::string getInterface();
+    void setReceiveBackend(std::string backend) throw (BadParameterError);
+    std::string getReceiveBackend();
+    std::string getActiveReceiveBackend();
+    void setWaitPolicy(std::string policy) throw (BadParameterError);
+    std::string getWaitPolicy();
+    void setSpinTime(size_t spin_time_us);
+    size_t getSpinTime();
+    void setBusyPollTime(size_t busy_poll_time_us);
+    size_t getBusyPollTime();
+    uint64_t getSpinMicros();
+    uint64_t getBusyPollMicros();
+    uint64_t getBlockedMicros();
+    void setUdpGro(bool udp_gro);
+    bool getUdpGro();
+    void setOverflowPolicy(std::string policy) throw (BadParameterError);
+    std::string getOverflowPolicy();
+    void setReclaimSize(size_t reclaim_size);
+    uint64_t getDroppedNewest();
+    uint64_t getReclaimedOldest();
+    uint64_t getGroDatagrams();
+    uint64_t getGroPackets();
     bool setSocketBlockingEnabled(int fd, bool blocking);
 private:
     bool m_shuttingDown;
     bool m_running;
     int m_timeout;
     struct in_addr m_host_addr;
-    size_t m_pkts_per_read;
+    volatile size_t m_pkts_per_read;
     size_t m_socket_buffer_size;
     multicast_t m_multicast_connection;
     unicast_t m_unicast_connection;
     std::string m_interface;
+    ReceiveBackend m_receive_backend;
+    volatile ReceiveBackend m_active_backend;
+    std::string m_ring_interface;
+    struct in_addr m_dst_addr;
+    uint16_t m_port;
+    size_t m_share_index;
+    size_t m_share_count;
+    WaitPolicy m_wait_policy;
+    size_t m_spin_time_us;
+    size_t m_busy_poll_time_us;
+    int m_busy_poll_set;
+    int64_t m_idle_avg_ns;
+    volatile uint64_t m_spin_ns;
+    volatile uint64_t m_busy_poll_ns;
+    volatile uint64_t m_blocked_ns;
+    bool m_udp_gro;
+    volatile uint64_t m_gro_datagrams;
+    volatile uint64_t m_gro_packets;
+    bool m_auto_tune;
+    size_t m_min_pkts_per_read;
+    size_t m_max_pkts_per_read;
+    uint64_t m_tune_start_ns;
+    size_t m_tune_reads;
+    size_t m_tune_pkts;
+    OverflowPolicy m_overflow_policy;
+    size_t m_reclaim_size;
+    volatile uint64_t m_dropped_newest;
+    volatile uint64_t m_reclaimed_oldest;
+    bool m_dropping;
+    size_t m_block_pos;
+
+    // The recvmmsg read loop, see setupReadLoop. Kept here so the shared reader engine can drive it a read at a time.
+    PacketBuffer::container_type m_bufQue;
+    std::vector<struct mmsghdr> m_msgs;
+    std::vector<struct iovec> m_iovecs;
+    std::vector<sockaddr_in> m_source_addrs;
+    size_t m_batch;
+    size_t m_msg_start;
+    bool m_split_data;
+    bool m_confirm_hosts;
+    int m_shared_socket;
+    PacketBuffer *m_shared_pktbuffer;
     void confirmSingleHost(struct mmsghdr msgs[], size_t len);
+    void confirmHost(const struct in_addr &rcv_addr);
+    void pointIovecs(struct iovec *iov, PacketBuffer *pktbuffer, PacketHandle handle, bool splitData);
+    bool runPacketRing(PacketBuffer *pktbuffer, int socket, const bool confirmHosts);
+    bool runUring(PacketBuffer *pktbuffer, int socket);
+    bool runGro(PacketBuffer *pktbuffer, int socket, struct pollfd *poll_struct, const bool confirmHosts);
+    int receivePackets(int socket, struct mmsghdr *msgs, size_t vlen, struct pollfd *poll_struct);
+    void waitReadable(struct pollfd *poll_struct);
+    void setBusyPoll(int socket, int busy_poll_us);
+    int prepareSocket();
+    bool setupReadLoop(PacketBuffer *pktbuffer, bool confirmHosts);
+    bool finishRead(PacketBuffer *pktbuffer, size_t num, bool tune);
+    size_t tuneReadBatch(PacketBuffer *pktbuffer, size_t batch, size_t pkts);
+    bool resizeReadBatch(PacketBuffer *pktbuffer, PacketBuffer::container_type &bufQue, size_t batch);
+    bool pushAndRefill(PacketBuffer *pktbuffer, PacketBuffer::container_type &bufQue, size_t num);
+    bool haveEmptyBuffers(PacketBuffer *pktbuffer, size_t num);
+    void copyPacket(PacketBuffer *pktbuffer, PacketHandle handle, const uint8_t *payload, size_t len);
+    void closeSockets();
     std::string getMcastIfaceFromRoutes(std::string group="224.0.0.0");
 
 };
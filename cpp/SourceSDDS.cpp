@@ -28,7 +28,12 @@
 
 #include "SourceSDDS.h"
 #include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <memory>
 #include "AffinityUtils.h"
+#include "SwapCopy.h"
 #include <ossie/CF/cf.h>
 
 PREPARE_LOGGING(SourceSDDS_i)
@@ -39,13 +44,23 @@ PREPARE_LOGGING(SourceSDDS_i)
  */
 SourceSDDS_i::SourceSDDS_i(const char *uuid, const char *label) :
     SourceSDDS_base(uuid, label),
+	m_activePktbuffer(&m_pktbuffer),
 	m_socketReaderThread(NULL),
 	m_sddsToBulkIOThread(NULL),
-	m_sddsToBulkIO(dataOctetOut, dataShortOut, dataFloatOut)
+	m_sharedReader(false),
+	m_nicNumaNode(-1),
+	m_numaNode(-1),
+	m_autoSocketReaderCpu(-1),
+	m_autoSddsToBulkIOCpu(-1),
+	m_socketReaderPlacement(PLACEMENT_DEFAULT),
+	m_sddsToBulkIOPlacement(PLACEMENT_DEFAULT),
+	m_sddsToBulkIO(dataOctetOut, dataShortOut, dataFloatOut),
+	m_startLatency(0)
 {
 	setPropertyQueryImpl(advanced_configuration, this, &SourceSDDS_i::get_advanced_configuration_struct);
 	setPropertyQueryImpl(advanced_optimizations, this, &SourceSDDS_i::get_advanced_optimizations_struct);
 	setPropertyQueryImpl(status, this, &SourceSDDS_i::get_status_struct);
+	setPropertyQueryImpl(stream_status, this, &SourceSDDS_i::get_stream_status);
 
 	setPropertyConfigureImpl(advanced_configuration, this, &SourceSDDS_i::set_advanced_configuration_struct);
 	setPropertyConfigureImpl(advanced_optimizations, this, &SourceSDDS_i::set_advanced_optimization_struct);
@@ -62,17 +77,44 @@ SourceSDDS_i::SourceSDDS_i(const char *uuid, const char *label) :
  * not already cleaned up. REDHAWK framework should handle lifecycle and the stop call will
  * close ports and cleanup.
  */
-SourceSDDS_i::~SourceSDDS_i(){}
+SourceSDDS_i::~SourceSDDS_i(){
+	// The shared reader engine outlives this instance, make sure it lets go of our socket reader
+	if (m_sharedReader) {
+		SharedReaderEngine::instance().detach(&m_socketReader);
+	}
+	stopAttachedStreams();
+}
 
 /**
  * Required method for the SDDS setNewSriListener API. Forwards the received SRI down to the SDDS to
- * BulkIO class so that it can incorporate the SRI into the outputed BulkIO stream.
+ * BulkIO class so that it can incorporate the SRI into the outputed BulkIO stream. SRI whose stream ID
+ * matches the attach ID of a stream attached after the first goes to that stream, any other goes to the first.
  */
 void SourceSDDS_i::newSriListener(const BULKIO::StreamSRI & newSri) {
 	LOG_INFO(SourceSDDS_i, "Received new upstream SRI");
+	{
+		boost::mutex::scoped_lock lock(m_attachedStreamsLock);
+		for (size_t i = 0; i < m_attachedStreams.size(); ++i) {
+			if (m_attachedStreams[i].id == static_cast<const char*>(newSri.streamID)) {
+				m_attachedStreams[i].sddsToBulkIO.setUpstreamSri(newSri);
+				return;
+			}
+		}
+	}
 	m_sddsToBulkIO.setUpstreamSri(newSri);
 }
 
+/**
+ * Formats a count of packet buffers as the count and the percent of total it makes up.
+ */
+std::string SourceSDDS_i::formatBufferCount(size_t num, size_t total) {
+	float percent = (total) ? 100*(float) num / (float) total : 0;
+	std::stringstream ss;
+	ss.precision(2);
+	ss << std::fixed << num << " (" << percent << "%)";
+	return ss.str();
+}
+
 /**
  * The getter used for the status_struct. This is registered in the constructor
  * such that the REDHAWK framework will call this method rather than use the query API.
@@ -84,17 +126,8 @@ struct status_struct SourceSDDS_i::get_status_struct() {
 
 	retVal.bits_per_sample = m_sddsToBulkIO.getBps();
 
-	float percent = 100*(float) m_pktbuffer.get_num_full_buffers() / (float) advanced_optimizations.buffer_size;
-	std::stringstream ss;
-	ss.precision(2);
-	ss << std::fixed << m_pktbuffer.get_num_full_buffers() << " (" << percent << "%)";
-	retVal.buffers_to_work = ss.str();
-	ss.str("");
-
-	percent = 100*(float) m_pktbuffer.get_num_empty_buffers() / (float) advanced_optimizations.buffer_size;
-	ss << std::fixed << m_pktbuffer.get_num_empty_buffers() << " (" << percent << "%)";
-	retVal.empty_buffers_available = ss.str();
-	ss.str("");
+	retVal.buffers_to_work = formatBufferCount(m_activePktbuffer->get_num_full_buffers(), m_activePktbuffer->capacity());
+	retVal.empty_buffers_available = formatBufferCount(m_activePktbuffer->get_num_empty_buffers(), m_activePktbuffer->capacity());
 
 	retVal.dropped_packets = m_sddsToBulkIO.getNumDropped();
 
@@ -104,6 +137,10 @@ struct status_struct SourceSDDS_i::get_status_struct() {
 	retVal.input_port = (attachment_override.enabled) ? attachment_override.port:m_attach_stream.port;
 	retVal.input_vlan = (attachment_override.enabled) ? attachment_override.vlan:m_attach_stream.vlan;
 
+	float percent;
+	std::stringstream ss;
+	ss.precision(2);
+
 	// Not 100% sure why but the queue can actually get about 280 bytes larger than the set max. I guess linux gives 110% har har har (not actually 110%)
 	uint64_t rx_queue = get_rx_queue(retVal.input_address, retVal.input_port, num_listeners);
 	percent = 100*(float) rx_queue / (float) m_socketReader.getSocketBufferSize();
@@ -116,11 +153,94 @@ struct status_struct SourceSDDS_i::get_status_struct() {
 	retVal.input_samplerate = m_sddsToBulkIO.getSampleRate();
 	retVal.input_endianness = m_sddsToBulkIO.getEndianness();
 	retVal.time_slips = m_sddsToBulkIO.getTimeSlips();
+	retVal.sri_changes = m_sddsToBulkIO.getSriChanges();
 
 	retVal.num_packets_dropped_by_nic = get_rx_dropped(status.interface);
 
 	retVal.interface = status.interface;
 
+	retVal.socket_reader_spin_time = m_socketReader.getSpinMicros();
+	retVal.socket_reader_busy_poll_time = m_socketReader.getBusyPollMicros();
+	retVal.socket_reader_blocked_time = m_socketReader.getBlockedMicros();
+	retVal.overflow_dropped_newest = m_socketReader.getDroppedNewest();
+	retVal.overflow_reclaimed_oldest = m_socketReader.getReclaimedOldest();
+	for (size_t i = 0; i < m_extraSocketReaders.size(); ++i) {
+		retVal.socket_reader_spin_time += m_extraSocketReaders[i].getSpinMicros();
+		retVal.socket_reader_busy_poll_time += m_extraSocketReaders[i].getBusyPollMicros();
+		retVal.socket_reader_blocked_time += m_extraSocketReaders[i].getBlockedMicros();
+		retVal.overflow_dropped_newest += m_extraSocketReaders[i].getDroppedNewest();
+		retVal.overflow_reclaimed_oldest += m_extraSocketReaders[i].getReclaimedOldest();
+	}
+
+	uint64_t gro_datagrams = m_socketReader.getGroDatagrams();
+	retVal.gro_coalescing_ratio = (gro_datagrams) ? (double) m_socketReader.getGroPackets() / (double) gro_datagrams : 0.0;
+
+	SddsPacketPool &pool = m_activePktbuffer->pool();
+	if (pool.page_size()) {
+		ss << pool.page_size() / 1024 << " kB";
+		if (pool.huge_tlb()) {
+			ss << " (hugetlb)";
+		} else if (pool.page_size() > (size_t) sysconf(_SC_PAGESIZE)) {
+			ss << " (transparent)";
+		}
+	}
+	retVal.buffer_page_size = ss.str();
+	retVal.buffer_locked_bytes = pool.locked_bytes();
+	retVal.buffer_capacity = m_activePktbuffer->capacity();
+	retVal.buffer_reused = m_activePktbuffer->pool().reused();
+	retVal.start_latency = m_startLatency;
+	retVal.byte_swap_kernel = swapCopyKernel();
+	retVal.buffer_capacity_high_water = (m_activePktbuffer == &m_pktbuffer) ? m_pktbuffer.capacity_high_water() : m_activePktbuffer->capacity();
+	retVal.nic_numa_node = m_nicNumaNode;
+	retVal.buffer_numa_node = pool.numa_node();
+	retVal.real_time_status = m_realTime.getStatus();
+	retVal.receive_backend_in_use = m_socketReader.getActiveReceiveBackend();
+
+	return retVal;
+}
+
+/**
+ * The getter used for the stream_status sequence. This is registered in the constructor
+ * such that the REDHAWK framework will call this method rather than use the query API.
+ * The first entry is the stream set by the first attach or the attachment override, if any.
+ */
+std::vector<stream_status_entry_struct> SourceSDDS_i::get_stream_status() {
+	std::vector<stream_status_entry_struct> retVal;
+
+	if (m_attach_stream.attached or attachment_override.enabled) {
+		stream_status_entry_struct entry;
+		entry.attach_id = (attachment_override.enabled) ? "" : m_attach_stream.id;
+		entry.input_stream_id = m_sddsToBulkIO.getStreamId();
+		entry.input_address = (attachment_override.enabled) ? attachment_override.ip_address:m_attach_stream.multicastAddress;
+		entry.input_port = (attachment_override.enabled) ? attachment_override.port:m_attach_stream.port;
+		entry.input_vlan = (attachment_override.enabled) ? attachment_override.vlan:m_attach_stream.vlan;
+		entry.bits_per_sample = m_sddsToBulkIO.getBps();
+		entry.expected_sequence_number = m_sddsToBulkIO.getExpectedSequenceNumber();
+		entry.dropped_packets = m_sddsToBulkIO.getNumDropped();
+		entry.time_slips = m_sddsToBulkIO.getTimeSlips();
+		entry.buffers_to_work = formatBufferCount(m_activePktbuffer->get_num_full_buffers(), m_activePktbuffer->capacity());
+		entry.empty_buffers_available = formatBufferCount(m_activePktbuffer->get_num_empty_buffers(), m_activePktbuffer->capacity());
+		retVal.push_back(entry);
+	}
+
+	boost::mutex::scoped_lock lock(m_attachedStreamsLock);
+	for (size_t i = 0; i < m_attachedStreams.size(); ++i) {
+		AttachedStream &stream = m_attachedStreams[i];
+		stream_status_entry_struct entry;
+		entry.attach_id = stream.id;
+		entry.input_stream_id = stream.sddsToBulkIO.getStreamId();
+		entry.input_address = stream.multicastAddress;
+		entry.input_port = stream.port;
+		entry.input_vlan = stream.vlan;
+		entry.bits_per_sample = stream.sddsToBulkIO.getBps();
+		entry.expected_sequence_number = stream.sddsToBulkIO.getExpectedSequenceNumber();
+		entry.dropped_packets = stream.sddsToBulkIO.getNumDropped();
+		entry.time_slips = stream.sddsToBulkIO.getTimeSlips();
+		entry.buffers_to_work = formatBufferCount(stream.pktbuffer.get_num_full_buffers(), stream.pktbuffer.capacity());
+		entry.empty_buffers_available = formatBufferCount(stream.pktbuffer.get_num_empty_buffers(), stream.pktbuffer.capacity());
+		retVal.push_back(entry);
+	}
+
 	return retVal;
 }
 
@@ -163,6 +283,32 @@ struct advanced_optimizations_struct SourceSDDS_i::get_advanced_optimizations_st
 	retVal.sdds_to_bulkio_thread_priority = advanced_optimizations.sdds_to_bulkio_thread_priority;
 	retVal.socket_read_thread_priority = advanced_optimizations.socket_read_thread_priority;
 	retVal.check_for_duplicate_sender = advanced_optimizations.check_for_duplicate_sender;
+	retVal.lock_free_buffer = advanced_optimizations.lock_free_buffer;
+	retVal.zero_copy_receive = advanced_optimizations.zero_copy_receive;
+	retVal.receive_backend = m_socketReader.getReceiveBackend();
+	retVal.wait_policy = m_socketReader.getWaitPolicy();
+	retVal.overflow_policy = m_socketReader.getOverflowPolicy();
+	retVal.spin_time = m_socketReader.getSpinTime();
+	retVal.busy_poll_time = m_socketReader.getBusyPollTime();
+	retVal.num_socket_readers = advanced_optimizations.num_socket_readers;
+	retVal.udp_gro = m_socketReader.getUdpGro();
+	retVal.auto_tune = advanced_optimizations.auto_tune;
+	retVal.min_pkts_per_socket_read = advanced_optimizations.min_pkts_per_socket_read;
+	retVal.max_pkts_per_socket_read = advanced_optimizations.max_pkts_per_socket_read;
+	retVal.min_sdds_pkts_per_bulkio_push = advanced_optimizations.min_sdds_pkts_per_bulkio_push;
+	retVal.max_sdds_pkts_per_bulkio_push = advanced_optimizations.max_sdds_pkts_per_bulkio_push;
+	retVal.shared_reader_threads = advanced_optimizations.shared_reader_threads;
+	retVal.shared_reader_budget = advanced_optimizations.shared_reader_budget;
+	retVal.max_attached_streams = advanced_optimizations.max_attached_streams;
+	retVal.stream_worker_threads = advanced_optimizations.stream_worker_threads;
+	retVal.conversion_threads = advanced_optimizations.conversion_threads;
+	retVal.run_to_completion = advanced_optimizations.run_to_completion;
+	retVal.huge_page_buffer = advanced_optimizations.huge_page_buffer;
+	retVal.lock_buffer_memory = advanced_optimizations.lock_buffer_memory;
+	retVal.numa_placement = advanced_optimizations.numa_placement;
+	retVal.real_time_mode = advanced_optimizations.real_time_mode;
+	retVal.real_time_priority = advanced_optimizations.real_time_priority;
+	retVal.max_buffer_memory = advanced_optimizations.max_buffer_memory;
 
 	return retVal;
 }
@@ -200,22 +346,37 @@ void SourceSDDS_i::set_advanced_optimization_struct(struct advanced_optimization
 		advanced_optimizations.buffer_size = request.buffer_size;
 	}
 
+	if (not started()) {
+		advanced_optimizations.max_buffer_memory = request.max_buffer_memory;
+	} else if (advanced_optimizations.max_buffer_memory != request.max_buffer_memory) {
+		LOG_WARN(SourceSDDS_i, "Cannot change the max buffer memory while running");
+	}
+
+	// While auto tuning the two sizes report what is in use, so a request carrying an older value back is not a change
 	if (not started()) {
 		advanced_optimizations.pkts_per_socket_read = request.pkts_per_socket_read;
 		m_socketReader.setPktsPerRead(request.pkts_per_socket_read);
-	} else if(m_socketReader.getPktsPerRead() != request.pkts_per_socket_read) {
+	} else if(not advanced_optimizations.auto_tune && m_socketReader.getPktsPerRead() != request.pkts_per_socket_read) {
 		LOG_WARN(SourceSDDS_i, "Cannot set packets per socket read size while the component is running");
 	}
 
 	if (not started()) {
 		advanced_optimizations.sdds_pkts_per_bulkio_push = request.sdds_pkts_per_bulkio_push;
 		m_sddsToBulkIO.setPktsPerRead(request.sdds_pkts_per_bulkio_push);
-	} else if (m_sddsToBulkIO.getPktsPerRead() != request.sdds_pkts_per_bulkio_push) {
+	} else if (not advanced_optimizations.auto_tune && m_sddsToBulkIO.getPktsPerRead() != request.sdds_pkts_per_bulkio_push) {
 		LOG_WARN(SourceSDDS_i, "Cannot set the packets per bulkIO push while the component is running");
 	}
 
+	// An affinity which differs from the one read back has been set, it now decides the placement
+	if (request.sdds_to_bulkio_thread_affinity != advanced_optimizations.sdds_to_bulkio_thread_affinity) {
+		m_sddsToBulkIOPlacement = placementOf(request.sdds_to_bulkio_thread_affinity);
+	}
+	if (request.socket_read_thread_affinity != advanced_optimizations.socket_read_thread_affinity) {
+		m_socketReaderPlacement = placementOf(request.socket_read_thread_affinity);
+	}
+
 	if (started() && m_sddsToBulkIOThread) {
-		if (setAffinity(m_sddsToBulkIOThread->native_handle(), request.sdds_to_bulkio_thread_affinity) != 0) {
+		if (setThreadAffinity(m_sddsToBulkIOThread, request.sdds_to_bulkio_thread_affinity, m_sddsToBulkIOPlacement, m_autoSddsToBulkIOCpu) != 0) {
 			LOG_WARN(SourceSDDS_i, "Failed to set affinity of the SDDS to bulkIO thread");
 		}
 		advanced_optimizations.sdds_to_bulkio_thread_affinity = getAffinity(m_sddsToBulkIOThread->native_handle());
@@ -224,9 +385,12 @@ void SourceSDDS_i::set_advanced_optimization_struct(struct advanced_optimization
 	}
 
 	if (started() && m_socketReaderThread) {
-		if (setAffinity(m_socketReaderThread->native_handle(), request.socket_read_thread_affinity) != 0) {
+		if (setThreadAffinity(m_socketReaderThread, request.socket_read_thread_affinity, m_socketReaderPlacement, m_autoSocketReaderCpu) != 0) {
 			LOG_WARN(SourceSDDS_i, "Failed to set affinity of the socket reader thread");
 		}
+		for (size_t i = 0; i < m_extraSocketReaderThreads.size(); ++i) {
+			setThreadAffinity(m_extraSocketReaderThreads[i], request.socket_read_thread_affinity, m_socketReaderPlacement, m_autoSocketReaderCpu);
+		}
 		advanced_optimizations.socket_read_thread_affinity = getAffinity(m_socketReaderThread->native_handle());
 	} else {
 		advanced_optimizations.socket_read_thread_affinity = request.socket_read_thread_affinity;
@@ -241,13 +405,17 @@ void SourceSDDS_i::set_advanced_optimization_struct(struct advanced_optimization
 	advanced_optimizations.socket_read_thread_priority = request.socket_read_thread_priority;
 
 	if (m_socketReaderThread) {
-		setPolicyAndPriority(m_socketReaderThread->native_handle(), request.socket_read_thread_priority, "socket reader thread");
+		setThreadPriority(m_socketReaderThread, request.socket_read_thread_priority, "socket reader thread");
+	}
+
+	for (size_t i = 0; i < m_extraSocketReaderThreads.size(); ++i) {
+		setThreadPriority(m_extraSocketReaderThreads[i], request.socket_read_thread_priority, "socket reader thread");
 	}
 
 	advanced_optimizations.sdds_to_bulkio_thread_priority = request.sdds_to_bulkio_thread_priority;
 
 	if (m_sddsToBulkIOThread) {
-		setPolicyAndPriority(m_sddsToBulkIOThread->native_handle(), request.sdds_to_bulkio_thread_priority, "sdds to bulkio thread");
+		setThreadPriority(m_sddsToBulkIOThread, request.sdds_to_bulkio_thread_priority, "sdds to bulkio thread");
 	}
 
 	if (not started()) {
@@ -255,6 +423,138 @@ void SourceSDDS_i::set_advanced_optimization_struct(struct advanced_optimization
 	} else if (advanced_optimizations.check_for_duplicate_sender != request.check_for_duplicate_sender) {
 		LOG_WARN(SourceSDDS_i, "Cannot change the check for single sender property while running");
 	}
+
+	if (not started()) {
+		advanced_optimizations.lock_free_buffer = request.lock_free_buffer;
+	} else if (advanced_optimizations.lock_free_buffer != request.lock_free_buffer) {
+		LOG_WARN(SourceSDDS_i, "Cannot change the lock free buffer property while running");
+	}
+
+	if (not started()) {
+		advanced_optimizations.zero_copy_receive = request.zero_copy_receive;
+	} else if (advanced_optimizations.zero_copy_receive != request.zero_copy_receive) {
+		LOG_WARN(SourceSDDS_i, "Cannot change the zero copy receive property while running");
+	}
+
+	if (not started()) {
+		try {
+			m_socketReader.setReceiveBackend(request.receive_backend);
+		} catch (BadParameterError &e) {
+			LOG_WARN(SourceSDDS_i, "Failed to set the receive backend: " << e.what());
+		}
+	} else if (m_socketReader.getReceiveBackend() != request.receive_backend) {
+		LOG_WARN(SourceSDDS_i, "Cannot change the receive backend while running");
+	}
+
+	if (not started()) {
+		try {
+			m_socketReader.setWaitPolicy(request.wait_policy);
+		} catch (BadParameterError &e) {
+			LOG_WARN(SourceSDDS_i, "Failed to set the wait policy: " << e.what());
+		}
+		m_socketReader.setSpinTime(request.spin_time);
+		m_socketReader.setBusyPollTime(request.busy_poll_time);
+	} else if (m_socketReader.getWaitPolicy() != request.wait_policy || m_socketReader.getSpinTime() != request.spin_time ||
+			m_socketReader.getBusyPollTime() != request.busy_poll_time) {
+		LOG_WARN(SourceSDDS_i, "Cannot change the wait policy, spin time or busy poll time while running");
+	}
+
+	// Kept in the property too since the streams attached after the first take it from there
+	if (not started()) {
+		try {
+			m_socketReader.setOverflowPolicy(request.overflow_policy);
+		} catch (BadParameterError &e) {
+			LOG_WARN(SourceSDDS_i, "Failed to set the overflow policy: " << e.what());
+		}
+		advanced_optimizations.overflow_policy = m_socketReader.getOverflowPolicy();
+	} else if (m_socketReader.getOverflowPolicy() != request.overflow_policy) {
+		LOG_WARN(SourceSDDS_i, "Cannot change the overflow policy while running");
+	}
+
+	if (not started()) {
+		m_socketReader.setUdpGro(request.udp_gro);
+	} else if (m_socketReader.getUdpGro() != request.udp_gro) {
+		LOG_WARN(SourceSDDS_i, "Cannot change UDP GRO while running");
+	}
+
+	if (not started()) {
+		if (request.num_socket_readers == 0) {
+			LOG_WARN(SourceSDDS_i, "The number of socket readers must be at least one");
+		} else {
+			advanced_optimizations.num_socket_readers = request.num_socket_readers;
+		}
+	} else if (advanced_optimizations.num_socket_readers != request.num_socket_readers) {
+		LOG_WARN(SourceSDDS_i, "Cannot change the number of socket readers while running");
+	}
+
+	if (not started()) {
+		advanced_optimizations.auto_tune = request.auto_tune;
+		advanced_optimizations.min_pkts_per_socket_read = request.min_pkts_per_socket_read;
+		advanced_optimizations.max_pkts_per_socket_read = request.max_pkts_per_socket_read;
+		advanced_optimizations.min_sdds_pkts_per_bulkio_push = request.min_sdds_pkts_per_bulkio_push;
+		advanced_optimizations.max_sdds_pkts_per_bulkio_push = request.max_sdds_pkts_per_bulkio_push;
+	} else if (advanced_optimizations.auto_tune != request.auto_tune ||
+			advanced_optimizations.min_pkts_per_socket_read != request.min_pkts_per_socket_read ||
+			advanced_optimizations.max_pkts_per_socket_read != request.max_pkts_per_socket_read ||
+			advanced_optimizations.min_sdds_pkts_per_bulkio_push != request.min_sdds_pkts_per_bulkio_push ||
+			advanced_optimizations.max_sdds_pkts_per_bulkio_push != request.max_sdds_pkts_per_bulkio_push) {
+		LOG_WARN(SourceSDDS_i, "Cannot change auto tuning or its bounds while running");
+	}
+
+	if (not started()) {
+		advanced_optimizations.shared_reader_threads = request.shared_reader_threads;
+		advanced_optimizations.shared_reader_budget = request.shared_reader_budget;
+	} else if (advanced_optimizations.shared_reader_threads != request.shared_reader_threads ||
+			advanced_optimizations.shared_reader_budget != request.shared_reader_budget) {
+		LOG_WARN(SourceSDDS_i, "Cannot change the shared reader threads or budget while running");
+	}
+
+	// Only limits further attaches, streams already attached stay attached
+	advanced_optimizations.max_attached_streams = request.max_attached_streams;
+
+	if (not started()) {
+		advanced_optimizations.stream_worker_threads = request.stream_worker_threads;
+	} else if (advanced_optimizations.stream_worker_threads != request.stream_worker_threads) {
+		LOG_WARN(SourceSDDS_i, "Cannot change the number of stream worker threads while running");
+	}
+
+	if (not started()) {
+		advanced_optimizations.conversion_threads = request.conversion_threads;
+	} else if (advanced_optimizations.conversion_threads != request.conversion_threads) {
+		LOG_WARN(SourceSDDS_i, "Cannot change the number of conversion threads while running");
+	}
+
+	if (not started()) {
+		advanced_optimizations.run_to_completion = request.run_to_completion;
+	} else if (advanced_optimizations.run_to_completion != request.run_to_completion) {
+		LOG_WARN(SourceSDDS_i, "Cannot change run to completion while running");
+	}
+
+	if (not started()) {
+		advanced_optimizations.huge_page_buffer = request.huge_page_buffer;
+		advanced_optimizations.lock_buffer_memory = request.lock_buffer_memory;
+	} else if (advanced_optimizations.huge_page_buffer != request.huge_page_buffer ||
+			advanced_optimizations.lock_buffer_memory != request.lock_buffer_memory) {
+		LOG_WARN(SourceSDDS_i, "Cannot change how the internal buffer memory is backed while running");
+	}
+
+	if (not started()) {
+		advanced_optimizations.numa_placement = request.numa_placement;
+	} else if (advanced_optimizations.numa_placement != request.numa_placement) {
+		LOG_WARN(SourceSDDS_i, "Cannot change NUMA placement while running");
+	}
+
+	if (not started()) {
+		advanced_optimizations.real_time_mode = request.real_time_mode;
+		if (request.real_time_priority < sched_get_priority_min(SCHED_FIFO) || request.real_time_priority > sched_get_priority_max(SCHED_FIFO)) {
+			LOG_WARN(SourceSDDS_i, "The real time priority must be from " << sched_get_priority_min(SCHED_FIFO) << " to " << sched_get_priority_max(SCHED_FIFO));
+		} else {
+			advanced_optimizations.real_time_priority = request.real_time_priority;
+		}
+	} else if (advanced_optimizations.real_time_mode != request.real_time_mode ||
+			advanced_optimizations.real_time_priority != request.real_time_priority) {
+		LOG_WARN(SourceSDDS_i, "Cannot change real time mode while running");
+	}
 }
 
 /**
@@ -278,18 +578,49 @@ void SourceSDDS_i::start() throw (CORBA::SystemException, CF::Resource::StartErr
 		_start();
 	}
 
+	startAttachedStreams();
+
 	// Call the parent start
 	SourceSDDS_base::start();
 }
 
+/**
+ * Starts, or restarts, processing of the first stream and records how long it took in m_startLatency.
+ * See startProcessing.
+ */
 void SourceSDDS_i::_start() throw (CF::Resource::StartError) {
+	struct timespec begin, end;
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	startProcessing();
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	m_startLatency = (uint64_t) (end.tv_sec - begin.tv_sec) * 1000000 + (end.tv_nsec - begin.tv_nsec) / 1000;
+}
+
+/**
+ * Stops anything still running for the first stream, readies the internal buffer and starts the threads. The buffer
+ * keeps its memory from the last start unless its size, layout or memory options have changed, see SddsPacketPool.
+ */
+void SourceSDDS_i::startProcessing() throw (CF::Resource::StartError) {
 
 	std::stringstream errorText;
 	// This also destroys all of our buffers
 	destroyBuffersAndJoinThreads();
 
-	// Initialize our buffer of packets
-	m_pktbuffer.initialize(advanced_optimizations.buffer_size);
+	// Initialize our buffer of packets, several socket readers always feed the processor through the merge
+	PacketBuffer *previousPktbuffer = m_activePktbuffer;
+	if (advanced_optimizations.num_socket_readers > 1) {
+		m_mergePktbuffer.set_num_lanes(advanced_optimizations.num_socket_readers);
+		m_activePktbuffer = &m_mergePktbuffer;
+	} else if (advanced_optimizations.lock_free_buffer) {
+		m_activePktbuffer = &m_lockFreePktbuffer;
+	} else {
+		m_activePktbuffer = &m_pktbuffer;
+	}
+
+	// Only the buffer in use holds on to its memory
+	if (previousPktbuffer != m_activePktbuffer) {
+		previousPktbuffer->pool().release();
+	}
 
 	try {
 		setupSocketReaderOptions();
@@ -299,30 +630,217 @@ void SourceSDDS_i::_start() throw (CF::Resource::StartError) {
 		throw CF::Resource::StartError(CF::CF_EINVAL, errorText.str().c_str());
 	}
 
-	m_socketReaderThread = new boost::thread(boost::bind(&SocketReader::run, boost::ref(m_socketReader), &m_pktbuffer, advanced_optimizations.check_for_duplicate_sender));
+	// Now the interface is known, keep the buffer and the threads on its NIC's NUMA node
+	m_nicNumaNode = getNumaNode(m_socketReader.getInterface());
+	m_numaNode = -1;
+	if (advanced_optimizations.numa_placement && m_nicNumaNode >= 0) {
+		if (getNodeCpus(m_nicNumaNode, m_numaCpus)) {
+			m_numaNode = m_nicNumaNode;
+		} else {
+			LOG_WARN(SourceSDDS_i, "Could not read the CPUs of NUMA node " << m_nicNumaNode << ", the threads will not be placed on it");
+		}
+	}
 
-	// Attempt to set the affinity of the socket reader thread if the user has told us to.
-	if (!advanced_optimizations.socket_read_thread_affinity.empty() && !(advanced_optimizations.socket_read_thread_affinity == "")) {
-		setAffinity(m_socketReaderThread->native_handle(), advanced_optimizations.socket_read_thread_affinity);
+	// Likewise pick CPUs near where the NIC's receive interrupts are serviced if either thread is to be placed that way
+	m_autoSocketReaderCpu = m_autoSddsToBulkIOCpu = -1;
+	if (advanced_optimizations.socket_read_thread_affinity == "auto" || m_socketReaderPlacement == PLACEMENT_AUTO ||
+			advanced_optimizations.sdds_to_bulkio_thread_affinity == "auto" || m_sddsToBulkIOPlacement == PLACEMENT_AUTO) {
+		if (getAutoPlacement(m_socketReader.getInterface(), m_autoSocketReaderCpu, m_autoSddsToBulkIOCpu)) {
+			LOG_INFO(SourceSDDS_i, "Auto affinity placed the socket reader on CPU " << m_autoSocketReaderCpu << " and the sdds to bulkio thread on CPU " <<
+					m_autoSddsToBulkIOCpu << " from the receive interrupts of " << m_socketReader.getInterface());
+		} else {
+			m_autoSocketReaderCpu = m_autoSddsToBulkIOCpu = -1;
+			LOG_WARN(SourceSDDS_i, "Could not find the receive interrupts of " << m_socketReader.getInterface() << ", auto affinity falls back to NUMA placement");
+		}
 	}
 
-	advanced_optimizations.socket_read_thread_affinity = getAffinity(m_socketReaderThread->native_handle());
-	setPolicyAndPriority(m_socketReaderThread->native_handle(), advanced_optimizations.socket_read_thread_priority, "socket reader thread");
+	// Before the buffer and the threads, so both are locked in memory as they are made
+	if (advanced_optimizations.real_time_mode) {
+		m_realTime.enable(advanced_optimizations.real_time_priority);
+	} else {
+		m_realTime.disable();
+	}
+
+	if (m_socketReader.getOverflowPolicy() == "reclaim_oldest" && m_activePktbuffer != &m_pktbuffer) {
+		LOG_WARN(SourceSDDS_i, "The reclaim oldest overflow policy needs the default packet buffer, with lock_free_buffer or more than one socket reader the newest packets are dropped instead");
+	}
+
+	// Only the default packet buffer is elastic, the others stay at buffer_size
+	size_t max_capacity = advanced_optimizations.max_buffer_memory / sizeof(SDDSpacket);
+	if (max_capacity > advanced_optimizations.buffer_size && m_activePktbuffer != &m_pktbuffer) {
+		LOG_WARN(SourceSDDS_i, "The internal buffer can only grow to max_buffer_memory with the default packet buffer, with lock_free_buffer or more than one socket reader it stays at buffer_size");
+	}
+	m_pktbuffer.set_max_capacity(max_capacity);
+
+	m_activePktbuffer->pool().set_memory_options(advanced_optimizations.huge_page_buffer, advanced_optimizations.lock_buffer_memory);
+	m_activePktbuffer->pool().set_numa_node(advanced_optimizations.numa_placement ? m_nicNumaNode : -1);
+	m_activePktbuffer->initialize(advanced_optimizations.buffer_size, advanced_optimizations.zero_copy_receive);
+	if (m_activePktbuffer->pool().lock_error()) {
+		LOG_WARN(SourceSDDS_i, "Could not lock the internal buffer into memory, it may be swapped out: " << strerror(m_activePktbuffer->pool().lock_error()) <<
+				". Raise the memory lock limit (ulimit -l) above " << m_activePktbuffer->pool().bytes() << " bytes or unset lock_buffer_memory.");
+	}
+
+	if (advanced_optimizations.run_to_completion && not m_extraSocketReaders.empty()) {
+		LOG_WARN(SourceSDDS_i, "Run to completion cannot be used with more than one socket reader, starting socket reader and sdds to bulkio threads");
+	} else if (advanced_optimizations.run_to_completion) {
+		if (advanced_optimizations.shared_reader_threads > 0) {
+			LOG_WARN(SourceSDDS_i, "The shared reader engine is not used in run to completion mode");
+		}
+		if (m_socketReader.getReceiveBackend() != "recvmmsg") {
+			LOG_WARN(SourceSDDS_i, "The " << m_socketReader.getReceiveBackend() << " receive backend is not used in run to completion mode, the socket is read with recvmmsg");
+		}
+		if (m_socketReader.getUdpGro()) {
+			LOG_WARN(SourceSDDS_i, "UDP GRO is not used in run to completion mode");
+		}
+		if (m_socketReader.getWaitPolicy() == "adaptive" && m_socketReader.getBusyPollTime() > 0) {
+			LOG_WARN(SourceSDDS_i, "The busy poll time is not used in run to completion mode, the thread sleeps in poll once it has spun for the spin time");
+		}
+		startRunToCompletionThread();
+		return;
+	}
+
+	if (advanced_optimizations.shared_reader_threads > 0 && not m_extraSocketReaders.empty()) {
+		LOG_WARN(SourceSDDS_i, "The shared reader engine cannot be used with more than one socket reader, starting socket reader threads");
+	}
+
+	if (advanced_optimizations.shared_reader_threads > 0 && m_extraSocketReaders.empty()) {
+		m_sharedReader = SharedReaderEngine::instance().attach(&m_socketReader, m_activePktbuffer, advanced_optimizations.check_for_duplicate_sender,
+				advanced_optimizations.shared_reader_threads, advanced_optimizations.shared_reader_budget);
+		if (not m_sharedReader) {
+			errorText << "Failed to add the socket to the shared reader engine";
+			LOG_ERROR(SourceSDDS_i, errorText.str());
+			throw CF::Resource::StartError(CF::CF_EINVAL, errorText.str().c_str());
+		}
+	} else if (m_extraSocketReaders.empty()) {
+		startSocketReaderThread(m_socketReader, m_activePktbuffer, m_socketReaderThread);
+	} else {
+		startSocketReaderThread(m_socketReader, &m_mergePktbuffer.lane(0), m_socketReaderThread);
+		m_extraSocketReaderThreads.resize(m_extraSocketReaders.size(), NULL);
+		for (size_t i = 0; i < m_extraSocketReaders.size(); ++i) {
+			startSocketReaderThread(m_extraSocketReaders[i], &m_mergePktbuffer.lane(i + 1), m_extraSocketReaderThreads[i]);
+		}
+	}
+
+	// The requested affinity is applied to every reader, report the first
+	if (m_socketReaderThread) {
+		advanced_optimizations.socket_read_thread_affinity = getAffinity(m_socketReaderThread->native_handle());
+	}
 
 	//////////////////////////////////////////
 	// Now setup the packet processor
 	//////////////////////////////////////////
 	setupSddsToBulkIOOptions();
-	m_sddsToBulkIOThread = new boost::thread(boost::bind(&SddsToBulkIOProcessor::run, boost::ref(m_sddsToBulkIO), &m_pktbuffer));
+	m_sddsToBulkIOThread = new boost::thread(boost::bind(&RealTimeMode::run, boost::ref(m_realTime),
+			boost::function<void ()>(boost::bind(&SddsToBulkIOProcessor::run, boost::ref(m_sddsToBulkIO), m_activePktbuffer))));
 
 	// Attempt to set the affinity of the sdds to bulkio thread if the user has told us to.
-	if (!advanced_optimizations.sdds_to_bulkio_thread_affinity.empty() && !(advanced_optimizations.sdds_to_bulkio_thread_affinity== "")) {
-		setAffinity(m_sddsToBulkIOThread->native_handle(), advanced_optimizations.sdds_to_bulkio_thread_affinity);
-	}
+	setThreadAffinity(m_sddsToBulkIOThread, advanced_optimizations.sdds_to_bulkio_thread_affinity, m_sddsToBulkIOPlacement, m_autoSddsToBulkIOCpu);
 
 	advanced_optimizations.sdds_to_bulkio_thread_affinity = getAffinity(m_sddsToBulkIOThread->native_handle());
-	setPolicyAndPriority(m_sddsToBulkIOThread->native_handle(), advanced_optimizations.sdds_to_bulkio_thread_priority, "sdds to bulkio thread");
+	setThreadPriority(m_sddsToBulkIOThread, advanced_optimizations.sdds_to_bulkio_thread_priority, "sdds to bulkio thread");
+
+}
+
+/**
+ * Starts a thread running the provided socket reader on pktbuffer, setting its affinity and priority from the
+ * socket reader thread properties.
+ */
+void SourceSDDS_i::startSocketReaderThread(SocketReader &reader, PacketBuffer *pktbuffer, boost::thread *&thread) {
+	thread = new boost::thread(boost::bind(&RealTimeMode::run, boost::ref(m_realTime),
+			boost::function<void ()>(boost::bind(&SocketReader::run, boost::ref(reader), pktbuffer, advanced_optimizations.check_for_duplicate_sender))));
+	setSocketReaderThreadOptions(thread);
+}
+
+/**
+ * Sets the affinity and priority of thread from the socket reader thread properties.
+ */
+void SourceSDDS_i::setSocketReaderThreadOptions(boost::thread *thread) {
+	// Attempt to set the affinity of the socket reader thread if the user has told us to.
+	setThreadAffinity(thread, advanced_optimizations.socket_read_thread_affinity, m_socketReaderPlacement, m_autoSocketReaderCpu);
+
+	setThreadPriority(thread, advanced_optimizations.socket_read_thread_priority, "socket reader thread");
+}
+
+/**
+ * Sets the policy and priority of thread, SCHED_FIFO at the real time priority in real time mode and otherwise from
+ * priority as the thread priority properties say.
+ */
+void SourceSDDS_i::setThreadPriority(boost::thread *thread, CORBA::Long priority, const std::string &thread_desc) {
+	if (m_realTime.enabled()) {
+		m_realTime.setThreadPolicy(thread->native_handle(), thread_desc);
+	} else {
+		setPolicyAndPriority(thread->native_handle(), priority, thread_desc);
+	}
+}
+
+/**
+ * Binds thread as its affinity property says: to the CPUs given, to autoCpu for auto, and otherwise to the CPUs of the
+ * NIC's NUMA node if numa_placement found one. An auto affinity whose CPU could not be picked also falls back to the
+ * NUMA node. placement records how the thread was placed, see ThreadPlacement. Returns 0 on success.
+ */
+int SourceSDDS_i::setThreadAffinity(boost::thread *thread, const std::string &affinity, ThreadPlacement &placement, int autoCpu) {
+	if (affinity == "auto") {
+		placement = PLACEMENT_AUTO;
+	} else if (not affinity.empty() && placement == PLACEMENT_DEFAULT) {
+		placement = PLACEMENT_SET;
+	}
+
+	if (placement == PLACEMENT_SET) {
+		return setAffinity(thread->native_handle(), affinity);
+	}
+
+	if (placement == PLACEMENT_AUTO && autoCpu >= 0) {
+		cpu_set_t cpuset;
+		CPU_ZERO(&cpuset);
+		CPU_SET(autoCpu, &cpuset);
+		return setAffinity(thread->native_handle(), cpuset);
+	}
+
+	if (m_numaNode >= 0) {
+		if (placement != PLACEMENT_AUTO) {
+			placement = PLACEMENT_NUMA;
+		}
+		return setAffinity(thread->native_handle(), m_numaCpus);
+	}
+
+	if (placement != PLACEMENT_AUTO) {
+		placement = PLACEMENT_DEFAULT;
+	}
+	return 0;
+}
+
+/**
+ * How a thread is placed by a newly set affinity property.
+ */
+SourceSDDS_i::ThreadPlacement SourceSDDS_i::placementOf(const std::string &affinity) {
+	if (affinity == "auto") {
+		return PLACEMENT_AUTO;
+	}
+	return affinity.empty() ? PLACEMENT_DEFAULT : PLACEMENT_SET;
+}
+
+/**
+ * Starts the one thread which reads, processes and pushes when run to completion is set. The processor is readied
+ * here rather than on the thread so a stop straight after start cannot be missed.
+ */
+void SourceSDDS_i::startRunToCompletionThread() {
+	setupSddsToBulkIOOptions();
+	m_sddsToBulkIO.startShared(m_activePktbuffer);
+
+	m_socketReaderThread = new boost::thread(boost::bind(&RealTimeMode::run, boost::ref(m_realTime),
+			boost::function<void ()>(boost::bind(&SourceSDDS_i::runToCompletion, this, m_activePktbuffer, advanced_optimizations.check_for_duplicate_sender))));
+	setSocketReaderThreadOptions(m_socketReaderThread);
+	advanced_optimizations.socket_read_thread_affinity = getAffinity(m_socketReaderThread->native_handle());
+}
+
+/**
+ * The run to completion thread, every socket read is processed and pushed before the next.
+ */
+void SourceSDDS_i::runToCompletion(PacketBuffer *pktbuffer, bool confirmHosts) {
+	m_socketReader.runToCompletion(pktbuffer, confirmHosts, boost::bind(&SddsToBulkIOProcessor::processInline, boost::ref(m_sddsToBulkIO)));
 
+	// Push any remaining data and an EOS
+	m_sddsToBulkIO.stopShared();
 }
 
 /**
@@ -332,6 +850,7 @@ void SourceSDDS_i::_start() throw (CF::Resource::StartError) {
 void SourceSDDS_i::stop () throw (CF::Resource::StopError, CORBA::SystemException) {
 	LOG_DEBUG(SourceSDDS_i, "Stop Called cleaning up");
 	destroyBuffersAndJoinThreads();
+	stopAttachedStreams();
 	LOG_DEBUG(SourceSDDS_i, "Calling parent stop method");
 	SourceSDDS_base::stop();
 	LOG_DEBUG(SourceSDDS_i, "Finished stopping");
@@ -344,13 +863,36 @@ void SourceSDDS_i::stop () throw (CF::Resource::StopError, CORBA::SystemExceptio
  * @throws BadParameterError is thrown by the underlying setConnectionInfo call in the socketReader class for a number of reasons
  */
 void SourceSDDS_i::setupSocketReaderOptions() throw (BadParameterError) {
-	if (attachment_override.enabled) {
-		m_socketReader.setConnectionInfo(interface, attachment_override.ip_address, attachment_override.vlan, attachment_override.port);
-	} else {
-		m_socketReader.setConnectionInfo(interface, m_attach_stream.multicastAddress, m_attach_stream.vlan, m_attach_stream.port);
-	}
+	std::string ip = (attachment_override.enabled) ? attachment_override.ip_address : m_attach_stream.multicastAddress;
+	uint16_t vlan = (attachment_override.enabled) ? attachment_override.vlan : m_attach_stream.vlan;
+	uint16_t port = (attachment_override.enabled) ? attachment_override.port : m_attach_stream.port;
+	size_t num_readers = advanced_optimizations.num_socket_readers;
+
+	m_socketReader.setReaderShare(0, num_readers);
+	m_socketReader.setConnectionInfo(interface, ip, vlan, port);
 	m_socketReader.setPktsPerRead(advanced_optimizations.pkts_per_socket_read);
+	m_socketReader.setAutoTune(advanced_optimizations.auto_tune);
+	m_socketReader.setPktsPerReadBounds(advanced_optimizations.min_pkts_per_socket_read, advanced_optimizations.max_pkts_per_socket_read);
+	m_socketReader.setReclaimSize(advanced_optimizations.sdds_pkts_per_bulkio_push);
 	status.interface = m_socketReader.getInterface();
+
+	// The extra readers copy their options from the first, they must open their sockets in order after it.
+	for (size_t i = 1; i < num_readers; ++i) {
+		SocketReader *reader = new SocketReader();
+		m_extraSocketReaders.push_back(reader);
+		reader->setPktsPerRead(m_socketReader.getPktsPerRead());
+		reader->setAutoTune(advanced_optimizations.auto_tune);
+		reader->setPktsPerReadBounds(advanced_optimizations.min_pkts_per_socket_read, advanced_optimizations.max_pkts_per_socket_read);
+		reader->setSocketBufferSize(advanced_optimizations.udp_socket_buffer_size);
+		reader->setReceiveBackend(m_socketReader.getReceiveBackend());
+		reader->setWaitPolicy(m_socketReader.getWaitPolicy());
+		reader->setSpinTime(m_socketReader.getSpinTime());
+		reader->setBusyPollTime(m_socketReader.getBusyPollTime());
+		reader->setUdpGro(m_socketReader.getUdpGro());
+		reader->setOverflowPolicy(m_socketReader.getOverflowPolicy());
+		reader->setReaderShare(i, num_readers);
+		reader->setConnectionInfo(interface, ip, vlan, port);
+	}
 }
 
 /**
@@ -359,6 +901,7 @@ void SourceSDDS_i::setupSocketReaderOptions() throw (BadParameterError) {
  * rate is retrieved directly from the SDDS header or from the provided SRI if the proper keywords
  * are used. (See the relevant documentation for details) If the component had been started and running
  * from an attachment_override value then the componet will stop, setup the new stream, and restart.
+ * Once a stream is attached any further attach is handled by attachStream.
  *
  * @param stream A struct containing the stream definition including network parameters and stream ID. Note that the sample rate is NOT USED!
  * @param userid Used only to log who has made the attach called. This value is not used for anything other than logging.
@@ -368,20 +911,29 @@ void SourceSDDS_i::setupSocketReaderOptions() throw (BadParameterError) {
 char* SourceSDDS_i::attach(const BULKIO::SDDSStreamDefinition& stream, const char* userid) throw (BULKIO::dataSDDS::AttachError, BULKIO::dataSDDS::StreamInputError) {
 	LOG_INFO(SourceSDDS_i, "Attach called by: " << userid);
 	if (m_attach_stream.attached) {
-		LOG_ERROR(SourceSDDS_i, "Can only handle a single attach. Detach current stream: " << m_attach_stream.id);
-		throw BULKIO::dataSDDS::AttachError("Can only handle a single attach. Detach current stream first");
+		return attachStream(stream);
+	}
+
+	std::string id(stream.id);
+	if (id.empty()) {
+		id = ossie::generateUUID();
+	}
+
+	// Streams attached after this one may still be attached after it was detached
+	{
+		boost::mutex::scoped_lock lock(m_attachedStreamsLock);
+		if (attachIdInUse(id)) {
+			LOG_ERROR(SourceSDDS_i, "A stream is already attached with the attach ID: " << id);
+			throw BULKIO::dataSDDS::AttachError("A stream is already attached with this attach ID");
+		}
 	}
 
 	m_attach_stream.attached = true;
-	m_attach_stream.id = stream.id;
+	m_attach_stream.id = id;
 	m_attach_stream.multicastAddress = stream.multicastAddress;
 	m_attach_stream.port = stream.port;
 	m_attach_stream.vlan = stream.vlan;
 
-	if (m_attach_stream.id.empty() || m_attach_stream.id == "") {
-		m_attach_stream.id = ossie::generateUUID();
-	}
-
 	if (started() && !attachment_override.enabled) {
 		LOG_INFO(SourceSDDS_i, "Attempting to start SourceSDDS processing with provided attach values.");
 		try {
@@ -398,36 +950,108 @@ char* SourceSDDS_i::attach(const BULKIO::SDDSStreamDefinition& stream, const cha
 	return CORBA::string_dup(m_attach_stream.id.c_str());
 }
 
+/**
+ * Attaches a stream after the first, up to max_attached_streams in all. The stream gets its own packet buffer,
+ * socket reader and SDDS to BulkIO processor and is started straight away if the component is running.
+ *
+ * @return The attachId, the supplied Stream ID or a unique identifier if no stream ID is provided.
+ * @throws AttachError If there are already max_attached_streams attached, the attach ID is in use or the stream could not be started.
+ */
+char* SourceSDDS_i::attachStream(const BULKIO::SDDSStreamDefinition& stream) throw (BULKIO::dataSDDS::AttachError) {
+	boost::mutex::scoped_lock lock(m_attachedStreamsLock);
+
+	if (advanced_optimizations.max_attached_streams <= 1) {
+		LOG_ERROR(SourceSDDS_i, "Can only handle a single attach. Detach current stream: " << m_attach_stream.id);
+		throw BULKIO::dataSDDS::AttachError("Can only handle a single attach. Detach current stream first");
+	}
+
+	if (1 + m_attachedStreams.size() >= advanced_optimizations.max_attached_streams) {
+		LOG_ERROR(SourceSDDS_i, "Can only handle " << advanced_optimizations.max_attached_streams << " attached streams. Detach a stream first");
+		throw BULKIO::dataSDDS::AttachError("Already attached to max_attached_streams streams. Detach a stream first");
+	}
+
+	std::string id(stream.id);
+	if (id.empty()) {
+		id = ossie::generateUUID();
+	}
+
+	if (attachIdInUse(id)) {
+		LOG_ERROR(SourceSDDS_i, "A stream is already attached with the attach ID: " << id);
+		throw BULKIO::dataSDDS::AttachError("A stream is already attached with this attach ID");
+	}
+
+	std::auto_ptr<AttachedStream> attached(new AttachedStream(stream, id, dataOctetOut, dataShortOut, dataFloatOut));
+	if (started()) {
+		try {
+			m_streamWorkers.start(advanced_optimizations.stream_worker_threads);
+			warnFirstStreamOnlyOptions();
+			attached->start(&m_streamWorkers, interface, advanced_optimizations, advanced_configuration, getNumaNode(interface));
+		} catch (BadParameterError &e) {
+			std::stringstream errorText;
+			errorText << "Failed to start the attached stream, attach has failed with the error: " << e.what();
+			LOG_ERROR(SourceSDDS_i, errorText.str());
+			throw BULKIO::dataSDDS::AttachError(errorText.str().c_str());
+		}
+	}
+
+	LOG_INFO(SourceSDDS_i, "Attached stream " << id << ", " << m_attachedStreams.size() + 2 << " streams are now attached");
+	m_attachedStreams.push_back(attached.release());
+	return CORBA::string_dup(id.c_str());
+}
+
+/**
+ * Returns true if a stream is attached with the attach ID id, either the first stream or one attached after it.
+ * m_attachedStreamsLock must be held.
+ */
+bool SourceSDDS_i::attachIdInUse(const std::string &id) {
+	if (m_attach_stream.attached && id == m_attach_stream.id) {
+		return true;
+	}
+	for (size_t i = 0; i < m_attachedStreams.size(); ++i) {
+		if (id == m_attachedStreams[i].id) {
+			return true;
+		}
+	}
+	return false;
+}
+
 /**
  * Required method by the Attach Detach Callback API. Used to remove an attached SDDS stream.
  * Throws a detach error if there is no stream which matches the attachId given.
- * If the component is running during a valid detach, the component will stop, detach, and attempt to
- * restart. The detach call will also have affect of unsetting any upstream SRI from the SDDS to
- * BulkIO class.
+ * If the component is running during a valid detach, the processing of the stream is stopped before it is
+ * detached, any other attached streams carry on. Detaching the first stream will also have affect of
+ * unsetting any upstream SRI from the SDDS to BulkIO class.
  *
  * @param attachId The unique attach ID which was returned during the matching attach call.
  * @throws DetachError If detach is called on a stream that is not currently attached / active.
  */
 void SourceSDDS_i::detach(const char* attachId) {
 
+	{
+		boost::mutex::scoped_lock lock(m_attachedStreamsLock);
+		for (size_t i = 0; i < m_attachedStreams.size(); ++i) {
+			if (m_attachedStreams[i].id == attachId) {
+				LOG_INFO(SourceSDDS_i, "Detaching stream " << attachId);
+				// Stops the stream as it is destroyed
+				m_attachedStreams.erase(m_attachedStreams.begin() + i);
+				return;
+			}
+		}
+	}
+
 	if (attachId != m_attach_stream.id) {
 		LOG_ERROR(SourceSDDS_i, "ATTACHMENT ID (STREAM ID) NOT FOUND FOR: " << attachId);
 		throw BULKIO::dataSDDS::DetachError("Detach called on stream not currently running");
 	}
 
-	bool restart = false;
+	// The other attached streams carry on, so only the threads of this one are stopped
 	if (started() && !attachment_override.enabled) {
-		LOG_WARN(SourceSDDS_i, "Cannot remove in-use connection via detach when already running, will stop, detach, and restart");
-		restart = true;
-		stop();
+		LOG_WARN(SourceSDDS_i, "Cannot remove in-use connection via detach when already running, will stop its processing and detach");
+		destroyBuffersAndJoinThreads();
 	}
 
 	m_sddsToBulkIO.unsetUpstreamSri();
 	m_attach_stream.attached = false;
-
-	if (restart) {
-		start();
-	}
 }
 
 /**
@@ -438,6 +1062,9 @@ void SourceSDDS_i::detach(const char* attachId) {
 void SourceSDDS_i::setupSddsToBulkIOOptions() {
 	m_sddsToBulkIO.setPktsPerRead(advanced_optimizations.sdds_pkts_per_bulkio_push);
 	advanced_optimizations.sdds_pkts_per_bulkio_push = m_sddsToBulkIO.getPktsPerRead();
+	m_sddsToBulkIO.setAutoTune(advanced_optimizations.auto_tune);
+	m_sddsToBulkIO.setPktsPerReadBounds(advanced_optimizations.min_sdds_pkts_per_bulkio_push, advanced_optimizations.max_sdds_pkts_per_bulkio_push);
+	m_sddsToBulkIO.setConversionThreads(advanced_optimizations.conversion_threads);
 
 	m_sddsToBulkIO.setPushOnTTV(advanced_configuration.push_on_ttv);
 	m_sddsToBulkIO.setWaitForTTV(advanced_configuration.wait_on_ttv);
@@ -446,6 +1073,68 @@ void SourceSDDS_i::setupSddsToBulkIOOptions() {
 	}
 }
 
+/**
+ * Starts the streams attached after the first, and the stream worker threads which process them. A stream which
+ * fails to start is logged and left stopped, the others still start.
+ */
+void SourceSDDS_i::startAttachedStreams() {
+	boost::mutex::scoped_lock lock(m_attachedStreamsLock);
+	if (m_attachedStreams.empty()) {
+		return;
+	}
+
+	m_streamWorkers.start(advanced_optimizations.stream_worker_threads);
+	warnFirstStreamOnlyOptions();
+	int numaNode = getNumaNode(interface);
+	for (size_t i = 0; i < m_attachedStreams.size(); ++i) {
+		try {
+			m_attachedStreams[i].start(&m_streamWorkers, interface, advanced_optimizations, advanced_configuration, numaNode);
+		} catch (BadParameterError &e) {
+			LOG_ERROR(SourceSDDS_i, "Failed to start attached stream " << m_attachedStreams[i].id << ": " << e.what());
+		}
+	}
+}
+
+/**
+ * Logs a warning for each option set which only applies to the first stream. The streams attached after it are read
+ * with recvmmsg by the shared reader engine, which waits in epoll, and are converted on the stream workers with a
+ * fixed push size and in the endianness their SRI gives.
+ */
+void SourceSDDS_i::warnFirstStreamOnlyOptions() {
+	if (m_socketReader.getReceiveBackend() != "recvmmsg") {
+		LOG_WARN(SourceSDDS_i, "receive_backend " << m_socketReader.getReceiveBackend() << " only applies to the first stream, the streams attached after it are read with recvmmsg");
+	}
+	if (m_socketReader.getWaitPolicy() != "adaptive") {
+		LOG_WARN(SourceSDDS_i, "wait_policy " << m_socketReader.getWaitPolicy() << " only applies to the first stream, the shared reader engine waits in epoll for the streams attached after it");
+	}
+	if (m_socketReader.getUdpGro()) {
+		LOG_WARN(SourceSDDS_i, "udp_gro only applies to the first stream, it is not enabled on the sockets of the streams attached after it");
+	}
+	if (advanced_optimizations.auto_tune) {
+		LOG_WARN(SourceSDDS_i, "auto_tune only applies to the first stream, the streams attached after it use pkts_per_socket_read and sdds_pkts_per_bulkio_push as set");
+	}
+	if (advanced_optimizations.conversion_threads > 0) {
+		LOG_WARN(SourceSDDS_i, "conversion_threads only applies to the first stream, the streams attached after it are converted on the stream worker threads");
+	}
+	if (advanced_optimizations.real_time_mode) {
+		LOG_WARN(SourceSDDS_i, "real_time_mode only applies while the first stream is running, the streams attached after it do not enable it");
+	}
+	if (attachment_override.enabled) {
+		LOG_WARN(SourceSDDS_i, "The attachment_override endianness only applies to the first stream, the streams attached after it are big endian unless their SRI sets dataRef");
+	}
+}
+
+/**
+ * Stops the streams attached after the first, pushing an EOS for each, then the stream worker threads.
+ */
+void SourceSDDS_i::stopAttachedStreams() {
+	boost::mutex::scoped_lock lock(m_attachedStreamsLock);
+	for (size_t i = 0; i < m_attachedStreams.size(); ++i) {
+		m_attachedStreams[i].stop();
+	}
+	m_streamWorkers.stop();
+}
+
 /**
  * Not used.
  */
@@ -465,11 +1154,19 @@ void SourceSDDS_i::destroyBuffersAndJoinThreads() {
 	// at the end.  It shouldn't hurt...right?
 	LOG_DEBUG(SourceSDDS_i, "Shutting down the socket reader thread");
 	m_socketReader.shutDown();
+	for (size_t i = 0; i < m_extraSocketReaders.size(); ++i) {
+		m_extraSocketReaders[i].shutDown();
+	}
+	if (m_sharedReader) {
+		LOG_DEBUG(SourceSDDS_i, "Removing the socket reader from the shared reader engine");
+		SharedReaderEngine::instance().detach(&m_socketReader);
+		m_sharedReader = false;
+	}
 	LOG_DEBUG(SourceSDDS_i, "Shutting down the sdds to bulkio thread");
 	m_sddsToBulkIO.shutDown();
 
 	LOG_DEBUG(SourceSDDS_i, "Destroying the existing packet buffers");
-	m_pktbuffer.shutDown();
+	m_activePktbuffer->shutDown();
 
 	// Delete the socket reader and sddsToBulkIO thread if it already exists
 	if (m_socketReaderThread) {
@@ -479,6 +1176,17 @@ void SourceSDDS_i::destroyBuffersAndJoinThreads() {
 		m_socketReaderThread = NULL;
 	}
 
+	for (size_t i = 0; i < m_extraSocketReaderThreads.size(); ++i) {
+		if (m_extraSocketReaderThreads[i]) {
+			m_extraSocketReaderThreads[i]->join();
+			delete m_extraSocketReaderThreads[i];
+		}
+	}
+	m_extraSocketReaderThreads.clear();
+
+	// Closes any socket a reader which never ran still holds
+	m_extraSocketReaders.clear();
+
 	if (m_sddsToBulkIOThread) {
 		LOG_DEBUG(SourceSDDS_i, "Joining the sdds to bulkio thread");
 		m_sddsToBulkIOThread->join();
@@ -22,8 +22,14 @@
 
 #include "SourceSDDS_base.h"
 #include "SmartPacketBuffer.h"
+#include "LockFreePacketBuffer.h"
+#include "MergePacketBuffer.h"
 #include "SocketReader.h"
+#include "SharedReaderEngine.h"
 #include "SddsToBulkIOProcessor.h"
+#include "StreamWorkerPool.h"
+#include "AttachedStream.h"
+#include "RealTimeMode.h"
 #include "socketUtils/SourceNicUtils.h"
 #include <uuid/uuid.h>
 #define NOT_SET 3
@@ -43,22 +49,79 @@ class SourceSDDS_i : public SourceSDDS_base, public bulkio::InSDDSPort::Callback
 		void detach(const char* attachId);
 		void newSriListener(const BULKIO::StreamSRI & newSri);
     private:
-        SmartPacketBuffer<SDDSpacket> m_pktbuffer;
+        SmartPacketBuffer m_pktbuffer;
+        LockFreePacketBuffer m_lockFreePktbuffer;
+        MergePacketBuffer m_mergePktbuffer;
+        PacketBuffer *m_activePktbuffer;
 
         boost::thread *m_socketReaderThread;
         boost::thread *m_sddsToBulkIOThread;
 
         SocketReader m_socketReader;
+
+        // The socket readers after the first when num_socket_readers is more than one
+        boost::ptr_vector<SocketReader> m_extraSocketReaders;
+        std::vector<boost::thread*> m_extraSocketReaderThreads;
+
+        // Set while m_socketReader is read by the shared reader engine in place of m_socketReaderThread
+        bool m_sharedReader;
+
+        // How a thread's affinity property came about. Once a thread is placed by auto or NUMA placement its property
+        // reports the CPUs picked, and is placed the same way again on the next start rather than taken as set.
+        enum ThreadPlacement {
+            PLACEMENT_DEFAULT,
+            PLACEMENT_SET,
+            PLACEMENT_NUMA,
+            PLACEMENT_AUTO
+        };
+
+        // The NUMA node of the NIC and the node placed on with its CPUs, -1 if none, see numa_placement
+        int m_nicNumaNode;
+        int m_numaNode;
+        cpu_set_t m_numaCpus;
+
+        // The CPUs picked from the NIC's interrupt affinity for an auto affinity, -1 if none
+        int m_autoSocketReaderCpu;
+        int m_autoSddsToBulkIOCpu;
+        ThreadPlacement m_socketReaderPlacement;
+        ThreadPlacement m_sddsToBulkIOPlacement;
         SddsToBulkIOProcessor m_sddsToBulkIO;
+
+        // Applies real_time_mode, every thread the component starts for its first stream runs through it
+        RealTimeMode m_realTime;
+
+        // How long the last _start took, see status start_latency
+        uint64_t m_startLatency;
+
+        // The streams attached after the first, see max_attached_streams. The pool must outlive them.
+        StreamWorkerPool m_streamWorkers;
+        boost::ptr_vector<AttachedStream> m_attachedStreams;
+        boost::mutex m_attachedStreamsLock;
+
         void setupSocketReaderOptions() throw (BadParameterError);
+        void startSocketReaderThread(SocketReader &reader, PacketBuffer *pktbuffer, boost::thread *&thread);
+        void setSocketReaderThreadOptions(boost::thread *thread);
+        void setThreadPriority(boost::thread *thread, CORBA::Long priority, const std::string &thread_desc);
+        int setThreadAffinity(boost::thread *thread, const std::string &affinity, ThreadPlacement &placement, int autoCpu);
+        static ThreadPlacement placementOf(const std::string &affinity);
+        void startRunToCompletionThread();
+        void runToCompletion(PacketBuffer *pktbuffer, bool confirmHosts);
         void setupSddsToBulkIOOptions();
         void destroyBuffersAndJoinThreads();
         struct advanced_configuration_struct get_advanced_configuration_struct();
         struct advanced_optimizations_struct get_advanced_optimizations_struct();
         struct status_struct get_status_struct();
+        std::vector<stream_status_entry_struct> get_stream_status();
+        std::string formatBufferCount(size_t num, size_t total);
+        void startAttachedStreams();
+        void warnFirstStreamOnlyOptions();
+        void stopAttachedStreams();
+        char* attachStream(const BULKIO::SDDSStreamDefinition& stream) throw (BULKIO::dataSDDS::AttachError);
+        bool attachIdInUse(const std::string &id);
         void set_advanced_configuration_struct(struct advanced_configuration_struct request);
         void set_advanced_optimization_struct(struct advanced_optimizations_struct request);
         void _start() throw (CF::Resource::StartError);
+        void startProcessing() throw (CF::Resource::StartError);
         struct attach_stream {
             std::string id;
             std::string multicastAddress;
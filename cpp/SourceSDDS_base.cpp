@@ -134,6 +134,14 @@ void SourceSDDS_base::loadProperties()
                 "external",
                 "property");
 
+    addProperty(stream_status,
+                "stream_status",
+                "",
+                "readonly",
+                "",
+                "external",
+                "property");
+
 }
 
 
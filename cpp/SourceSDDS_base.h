@@ -53,6 +53,8 @@ class SourceSDDS_base : public Component, protected ThreadedComponent
         advanced_configuration_struct advanced_configuration;
         /// Property: status
         status_struct status;
+        /// Property: stream_status
+        std::vector<stream_status_entry_struct> stream_status;
 
         // Ports
         /// Port: dataSddsIn
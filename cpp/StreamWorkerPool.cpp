@@ -0,0 +1,202 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * StreamWorkerPool.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#include "StreamWorkerPool.h"
+#include <algorithm>
+
+PREPARE_LOGGING(StreamWorkerPool)
+
+StreamWorkerPool::StreamWorkerPool(): m_next_worker(0), m_stopping(false) {
+}
+
+StreamWorkerPool::~StreamWorkerPool() {
+	stop();
+}
+
+/**
+ * Starts num_workers worker threads, at least one. Does nothing if the pool is already running.
+ */
+void StreamWorkerPool::start(size_t num_workers) {
+	boost::mutex::scoped_lock lock(m_lock);
+	if (not m_threads.empty()) {
+		return;
+	}
+
+	num_workers = std::max(num_workers, (size_t) 1);
+	m_stopping = false;
+	m_queues.resize(num_workers);
+	for (size_t i = 0; i < num_workers; ++i) {
+		m_threads.push_back(new boost::thread(boost::bind(&StreamWorkerPool::run, this, i)));
+	}
+	LOG_DEBUG(StreamWorkerPool, "Started " << num_workers << " stream worker threads");
+}
+
+/**
+ * Stops and joins the worker threads. Any task still queued is dropped from its queue, tasks should be removed first.
+ */
+void StreamWorkerPool::stop() {
+	{
+		boost::mutex::scoped_lock lock(m_lock);
+		m_stopping = true;
+		m_task_queued.notify_all();
+	}
+
+	for (size_t i = 0; i < m_threads.size(); ++i) {
+		m_threads[i]->join();
+		delete m_threads[i];
+	}
+	m_threads.clear();
+
+	boost::mutex::scoped_lock lock(m_lock);
+	for (size_t i = 0; i < m_queues.size(); ++i) {
+		for (size_t j = 0; j < m_queues[i].size(); ++j) {
+			m_queues[i][j]->m_state = TASK_REMOVED;
+		}
+	}
+	m_queues.clear();
+}
+
+/**
+ * Adds task to the pool, it is given a home worker in turn but is not run until it is scheduled.
+ */
+void StreamWorkerPool::add(Task *task) {
+	boost::mutex::scoped_lock lock(m_lock);
+	task->m_state = TASK_IDLE;
+	task->m_worker = (m_queues.empty()) ? 0 : m_next_worker++ % m_queues.size();
+}
+
+/**
+ * Queues task to be run if it is not queued already. May be called from any thread, a task scheduled while it runs
+ * is run again straight after.
+ */
+void StreamWorkerPool::schedule(Task *task) {
+	boost::mutex::scoped_lock lock(m_lock);
+	switch (task->m_state) {
+	case TASK_IDLE:
+		if (m_queues.empty()) {
+			return;
+		}
+		task->m_state = TASK_QUEUED;
+		m_queues[task->m_worker].push_back(task);
+		m_task_queued.notify_one();
+		break;
+	case TASK_RUNNING:
+		task->m_state = TASK_RERUN;
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * Takes task out of the pool. If a worker is running it this waits for it to finish, once this returns the pool no
+ * longer touches the task.
+ */
+void StreamWorkerPool::remove(Task *task) {
+	boost::mutex::scoped_lock lock(m_lock);
+	switch (task->m_state) {
+	case TASK_QUEUED: {
+		std::deque<Task*> &queue = m_queues[task->m_worker];
+		queue.erase(std::remove(queue.begin(), queue.end(), task), queue.end());
+		task->m_state = TASK_REMOVED;
+		break;
+	}
+	case TASK_RUNNING:
+	case TASK_RERUN:
+		task->m_state = TASK_REMOVING;
+		while (task->m_state != TASK_REMOVED) {
+			m_task_done.wait(lock);
+		}
+		break;
+	default:
+		task->m_state = TASK_REMOVED;
+		break;
+	}
+}
+
+size_t StreamWorkerPool::getNumWorkers() {
+	boost::mutex::scoped_lock lock(m_lock);
+	return m_threads.size();
+}
+
+/**
+ * Returns the next task for worker, the oldest from its own queue or else the newest from another, or NULL if every
+ * queue is empty. Must be called with m_lock held.
+ */
+StreamWorkerPool::Task* StreamWorkerPool::takeTask(size_t worker) {
+	Task *task = NULL;
+	if (not m_queues[worker].empty()) {
+		task = m_queues[worker].front();
+		m_queues[worker].pop_front();
+		return task;
+	}
+
+	for (size_t i = 1; i < m_queues.size(); ++i) {
+		std::deque<Task*> &victim = m_queues[(worker + i) % m_queues.size()];
+		if (not victim.empty()) {
+			task = victim.back();
+			victim.pop_back();
+			return task;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * The worker thread, runs tasks until stop is called.
+ */
+void StreamWorkerPool::run(size_t worker) {
+	pthread_setname_np(pthread_self(), "StreamWorker");
+	boost::mutex::scoped_lock lock(m_lock);
+
+	while (not m_stopping) {
+		Task *task = takeTask(worker);
+		if (not task) {
+			m_task_queued.wait(lock);
+			continue;
+		}
+
+		task->m_state = TASK_RUNNING;
+		task->m_worker = worker;
+		lock.unlock();
+		bool more = task->runTask();
+		lock.lock();
+
+		if (task->m_state == TASK_REMOVING) {
+			task->m_state = TASK_REMOVED;
+			m_task_done.notify_all();
+		} else if (more or task->m_state == TASK_RERUN) {
+			task->m_state = TASK_QUEUED;
+			m_queues[worker].push_back(task);
+			// Let an idle worker steal whatever is behind it
+			if (m_queues[worker].size() > 1) {
+				m_task_queued.notify_one();
+			}
+		} else {
+			task->m_state = TASK_IDLE;
+		}
+	}
+}
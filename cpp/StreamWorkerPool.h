@@ -0,0 +1,99 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * StreamWorkerPool.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#ifndef STREAMWORKERPOOL_H_
+#define STREAMWORKERPOOL_H_
+
+#include <deque>
+#include <vector>
+#include <boost/thread.hpp>
+#include "ossie/debug.h"
+
+/**
+ * A fixed number of worker threads shared by the SDDS to BulkIO processing of many attached streams, in place of a
+ * thread per stream. A stream is a task which is scheduled whenever it may have work, it is never queued more than
+ * once and never run by two workers at the same time.
+ *
+ * Each worker has its own queue of tasks which it runs in order, a task with more work left after its turn goes to the
+ * back of the queue of the worker which ran it. A worker with an empty queue steals the newest task from the back of
+ * another worker's queue, which then stays with the thief, so the streams spread themselves over the workers.
+ */
+class StreamWorkerPool {
+	ENABLE_LOGGING
+public:
+	class Task {
+	public:
+		Task(): m_state(TASK_IDLE), m_worker(0) {}
+		virtual ~Task() {}
+
+		/**
+		 * Does a bounded amount of work. Returns true if there is more waiting, the task is then run again after
+		 * the other queued tasks have had their turn.
+		 */
+		virtual bool runTask() = 0;
+
+	private:
+		friend class StreamWorkerPool;
+		int m_state;
+		size_t m_worker;
+	};
+
+	StreamWorkerPool();
+	virtual ~StreamWorkerPool();
+
+	void start(size_t num_workers);
+	void stop();
+	void add(Task *task);
+	void schedule(Task *task);
+	void remove(Task *task);
+	size_t getNumWorkers();
+
+private:
+	enum TaskState {
+		TASK_IDLE,		// Waiting to be scheduled
+		TASK_QUEUED,	// On a worker queue
+		TASK_RUNNING,	// Being run by a worker
+		TASK_RERUN,		// Being run by a worker and scheduled again meanwhile
+		TASK_REMOVING,	// Being run by a worker and to be removed once it is done
+		TASK_REMOVED	// Not part of the pool
+	};
+
+	StreamWorkerPool(const StreamWorkerPool&);              // Disabled copy constructor
+	StreamWorkerPool& operator = (const StreamWorkerPool&); // Disabled assign operator
+
+	Task* takeTask(size_t worker);
+	void run(size_t worker);
+
+	boost::mutex m_lock;
+	boost::condition_variable m_task_queued;
+	boost::condition_variable m_task_done;
+	std::vector<std::deque<Task*> > m_queues;
+	std::vector<boost::thread*> m_threads;
+	size_t m_next_worker;
+	bool m_stopping;
+};
+
+#endif /* STREAMWORKERPOOL_H_ */
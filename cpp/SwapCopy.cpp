@@ -0,0 +1,243 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * SwapCopy.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#include "SwapCopy.h"
+#include <string.h>
+
+// The vector kernels are compiled for their instruction sets with target attributes so the rest of the build is not,
+// which needs the intrinsics to be usable without the matching -m flags: gcc 4.9 on, and gcc 5 on for AVX-512BW.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define SWAP_COPY_X86
+#include <cpuid.h>
+#include <immintrin.h>
+#if __GNUC__ >= 5
+#define SWAP_COPY_AVX512
+#endif
+#endif
+
+struct SwapKernel {
+	const char *name;
+	SwapCopyFunction swap16;
+	SwapCopyFunction swap32;
+};
+
+/**
+ * Copies the bytes after the last whole sample, or samples which need no swapping, as they are.
+ */
+static void copyTail(uint8_t *dst, const uint8_t *src, size_t len) {
+	if (dst != src) {
+		memcpy(dst, src, len);
+	}
+}
+
+static void swap16Scalar(uint8_t *dst, const uint8_t *src, size_t len) {
+	size_t i = 0;
+	for (; i + sizeof(uint16_t) <= len; i += sizeof(uint16_t)) {
+		uint16_t v;
+		memcpy(&v, src + i, sizeof(v));
+		v = __builtin_bswap16(v);
+		memcpy(dst + i, &v, sizeof(v));
+	}
+	copyTail(dst + i, src + i, len - i);
+}
+
+static void swap32Scalar(uint8_t *dst, const uint8_t *src, size_t len) {
+	size_t i = 0;
+	for (; i + sizeof(uint32_t) <= len; i += sizeof(uint32_t)) {
+		uint32_t v;
+		memcpy(&v, src + i, sizeof(v));
+		v = __builtin_bswap32(v);
+		memcpy(dst + i, &v, sizeof(v));
+	}
+	copyTail(dst + i, src + i, len - i);
+}
+
+#ifdef SWAP_COPY_X86
+
+// Without pshufb SSE2 swaps the bytes of each 16 bit word with shifts, and for 32 bits first swaps the words
+__attribute__((target("sse2")))
+static void swap16Sse2(uint8_t *dst, const uint8_t *src, size_t len) {
+	size_t i = 0;
+	for (; i + sizeof(__m128i) <= len; i += sizeof(__m128i)) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+	}
+	swap16Scalar(dst + i, src + i, len - i);
+}
+
+__attribute__((target("sse2")))
+static void swap32Sse2(uint8_t *dst, const uint8_t *src, size_t len) {
+	size_t i = 0;
+	for (; i + sizeof(__m128i) <= len; i += sizeof(__m128i)) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xB1), 0xB1);
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+	}
+	swap32Scalar(dst + i, src + i, len - i);
+}
+
+// The byte shuffles reversing each 16 and 32 bit sample of a 128 bit lane, the wider kernels repeat them per lane
+#define SWAP16_SHUFFLE 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14
+#define SWAP32_SHUFFLE 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+
+__attribute__((target("ssse3")))
+static inline void shuffleSsse3(uint8_t *dst, const uint8_t *src, size_t len, __m128i mask, SwapCopyFunction tail) {
+	size_t i = 0;
+	for (; i + sizeof(__m128i) <= len; i += sizeof(__m128i)) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(v, mask));
+	}
+	tail(dst + i, src + i, len - i);
+}
+
+__attribute__((target("ssse3")))
+static void swap16Ssse3(uint8_t *dst, const uint8_t *src, size_t len) {
+	shuffleSsse3(dst, src, len, _mm_setr_epi8(SWAP16_SHUFFLE), swap16Scalar);
+}
+
+__attribute__((target("ssse3")))
+static void swap32Ssse3(uint8_t *dst, const uint8_t *src, size_t len) {
+	shuffleSsse3(dst, src, len, _mm_setr_epi8(SWAP32_SHUFFLE), swap32Scalar);
+}
+
+__attribute__((target("avx2")))
+static inline void shuffleAvx2(uint8_t *dst, const uint8_t *src, size_t len, __m256i mask, SwapCopyFunction tail) {
+	size_t i = 0;
+	for (; i + 2 * sizeof(__m256i) <= len; i += 2 * sizeof(__m256i)) {
+		__m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+		__m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + sizeof(__m256i)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(v0, mask));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + sizeof(__m256i)), _mm256_shuffle_epi8(v1, mask));
+	}
+	tail(dst + i, src + i, len - i);
+}
+
+__attribute__((target("avx2")))
+static void swap16Avx2(uint8_t *dst, const uint8_t *src, size_t len) {
+	shuffleAvx2(dst, src, len, _mm256_setr_epi8(SWAP16_SHUFFLE, SWAP16_SHUFFLE), swap16Scalar);
+}
+
+__attribute__((target("avx2")))
+static void swap32Avx2(uint8_t *dst, const uint8_t *src, size_t len) {
+	shuffleAvx2(dst, src, len, _mm256_setr_epi8(SWAP32_SHUFFLE, SWAP32_SHUFFLE), swap32Scalar);
+}
+
+#ifdef SWAP_COPY_AVX512
+// The same shuffles as 32 bit words, set4 is the one way of building them every gcc with AVX-512BW has
+__attribute__((target("avx512f,avx512bw")))
+static inline void shuffleAvx512(uint8_t *dst, const uint8_t *src, size_t len, __m512i mask, SwapCopyFunction tail) {
+	size_t i = 0;
+	for (; i + sizeof(__m512i) <= len; i += sizeof(__m512i)) {
+		__m512i v = _mm512_loadu_si512(src + i);
+		_mm512_storeu_si512(dst + i, _mm512_shuffle_epi8(v, mask));
+	}
+	tail(dst + i, src + i, len - i);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void swap16Avx512(uint8_t *dst, const uint8_t *src, size_t len) {
+	shuffleAvx512(dst, src, len, _mm512_set4_epi32(0x0E0F0C0D, 0x0A0B0809, 0x06070405, 0x02030001), swap16Scalar);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void swap32Avx512(uint8_t *dst, const uint8_t *src, size_t len) {
+	shuffleAvx512(dst, src, len, _mm512_set4_epi32(0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203), swap32Scalar);
+}
+#endif
+
+/**
+ * True if the OS saves every register state in mask (XCR0 bits) across context switches, without which the AVX
+ * registers can not be used even if cpuid says the CPU has them.
+ */
+static bool osSavesState(uint32_t mask) {
+	uint32_t eax, edx;
+	__asm__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+	return (eax & mask) == mask;
+}
+
+#endif /* SWAP_COPY_X86 */
+
+/**
+ * Picks the widest kernel the CPU and the OS support.
+ */
+static SwapKernel pickKernel() {
+	SwapKernel kernel = {"scalar", swap16Scalar, swap32Scalar};
+
+#ifdef SWAP_COPY_X86
+	unsigned int eax, ebx, ecx, edx;
+	if (not __get_cpuid(1, &eax, &ebx, &ecx, &edx) or not (edx & bit_SSE2)) {
+		return kernel;
+	}
+	SwapKernel sse2 = {"sse2", swap16Sse2, swap32Sse2};
+	kernel = sse2;
+	if (not (ecx & bit_SSSE3)) {
+		return kernel;
+	}
+	SwapKernel ssse3 = {"ssse3", swap16Ssse3, swap32Ssse3};
+	kernel = ssse3;
+
+	// YMM state for AVX2, and the opmask and ZMM state as well for AVX-512
+	bool avx = (ecx & bit_OSXSAVE) and (ecx & bit_AVX) and osSavesState(0x6);
+	if (not avx or __get_cpuid_max(0, NULL) < 7) {
+		return kernel;
+	}
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+	if (ebx & bit_AVX2) {
+		SwapKernel avx2 = {"avx2", swap16Avx2, swap32Avx2};
+		kernel = avx2;
+	}
+#ifdef SWAP_COPY_AVX512
+	if ((ebx & bit_AVX512F) and (ebx & bit_AVX512BW) and osSavesState(0xE6)) {
+		SwapKernel avx512 = {"avx512", swap16Avx512, swap32Avx512};
+		kernel = avx512;
+	}
+#endif
+#endif
+	return kernel;
+}
+
+static const SwapKernel s_kernel = pickKernel();
+
+void swapCopy(unsigned short bps, uint8_t *dst, const uint8_t *src, size_t len) {
+	swapCopyFunction(bps)(dst, src, len);
+}
+
+SwapCopyFunction swapCopyFunction(unsigned short bps) {
+	switch(bps) {
+	case 16:
+		return s_kernel.swap16;
+	case 32:
+		return s_kernel.swap32;
+	default:
+		return copyTail;
+	}
+}
+
+const char* swapCopyKernel() {
+	return s_kernel.name;
+}
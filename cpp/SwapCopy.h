@@ -0,0 +1,56 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * SwapCopy.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#ifndef SWAPCOPY_H_
+#define SWAPCOPY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Copies len bytes from src to dst swapping the byte order of each bps bit sample on the way, so data is brought to
+ * host byte order in the one pass that copies it. src and dst may be the same to swap in place but must not otherwise
+ * overlap. 8 bit samples, and any bytes after the last whole sample, are copied as they are.
+ *
+ * The work is done by the widest of the AVX-512, AVX2, SSSE3 and SSE2 kernels the CPU and the OS support, picked once
+ * with cpuid when the program loads, or by a scalar loop elsewhere. See swapCopyKernel.
+ */
+void swapCopy(unsigned short bps, uint8_t *dst, const uint8_t *src, size_t len);
+
+typedef void (*SwapCopyFunction)(uint8_t *dst, const uint8_t *src, size_t len);
+
+/**
+ * The function swapCopy calls for bps bit samples, for callers which copy many runs of the same samples and would
+ * rather look it up once. For anything but 16 and 32 bits it copies without swapping.
+ */
+SwapCopyFunction swapCopyFunction(unsigned short bps);
+
+/**
+ * The name of the kernel swapCopy uses: avx512, avx2, ssse3, sse2 or scalar.
+ */
+const char* swapCopyKernel();
+
+#endif /* SWAPCOPY_H_ */
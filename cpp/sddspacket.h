@@ -169,7 +169,11 @@ inline SDDSTime operator- (const SDDSTime& t1, const SDDSTime& t2) {
 
 // Assume we're little endian (x86, Tru64)
 const int SDDS_psize = 1080;
-class SDDSpacket {
+const int SDDS_hsize = 56;
+
+// The header is kept as its own class so that it can be received into a
+// separate buffer from the data, see SddsPacketPool.
+class SDDSheader {
  public:
   //======================== SDDS header (raw network order)
   // Format Identifier
@@ -203,9 +207,6 @@ class SDDSpacket {
 
   uint16_t ssd[2];
   uint8_t aad[20];
-  //======================== SDDS data
-  uint8_t d[1024];
-//  uint16_t d[512];
 
   //======================== SDDS methods
   uint16_t get_seq(void) { return ntohs(seq); }
@@ -312,4 +313,11 @@ class SDDSpacket {
 
 };
 
+class SDDSpacket : public SDDSheader {
+ public:
+  //======================== SDDS data
+  uint8_t d[1024];
+//  uint16_t d[512];
+};
+
 #endif
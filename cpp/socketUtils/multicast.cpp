@@ -33,7 +33,7 @@
 #include "SourceNicUtils.h"
 #include <ossie/debug.h>
 
-static multicast_t multicast_open_ (const char* iface, const char* group, int port, std::string& chosen_iface)
+static multicast_t multicast_open_ (const char* iface, const char* group, int port, std::string& chosen_iface, bool reuse_port)
 {
   unsigned int ii;
 
@@ -41,6 +41,9 @@ static multicast_t multicast_open_ (const char* iface, const char* group, int po
   VERIFY_ERR(multicast.sock >= 0, "create socket");
   int one = 1;
   VERIFY_ERR(setsockopt(multicast.sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == 0, "reuse address");
+  if (reuse_port) {
+    VERIFY_ERR(setsockopt(multicast.sock, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) == 0, "reuse port");
+  }
 
   /* Enumerate all the devices. */
   struct ifconf devs = {0};
@@ -119,9 +122,9 @@ static multicast_t multicast_open_ (const char* iface, const char* group, int po
 }
 
 
-multicast_t multicast_client (const char* iface, const char* group, int port, std::string& chosen_iface) throw (BadParameterError)
+multicast_t multicast_client (const char* iface, const char* group, int port, std::string& chosen_iface, bool reuse_port) throw (BadParameterError)
 {
-  multicast_t client = multicast_open_(iface, group, port, chosen_iface);
+  multicast_t client = multicast_open_(iface, group, port, chosen_iface, reuse_port);
   return client;
 }
 
@@ -134,7 +137,7 @@ ssize_t multicast_receive (multicast_t client, void* buffer, size_t bytes)
 
 multicast_t multicast_server (const char* iface, const char* group, int port, std::string& chosen_iface)
 {
-  multicast_t server = multicast_open_(iface, group, port, chosen_iface);
+  multicast_t server = multicast_open_(iface, group, port, chosen_iface, false);
   if (server.sock != -1) {
     uint8_t ttl = 32;
     VERIFY_ERR(setsockopt(server.sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) == 0, "set ttl");
@@ -33,7 +33,7 @@ typedef struct {
   struct sockaddr_in addr;
 } multicast_t;
 
-multicast_t multicast_client (const char* iface, const char* group, int port, std::string& chosen_iface) throw (BadParameterError);
+multicast_t multicast_client (const char* iface, const char* group, int port, std::string& chosen_iface, bool reuse_port = false) throw (BadParameterError);
 ssize_t multicast_receive (multicast_t client, void* buffer, size_t bytes);
 multicast_t multicast_server (const char* iface, const char* group, int port, std::string& chosen_iface);
 ssize_t multicast_transmit (multicast_t server, const void* buffer, size_t bytes);
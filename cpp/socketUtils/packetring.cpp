@@ -0,0 +1,217 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/poll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "packetring.h"
+#include "sequenceshare.h"
+#include <ossie/debug.h>
+
+// Placeholder jump target, replaced with the offset to the drop instruction once the program is complete.
+#define JUMP_TO_DROP 0xFF
+
+static sock_filter bpf_stmt (uint16_t code, uint32_t k)
+{
+  sock_filter f = { code, 0, 0, k };
+  return f;
+}
+
+static sock_filter bpf_jump (uint16_t code, uint32_t k, uint8_t jt, uint8_t jf)
+{
+  sock_filter f = { code, jt, jf, k };
+  return f;
+}
+
+/**
+ * Builds the classic BPF program, offsets are from the start of the IP header since the socket is SOCK_DGRAM.
+ */
+static std::vector<sock_filter> build_filter (struct in_addr dst, int port, unsigned int share_index, unsigned int share_count)
+{
+  std::vector<sock_filter> prog;
+
+  // Drop what this host is sending, on loopback every packet is otherwise seen twice
+  prog.push_back(bpf_stmt(BPF_LD|BPF_W|BPF_ABS, SKF_AD_OFF + SKF_AD_PKTTYPE));
+  prog.push_back(bpf_jump(BPF_JMP|BPF_JEQ|BPF_K, PACKET_OUTGOING, JUMP_TO_DROP, 0));
+
+  // UDP only
+  prog.push_back(bpf_stmt(BPF_LD|BPF_B|BPF_ABS, 9));
+  prog.push_back(bpf_jump(BPF_JMP|BPF_JEQ|BPF_K, IPPROTO_UDP, 0, JUMP_TO_DROP));
+
+  // Fragments would need reassembling, SDDS packets are never fragmented on a correctly configured network
+  prog.push_back(bpf_stmt(BPF_LD|BPF_H|BPF_ABS, 6));
+  prog.push_back(bpf_jump(BPF_JMP|BPF_JSET|BPF_K, 0x1FFF, JUMP_TO_DROP, 0));
+
+  if (dst.s_addr != htonl(INADDR_ANY)) {
+    prog.push_back(bpf_stmt(BPF_LD|BPF_W|BPF_ABS, 16));
+    prog.push_back(bpf_jump(BPF_JMP|BPF_JEQ|BPF_K, ntohl(dst.s_addr), 0, JUMP_TO_DROP));
+  }
+
+  // Destination port, X holds the IP header length
+  prog.push_back(bpf_stmt(BPF_LDX|BPF_B|BPF_MSH, 0));
+  prog.push_back(bpf_stmt(BPF_LD|BPF_H|BPF_IND, 2));
+  prog.push_back(bpf_jump(BPF_JMP|BPF_JEQ|BPF_K, (uint32_t) port, 0, JUMP_TO_DROP));
+
+  // Sequence number, after the 8 byte UDP header
+  if (share_count > 1) {
+    prog.push_back(bpf_stmt(BPF_LD|BPF_H|BPF_IND, 8 + SEQUENCE_SHARE_SEQ_OFFSET));
+    prog.push_back(bpf_stmt(BPF_ALU|BPF_DIV|BPF_K, SEQUENCE_SHARE_CHUNK));
+    prog.push_back(bpf_stmt(BPF_ALU|BPF_MOD|BPF_K, share_count));
+    prog.push_back(bpf_jump(BPF_JMP|BPF_JEQ|BPF_K, share_index, 0, JUMP_TO_DROP));
+  }
+
+  prog.push_back(bpf_stmt(BPF_RET|BPF_K, 0xFFFFFFFF));
+  prog.push_back(bpf_stmt(BPF_RET|BPF_K, 0));
+
+  size_t drop = prog.size() - 1;
+  for (size_t ii = 0; ii < drop; ii++) {
+    if (prog[ii].jt == JUMP_TO_DROP) prog[ii].jt = drop - ii - 1;
+    if (prog[ii].jf == JUMP_TO_DROP) prog[ii].jf = drop - ii - 1;
+  }
+
+  return prog;
+}
+
+static void packetring_open_ (packetring_t& ring, const char* iface, struct in_addr dst, int port, unsigned int share_index, unsigned int share_count)
+{
+  // Protocol zero, nothing is received until the bind below so nothing gets past the filter
+  ring.sock = socket(AF_PACKET, SOCK_DGRAM, 0);
+  VERIFY_ERR(ring.sock >= 0, "create packet socket");
+
+  std::vector<sock_filter> prog = build_filter(dst, port, share_index, share_count);
+  struct sock_fprog fprog;
+  fprog.len = prog.size();
+  fprog.filter = &prog[0];
+  VERIFY_ERR(setsockopt(ring.sock, SOL_SOCKET, SO_ATTACH_FILTER, &fprog, sizeof(fprog)) == 0, "attach filter");
+
+  int version = TPACKET_V3;
+  VERIFY_ERR(setsockopt(ring.sock, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) == 0, "set TPACKET_V3");
+
+  struct tpacket_req3 req;
+  memset(&req, 0, sizeof(req));
+  req.tp_block_size = PACKETRING_BLOCK_SIZE;
+  req.tp_block_nr = PACKETRING_BLOCK_NR;
+  req.tp_frame_size = PACKETRING_FRAME_SIZE;
+  req.tp_frame_nr = (PACKETRING_BLOCK_SIZE / PACKETRING_FRAME_SIZE) * PACKETRING_BLOCK_NR;
+  req.tp_retire_blk_tov = PACKETRING_BLOCK_TIMEOUT_MS;
+  VERIFY_ERR(setsockopt(ring.sock, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) == 0, "create receive ring");
+
+  ring.map_len = (size_t) req.tp_block_size * req.tp_block_nr;
+  ring.map = (uint8_t*) mmap(NULL, ring.map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.sock, 0);
+  VERIFY_ERR(ring.map != MAP_FAILED, "map receive ring");
+
+  struct sockaddr_ll ll;
+  memset(&ll, 0, sizeof(ll));
+  ll.sll_family = AF_PACKET;
+  ll.sll_protocol = htons(ETH_P_IP);
+  ll.sll_ifindex = 0;
+  if (*iface && strcmp(iface, "ALL") != 0) {
+    ll.sll_ifindex = if_nametoindex(iface);
+    VERIFY_ERR(ll.sll_ifindex != 0, "find interface");
+  }
+  VERIFY_ERR(bind(ring.sock, (struct sockaddr*)&ll, sizeof(ll)) == 0, "bind packet socket");
+}
+
+packetring_t packetring_client (const char* iface, struct in_addr dst, int port, unsigned int share_index, unsigned int share_count) throw (BadParameterError)
+{
+  packetring_t ring;
+  memset(&ring, 0, sizeof(ring));
+  ring.sock = -1;
+  ring.map = (uint8_t*) MAP_FAILED;
+
+  try {
+    packetring_open_(ring, iface, dst, port, share_index, share_count);
+  } catch (BadParameterError &e) {
+    // Clean up whatever was opened before the failure
+    packetring_close(ring);
+    throw;
+  }
+  return ring;
+}
+
+struct tpacket_block_desc* packetring_next_block (packetring_t* ring)
+{
+  struct tpacket_block_desc* block = (struct tpacket_block_desc*) (ring->map + (size_t) ring->block_idx * PACKETRING_BLOCK_SIZE);
+  if ((block->hdr.bh1.block_status & TP_STATUS_USER) == 0) {
+    return NULL;
+  }
+  // Do not read the packets before the status says they are ours
+  __sync_synchronize();
+  return block;
+}
+
+void packetring_release_block (packetring_t* ring, struct tpacket_block_desc* block)
+{
+  __sync_synchronize();
+  block->hdr.bh1.block_status = TP_STATUS_KERNEL;
+  ring->block_idx = (ring->block_idx + 1) % PACKETRING_BLOCK_NR;
+}
+
+const uint8_t* packetring_udp_payload (const struct tpacket3_hdr* pkt, size_t* len, struct in_addr* src)
+{
+  const uint8_t* ip = (const uint8_t*) pkt + pkt->tp_net;
+  size_t avail = pkt->tp_snaplen - (pkt->tp_net - pkt->tp_mac);
+
+  if (avail < 20) return NULL;
+  size_t ihl = (ip[0] & 0x0F) * 4;
+  if (ihl < 20 || avail < ihl + 8) return NULL;
+
+  const uint8_t* udp = ip + ihl;
+  size_t udp_len = (udp[4] << 8) | udp[5];
+  if (udp_len < 8) return NULL;
+
+  *len = udp_len - 8;
+  if (*len > avail - ihl - 8) *len = avail - ihl - 8;
+  memcpy(&src->s_addr, ip + 12, sizeof(src->s_addr));
+  return udp + 8;
+}
+
+int packetring_poll_in (packetring_t ring, int timeout)
+{
+  struct pollfd pfd;
+  pfd.fd = ring.sock;
+  pfd.events = POLLIN | POLLERR;
+  pfd.revents = 0;
+  return poll(&pfd, 1, timeout);
+}
+
+void packetring_close (packetring_t ring)
+{
+  if (ring.map && ring.map != MAP_FAILED) munmap(ring.map, ring.map_len);
+  if (ring.sock >= 0) close(ring.sock);
+}
+
+int attach_drop_all_filter (int sock)
+{
+  sock_filter drop = bpf_stmt(BPF_RET|BPF_K, 0);
+  struct sock_fprog fprog;
+  fprog.len = 1;
+  fprog.filter = &drop;
+  return setsockopt(sock, SOL_SOCKET, SO_ATTACH_FILTER, &fprog, sizeof(fprog));
+}
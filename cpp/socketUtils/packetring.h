@@ -0,0 +1,86 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef PACKETRING_H_
+#define PACKETRING_H_
+
+#include <arpa/inet.h>
+#include <linux/if_packet.h>
+#include <stdint.h>
+#include "SourceNicUtils.h"
+
+// Size of each block of the receive ring, must be a multiple of the page size.
+#define PACKETRING_BLOCK_SIZE (1 << 20)
+
+// Number of blocks in the receive ring.
+#define PACKETRING_BLOCK_NR 32
+
+// Frame size used to size the ring, large enough for an SDDS packet plus the IP/UDP and tpacket headers.
+#define PACKETRING_FRAME_SIZE 2048
+
+// How long (in ms) the kernel waits before handing over a block that is not full.
+#define PACKETRING_BLOCK_TIMEOUT_MS 8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  int sock;
+  uint8_t* map;
+  size_t map_len;
+  unsigned int block_idx;
+} packetring_t;
+
+/**
+ * Opens an AF_PACKET socket with a TPACKET_V3 receive ring on iface (all interfaces if empty or "ALL"). A BPF filter
+ * is attached so only UDP packets destined for dst:port (any address if dst is INADDR_ANY) reach the ring.
+ * Packets the host itself is sending are dropped so loopback works as expected. With a share_count above one the
+ * filter also drops every packet which sequence_share does not give to share_index.
+ */
+packetring_t packetring_client (const char* iface, struct in_addr dst, int port, unsigned int share_index = 0, unsigned int share_count = 1) throw (BadParameterError);
+
+/**
+ * Returns the next block if the kernel has handed it to user space, NULL otherwise.
+ */
+struct tpacket_block_desc* packetring_next_block (packetring_t* ring);
+
+/**
+ * Gives the block returned by packetring_next_block back to the kernel and moves on to the next one.
+ */
+void packetring_release_block (packetring_t* ring, struct tpacket_block_desc* block);
+
+/**
+ * Finds the UDP payload of a packet within a block. Returns NULL if the packet is not a valid UDP packet.
+ */
+const uint8_t* packetring_udp_payload (const struct tpacket3_hdr* pkt, size_t* len, struct in_addr* src);
+
+int packetring_poll_in (packetring_t ring, int timeout);
+void packetring_close (packetring_t ring);
+
+/**
+ * Attaches a filter which drops every packet, used to stop the UDP socket queueing packets the ring is already receiving.
+ */
+int attach_drop_all_filter (int sock);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PACKETRING_H_ */
@@ -0,0 +1,73 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include <sys/socket.h>
+#include <linux/filter.h>
+#include <netinet/udp.h>
+#include "sequenceshare.h"
+
+#ifndef SO_ATTACH_REUSEPORT_CBPF
+#define SO_ATTACH_REUSEPORT_CBPF 51
+#endif
+
+static sock_filter bpf_stmt (uint16_t code, uint32_t k)
+{
+  sock_filter f = { code, 0, 0, k };
+  return f;
+}
+
+static sock_filter bpf_jump (uint16_t code, uint32_t k, uint8_t jt, uint8_t jf)
+{
+  sock_filter f = { code, jt, jf, k };
+  return f;
+}
+
+static int attach (int sock, int option, sock_filter* prog, unsigned short len)
+{
+  struct sock_fprog fprog;
+  fprog.len = len;
+  fprog.filter = prog;
+  return setsockopt(sock, SOL_SOCKET, option, &fprog, sizeof(fprog));
+}
+
+int attach_sequence_share_filter (int sock, unsigned int index, unsigned int count)
+{
+  // A socket filter sees the packet from the UDP header on
+  sock_filter prog[] = {
+    bpf_stmt(BPF_LD|BPF_H|BPF_ABS, sizeof(struct udphdr) + SEQUENCE_SHARE_SEQ_OFFSET),
+    bpf_stmt(BPF_ALU|BPF_DIV|BPF_K, SEQUENCE_SHARE_CHUNK),
+    bpf_stmt(BPF_ALU|BPF_MOD|BPF_K, count),
+    bpf_jump(BPF_JMP|BPF_JEQ|BPF_K, index, 0, 1),
+    bpf_stmt(BPF_RET|BPF_K, 0xFFFFFFFF),
+    bpf_stmt(BPF_RET|BPF_K, 0),
+  };
+  return attach(sock, SO_ATTACH_FILTER, prog, sizeof(prog) / sizeof(prog[0]));
+}
+
+int attach_reuseport_share_program (int sock, unsigned int count)
+{
+  // A reuseport program sees the packet from the UDP payload on and returns the index of the socket to use
+  sock_filter prog[] = {
+    bpf_stmt(BPF_LD|BPF_H|BPF_ABS, SEQUENCE_SHARE_SEQ_OFFSET),
+    bpf_stmt(BPF_ALU|BPF_DIV|BPF_K, SEQUENCE_SHARE_CHUNK),
+    bpf_stmt(BPF_ALU|BPF_MOD|BPF_K, count),
+    bpf_stmt(BPF_RET|BPF_A, 0),
+  };
+  return attach(sock, SO_ATTACH_REUSEPORT_CBPF, prog, sizeof(prog) / sizeof(prog[0]));
+}
@@ -0,0 +1,60 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef SEQUENCESHARE_H_
+#define SEQUENCESHARE_H_
+
+#include <stdint.h>
+
+// Packets are shared between readers in runs of this many consecutive sequence numbers, one SDDS parity group.
+#define SEQUENCE_SHARE_CHUNK 32
+
+// Offset of the SDDS sequence number within the packet.
+#define SEQUENCE_SHARE_SEQ_OFFSET 2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Returns which of count readers is given the packet with sequence number seq.
+ */
+static inline unsigned int sequence_share (uint16_t seq, unsigned int count)
+{
+  return (seq / SEQUENCE_SHARE_CHUNK) % count;
+}
+
+/**
+ * Attaches a filter to the socket which drops every packet that is not reader index's share, used when every socket
+ * receives a copy of every packet (multicast).
+ */
+int attach_sequence_share_filter (int sock, unsigned int index, unsigned int count);
+
+/**
+ * Attaches a program to the SO_REUSEPORT group sock belongs to which steers each packet to the socket that was bound
+ * at the position of its share. For unicast the kernel would otherwise pick the socket by hashing the addresses, which
+ * sends everything from a single SDDS source to the same socket.
+ */
+int attach_reuseport_share_program (int sock, unsigned int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SEQUENCESHARE_H_ */
@@ -82,7 +82,7 @@ static inline void verify_debug_ (int condition, const char* message, const char
 }
 #define verify_debug(CONDITION, MESSAGE) verify_debug_(CONDITION, MESSAGE, #CONDITION, __FILE__, __LINE__)
 
-static unicast_t unicast_open_ (const char* iface, const char* ip, int port, std::string& chosen_iface)
+static unicast_t unicast_open_ (const char* iface, const char* ip, int port, std::string& chosen_iface, bool reuse_port)
 {
   unsigned int ii;
 
@@ -90,6 +90,9 @@ static unicast_t unicast_open_ (const char* iface, const char* ip, int port, std
   verify(unicast.sock >= 0, "create socket");
   int one = 1;
   verify(setsockopt(unicast.sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == 0, "reuse address");
+  if (reuse_port) {
+    verify(setsockopt(unicast.sock, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) == 0, "reuse port");
+  }
 
   /* Enumerate all the devices. */
   struct ifconf devs = {0};
@@ -154,9 +157,9 @@ static unicast_t unicast_open_ (const char* iface, const char* ip, int port, std
 }
 
 
-unicast_t unicast_client (const char* iface, const char* group, int port, std::string& chosen_iface) throw (BadParameterError)
+unicast_t unicast_client (const char* iface, const char* group, int port, std::string& chosen_iface, bool reuse_port) throw (BadParameterError)
 {
-  unicast_t client = unicast_open_(iface, group, port, chosen_iface);
+  unicast_t client = unicast_open_(iface, group, port, chosen_iface, reuse_port);
   return client;
 }
 
@@ -173,7 +176,7 @@ ssize_t unicast_receive (unicast_t client, void* buffer, size_t bytes, unsigned
 
 unicast_t unicast_server (const char* iface, const char* group, int port, std::string& chosen_iface)
 {
-  unicast_t server = unicast_open_(iface, group, port, chosen_iface);
+  unicast_t server = unicast_open_(iface, group, port, chosen_iface, false);
   if (server.sock != -1) {
     uint8_t ttl = 32;
     verify(setsockopt(server.sock, IPPROTO_IP, IP_TTL, &ttl, sizeof(ttl)) == 0, "set ttl");
@@ -0,0 +1,277 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include "uringrecv.h"
+#include <ossie/debug.h>
+
+#ifdef HAVE_LINUX_IO_URING_H
+#include <linux/io_uring.h>
+#endif
+
+// Multishot receive and provided buffer rings arrived after io_uring itself, older headers lack them
+#if defined(HAVE_LINUX_IO_URING_H) && defined(IORING_RECV_MULTISHOT)
+#define URINGRECV_SUPPORTED
+#endif
+
+#ifdef URINGRECV_SUPPORTED
+
+// The io_uring system calls share the same numbers on every architecture, glibc may not define them yet
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+#ifndef __NR_io_uring_register
+#define __NR_io_uring_register 427
+#endif
+
+// Identifies the submissions so the completions can be told apart
+#define URINGRECV_RECV_DATA 1
+#define URINGRECV_CANCEL_DATA 2
+
+// Only the receive and its cancel are ever in flight
+#define URINGRECV_SQ_ENTRIES 4
+
+// The buffer group the provided buffer ring is registered as
+#define URINGRECV_BGID 0
+
+static int io_uring_setup_ (unsigned int entries, struct io_uring_params* p)
+{
+  return (int) syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int io_uring_enter_ (int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags, void* arg, size_t argsz)
+{
+  return (int) syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+static int io_uring_register_ (int fd, unsigned int opcode, void* arg, unsigned int nr_args)
+{
+  return (int) syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static void uringrecv_open_ (uringrecv_t& ring, int sock, unsigned int buf_entries)
+{
+  VERIFY_ERR(buf_entries > 0 && buf_entries <= URINGRECV_MAX_BUFFERS && (buf_entries & (buf_entries - 1)) == 0, "size provided buffer ring");
+
+  struct io_uring_params p;
+  memset(&p, 0, sizeof(p));
+  // One completion per buffer can be outstanding, plus the end of the receive and the cancel
+  p.flags = IORING_SETUP_CQSIZE;
+  p.cq_entries = 2 * buf_entries;
+
+  ring.fd = io_uring_setup_(URINGRECV_SQ_ENTRIES, &p);
+  VERIFY_ERR(ring.fd >= 0, "create io_uring");
+  VERIFY_ERR(p.features & IORING_FEAT_EXT_ARG, "io_uring wait with timeout");
+
+  ring.sq_map_len = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+  ring.sq_map = mmap(NULL, ring.sq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQ_RING);
+  VERIFY_ERR(ring.sq_map != MAP_FAILED, "map submission queue");
+
+  ring.cq_map_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  ring.cq_map = mmap(NULL, ring.cq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_CQ_RING);
+  VERIFY_ERR(ring.cq_map != MAP_FAILED, "map completion queue");
+
+  ring.sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+  ring.sqes = mmap(NULL, ring.sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQES);
+  VERIFY_ERR(ring.sqes != MAP_FAILED, "map submission entries");
+
+  uint8_t* sq = (uint8_t*) ring.sq_map;
+  ring.sq_head = (unsigned int*) (sq + p.sq_off.head);
+  ring.sq_tail = (unsigned int*) (sq + p.sq_off.tail);
+  ring.sq_mask = (unsigned int*) (sq + p.sq_off.ring_mask);
+  ring.sq_array = (unsigned int*) (sq + p.sq_off.array);
+
+  uint8_t* cq = (uint8_t*) ring.cq_map;
+  ring.cq_head = (unsigned int*) (cq + p.cq_off.head);
+  ring.cq_tail = (unsigned int*) (cq + p.cq_off.tail);
+  ring.cq_mask = (unsigned int*) (cq + p.cq_off.ring_mask);
+  ring.cqes = cq + p.cq_off.cqes;
+
+  // The ring must be page aligned, which mmap gives us
+  long page = sysconf(_SC_PAGESIZE);
+  ring.buf_ring_len = ((buf_entries * sizeof(struct io_uring_buf) + page - 1) / page) * page;
+  ring.buf_ring = mmap(NULL, ring.buf_ring_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+  VERIFY_ERR(ring.buf_ring != MAP_FAILED, "allocate provided buffer ring");
+  ring.buf_entries = buf_entries;
+  ring.buf_tail = 0;
+
+  struct io_uring_buf_reg reg;
+  memset(&reg, 0, sizeof(reg));
+  reg.ring_addr = (uint64_t) (uintptr_t) ring.buf_ring;
+  reg.ring_entries = buf_entries;
+  reg.bgid = URINGRECV_BGID;
+  VERIFY_ERR(io_uring_register_(ring.fd, IORING_REGISTER_PBUF_RING, &reg, 1) == 0, "register provided buffer ring");
+
+  ring.sock = sock;
+}
+
+uringrecv_t uringrecv_client (int sock, unsigned int buf_entries) throw (BadParameterError)
+{
+  uringrecv_t ring;
+  memset(&ring, 0, sizeof(ring));
+  ring.fd = -1;
+  ring.sock = -1;
+  ring.sq_map = ring.cq_map = ring.sqes = ring.buf_ring = MAP_FAILED;
+
+  try {
+    uringrecv_open_(ring, sock, buf_entries);
+  } catch (BadParameterError &e) {
+    // Clean up whatever was opened before the failure
+    uringrecv_close(ring);
+    throw;
+  }
+  return ring;
+}
+
+uint16_t uringrecv_provide (uringrecv_t* ring, void* addr, unsigned int len)
+{
+  uint16_t bid = ring->buf_tail & (ring->buf_entries - 1);
+  // Not br->bufs, in C++ the flexible array member is declared behind an empty struct which moves it off the start of the ring
+  struct io_uring_buf* buf = (struct io_uring_buf*) ring->buf_ring + bid;
+  buf->addr = (uint64_t) (uintptr_t) addr;
+  buf->len = len;
+  buf->bid = bid;
+  ring->buf_tail++;
+  return bid;
+}
+
+void uringrecv_commit (uringrecv_t* ring)
+{
+  struct io_uring_buf_ring* br = (struct io_uring_buf_ring*) ring->buf_ring;
+  // The buffers must be visible before the tail that hands them over
+  __sync_synchronize();
+  *(volatile uint16_t*) &br->tail = ring->buf_tail;
+}
+
+static int uringrecv_submit_ (uringrecv_t* ring, uint8_t opcode, uint64_t user_data, uint64_t addr)
+{
+  unsigned int tail = *ring->sq_tail;
+  unsigned int idx = tail & *ring->sq_mask;
+  struct io_uring_sqe* sqe = (struct io_uring_sqe*) ring->sqes + idx;
+
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->user_data = user_data;
+
+  if (opcode == IORING_OP_RECV) {
+    sqe->fd = ring->sock;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->buf_group = URINGRECV_BGID;
+  } else {
+    sqe->fd = -1;
+    sqe->addr = addr;
+  }
+
+  ring->sq_array[idx] = idx;
+  __sync_synchronize();
+  *(volatile unsigned int*) ring->sq_tail = tail + 1;
+
+  int saved_errno = errno;
+  int ret = io_uring_enter_(ring->fd, 1, 0, 0, NULL, 0);
+  ret = (ret < 0) ? -errno : 0;
+  errno = saved_errno;
+  return ret;
+}
+
+int uringrecv_arm (uringrecv_t* ring)
+{
+  return uringrecv_submit_(ring, IORING_OP_RECV, URINGRECV_RECV_DATA, 0);
+}
+
+int uringrecv_cancel (uringrecv_t* ring)
+{
+  return uringrecv_submit_(ring, IORING_OP_ASYNC_CANCEL, URINGRECV_CANCEL_DATA, URINGRECV_RECV_DATA);
+}
+
+unsigned int uringrecv_reap (uringrecv_t* ring, uringrecv_completion_t* out, unsigned int max)
+{
+  unsigned int head = *ring->cq_head;
+  unsigned int tail = *(volatile unsigned int*) ring->cq_tail;
+  // Do not read the completions before the tail says they are there
+  __sync_synchronize();
+
+  unsigned int n = 0;
+  while (head != tail && n < max) {
+    struct io_uring_cqe* cqe = (struct io_uring_cqe*) ring->cqes + (head & *ring->cq_mask);
+    if (cqe->user_data == URINGRECV_RECV_DATA) {
+      out[n].res = cqe->res;
+      out[n].bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+      out[n].flags = 0;
+      if (cqe->flags & IORING_CQE_F_BUFFER) out[n].flags |= URINGRECV_F_BUFFER;
+      if (cqe->flags & IORING_CQE_F_MORE) out[n].flags |= URINGRECV_F_MORE;
+      n++;
+    }
+    head++;
+  }
+
+  __sync_synchronize();
+  *(volatile unsigned int*) ring->cq_head = head;
+  return n;
+}
+
+int uringrecv_wait (uringrecv_t* ring, int timeout)
+{
+  struct __kernel_timespec ts;
+  ts.tv_sec = timeout / 1000;
+  ts.tv_nsec = (timeout % 1000) * 1000000LL;
+
+  struct io_uring_getevents_arg arg;
+  memset(&arg, 0, sizeof(arg));
+  arg.ts = (uint64_t) (uintptr_t) &ts;
+
+  int saved_errno = errno;
+  int ret = io_uring_enter_(ring->fd, 0, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+  errno = saved_errno;
+  return ret;
+}
+
+void uringrecv_close (uringrecv_t ring)
+{
+  if (ring.sqes != MAP_FAILED) munmap(ring.sqes, ring.sqes_len);
+  if (ring.cq_map != MAP_FAILED) munmap(ring.cq_map, ring.cq_map_len);
+  if (ring.sq_map != MAP_FAILED) munmap(ring.sq_map, ring.sq_map_len);
+  if (ring.fd >= 0) close(ring.fd);
+  // Closing the io_uring unregisters the buffer ring so it is freed last
+  if (ring.buf_ring != MAP_FAILED) munmap(ring.buf_ring, ring.buf_ring_len);
+}
+
+#else
+
+uringrecv_t uringrecv_client (int sock, unsigned int buf_entries) throw (BadParameterError)
+{
+  throw BadParameterError("io_uring multishot receive support was not compiled in");
+}
+
+uint16_t uringrecv_provide (uringrecv_t* ring, void* addr, unsigned int len) { return 0; }
+void uringrecv_commit (uringrecv_t* ring) {}
+int uringrecv_arm (uringrecv_t* ring) { return -ENOSYS; }
+int uringrecv_cancel (uringrecv_t* ring) { return -ENOSYS; }
+unsigned int uringrecv_reap (uringrecv_t* ring, uringrecv_completion_t* out, unsigned int max) { return 0; }
+int uringrecv_wait (uringrecv_t* ring, int timeout) { return -ENOSYS; }
+void uringrecv_close (uringrecv_t ring) {}
+
+#endif
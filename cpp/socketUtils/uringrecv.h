@@ -0,0 +1,110 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef URINGRECV_H_
+#define URINGRECV_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "SourceNicUtils.h"
+
+// Largest number of buffers the kernel accepts in a provided buffer ring.
+#define URINGRECV_MAX_BUFFERS 32768
+
+// The completion used up one of the provided buffers, bid says which.
+#define URINGRECV_F_BUFFER 0x1
+
+// The multishot receive is still armed, if not set it must be armed again.
+#define URINGRECV_F_MORE 0x2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  int fd;
+  int sock;
+  void* sq_map;
+  size_t sq_map_len;
+  void* cq_map;
+  size_t cq_map_len;
+  void* sqes;
+  size_t sqes_len;
+  void* buf_ring;
+  size_t buf_ring_len;
+  unsigned int buf_entries;
+  uint16_t buf_tail;
+  unsigned int* sq_head;
+  unsigned int* sq_tail;
+  unsigned int* sq_mask;
+  unsigned int* sq_array;
+  unsigned int* cq_head;
+  unsigned int* cq_tail;
+  unsigned int* cq_mask;
+  void* cqes;
+} uringrecv_t;
+
+typedef struct {
+  int res;        // Bytes received, or a negated errno
+  uint16_t bid;   // Buffer id, valid if URINGRECV_F_BUFFER is set
+  uint8_t flags;
+} uringrecv_completion_t;
+
+/**
+ * Sets up an io_uring to receive from sock and registers a provided buffer ring with room for buf_entries
+ * buffers, which must be a power of two no larger than URINGRECV_MAX_BUFFERS. Throws a BadParameterError
+ * if io_uring is unavailable, either because the kernel is too old or support was not compiled in.
+ */
+uringrecv_t uringrecv_client (int sock, unsigned int buf_entries) throw (BadParameterError);
+
+/**
+ * Adds a buffer to the provided buffer ring and returns its buffer id. The kernel uses buffers in the order
+ * they are provided. The buffer is not visible to the kernel until uringrecv_commit is called.
+ */
+uint16_t uringrecv_provide (uringrecv_t* ring, void* addr, unsigned int len);
+void uringrecv_commit (uringrecv_t* ring);
+
+/**
+ * Submits a multishot receive which posts a completion for each datagram until it runs out of buffers.
+ * Returns 0 on success or a negated errno.
+ */
+int uringrecv_arm (uringrecv_t* ring);
+
+/**
+ * Cancels the multishot receive, its final completion (without URINGRECV_F_MORE) is still reaped as normal.
+ */
+int uringrecv_cancel (uringrecv_t* ring);
+
+/**
+ * Copies up to max completions of the receive into out, without making a system call. Returns the number copied.
+ */
+unsigned int uringrecv_reap (uringrecv_t* ring, uringrecv_completion_t* out, unsigned int max);
+
+/**
+ * Blocks until there is at least one completion or timeout ms have passed.
+ */
+int uringrecv_wait (uringrecv_t* ring, int timeout);
+
+void uringrecv_close (uringrecv_t ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* URINGRECV_H_ */
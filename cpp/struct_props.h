@@ -42,6 +42,32 @@ struct advanced_optimizations_struct {
         socket_read_thread_priority = -1;
         sdds_to_bulkio_thread_priority = -1;
         check_for_duplicate_sender = false;
+        lock_free_buffer = false;
+        zero_copy_receive = false;
+        receive_backend = "recvmmsg";
+        wait_policy = "adaptive";
+        spin_time = 50;
+        busy_poll_time = 0;
+        num_socket_readers = 1;
+        udp_gro = false;
+        auto_tune = false;
+        min_pkts_per_socket_read = 16;
+        max_pkts_per_socket_read = 1000;
+        min_sdds_pkts_per_bulkio_push = 16;
+        max_sdds_pkts_per_bulkio_push = 2000;
+        shared_reader_threads = 0;
+        shared_reader_budget = 64;
+        max_attached_streams = 1;
+        stream_worker_threads = 2;
+        conversion_threads = 0;
+        run_to_completion = false;
+        huge_page_buffer = true;
+        lock_buffer_memory = true;
+        numa_placement = true;
+        real_time_mode = false;
+        real_time_priority = 50;
+        overflow_policy = "block";
+        max_buffer_memory = 0;
     };
 
     static std::string getId() {
@@ -57,6 +83,32 @@ struct advanced_optimizations_struct {
     CORBA::Long socket_read_thread_priority;
     CORBA::Long sdds_to_bulkio_thread_priority;
     bool check_for_duplicate_sender;
+    bool lock_free_buffer;
+    bool zero_copy_receive;
+    std::string receive_backend;
+    std::string wait_policy;
+    CORBA::ULong spin_time;
+    CORBA::ULong busy_poll_time;
+    CORBA::ULong num_socket_readers;
+    bool udp_gro;
+    bool auto_tune;
+    unsigned short min_pkts_per_socket_read;
+    unsigned short max_pkts_per_socket_read;
+    unsigned short min_sdds_pkts_per_bulkio_push;
+    unsigned short max_sdds_pkts_per_bulkio_push;
+    unsigned short shared_reader_threads;
+    unsigned short shared_reader_budget;
+    unsigned short max_attached_streams;
+    unsigned short stream_worker_threads;
+    unsigned short conversion_threads;
+    bool run_to_completion;
+    bool huge_page_buffer;
+    bool lock_buffer_memory;
+    bool numa_placement;
+    bool real_time_mode;
+    CORBA::Long real_time_priority;
+    std::string overflow_policy;
+    CORBA::ULongLong max_buffer_memory;
 };
 
 inline bool operator>>= (const CORBA::Any& a, advanced_optimizations_struct& s) {
@@ -90,6 +142,84 @@ inline bool operator>>= (const CORBA::Any& a, advanced_optimizations_struct& s)
     if (props.contains("advanced_optimizations::check_for_duplicate_sender")) {
         if (!(props["advanced_optimizations::check_for_duplicate_sender"] >>= s.check_for_duplicate_sender)) return false;
     }
+    if (props.contains("advanced_optimizations::lock_free_buffer")) {
+        if (!(props["advanced_optimizations::lock_free_buffer"] >>= s.lock_free_buffer)) return false;
+    }
+    if (props.contains("advanced_optimizations::zero_copy_receive")) {
+        if (!(props["advanced_optimizations::zero_copy_receive"] >>= s.zero_copy_receive)) return false;
+    }
+    if (props.contains("advanced_optimizations::receive_backend")) {
+        if (!(props["advanced_optimizations::receive_backend"] >>= s.receive_backend)) return false;
+    }
+    if (props.contains("advanced_optimizations::wait_policy")) {
+        if (!(props["advanced_optimizations::wait_policy"] >>= s.wait_policy)) return false;
+    }
+    if (props.contains("advanced_optimizations::spin_time")) {
+        if (!(props["advanced_optimizations::spin_time"] >>= s.spin_time)) return false;
+    }
+    if (props.contains("advanced_optimizations::busy_poll_time")) {
+        if (!(props["advanced_optimizations::busy_poll_time"] >>= s.busy_poll_time)) return false;
+    }
+    if (props.contains("advanced_optimizations::num_socket_readers")) {
+        if (!(props["advanced_optimizations::num_socket_readers"] >>= s.num_socket_readers)) return false;
+    }
+    if (props.contains("advanced_optimizations::udp_gro")) {
+        if (!(props["advanced_optimizations::udp_gro"] >>= s.udp_gro)) return false;
+    }
+    if (props.contains("advanced_optimizations::auto_tune")) {
+        if (!(props["advanced_optimizations::auto_tune"] >>= s.auto_tune)) return false;
+    }
+    if (props.contains("advanced_optimizations::min_pkts_per_socket_read")) {
+        if (!(props["advanced_optimizations::min_pkts_per_socket_read"] >>= s.min_pkts_per_socket_read)) return false;
+    }
+    if (props.contains("advanced_optimizations::max_pkts_per_socket_read")) {
+        if (!(props["advanced_optimizations::max_pkts_per_socket_read"] >>= s.max_pkts_per_socket_read)) return false;
+    }
+    if (props.contains("advanced_optimizations::min_sdds_pkts_per_bulkio_push")) {
+        if (!(props["advanced_optimizations::min_sdds_pkts_per_bulkio_push"] >>= s.min_sdds_pkts_per_bulkio_push)) return false;
+    }
+    if (props.contains("advanced_optimizations::max_sdds_pkts_per_bulkio_push")) {
+        if (!(props["advanced_optimizations::max_sdds_pkts_per_bulkio_push"] >>= s.max_sdds_pkts_per_bulkio_push)) return false;
+    }
+    if (props.contains("advanced_optimizations::shared_reader_threads")) {
+        if (!(props["advanced_optimizations::shared_reader_threads"] >>= s.shared_reader_threads)) return false;
+    }
+    if (props.contains("advanced_optimizations::shared_reader_budget")) {
+        if (!(props["advanced_optimizations::shared_reader_budget"] >>= s.shared_reader_budget)) return false;
+    }
+    if (props.contains("advanced_optimizations::max_attached_streams")) {
+        if (!(props["advanced_optimizations::max_attached_streams"] >>= s.max_attached_streams)) return false;
+    }
+    if (props.contains("advanced_optimizations::stream_worker_threads")) {
+        if (!(props["advanced_optimizations::stream_worker_threads"] >>= s.stream_worker_threads)) return false;
+    }
+    if (props.contains("advanced_optimizations::conversion_threads")) {
+        if (!(props["advanced_optimizations::conversion_threads"] >>= s.conversion_threads)) return false;
+    }
+    if (props.contains("advanced_optimizations::run_to_completion")) {
+        if (!(props["advanced_optimizations::run_to_completion"] >>= s.run_to_completion)) return false;
+    }
+    if (props.contains("advanced_optimizations::huge_page_buffer")) {
+        if (!(props["advanced_optimizations::huge_page_buffer"] >>= s.huge_page_buffer)) return false;
+    }
+    if (props.contains("advanced_optimizations::lock_buffer_memory")) {
+        if (!(props["advanced_optimizations::lock_buffer_memory"] >>= s.lock_buffer_memory)) return false;
+    }
+    if (props.contains("advanced_optimizations::numa_placement")) {
+        if (!(props["advanced_optimizations::numa_placement"] >>= s.numa_placement)) return false;
+    }
+    if (props.contains("advanced_optimizations::real_time_mode")) {
+        if (!(props["advanced_optimizations::real_time_mode"] >>= s.real_time_mode)) return false;
+    }
+    if (props.contains("advanced_optimizations::real_time_priority")) {
+        if (!(props["advanced_optimizations::real_time_priority"] >>= s.real_time_priority)) return false;
+    }
+    if (props.contains("advanced_optimizations::overflow_policy")) {
+        if (!(props["advanced_optimizations::overflow_policy"] >>= s.overflow_policy)) return false;
+    }
+    if (props.contains("advanced_optimizations::max_buffer_memory")) {
+        if (!(props["advanced_optimizations::max_buffer_memory"] >>= s.max_buffer_memory)) return false;
+    }
     return true;
 }
 
@@ -113,6 +243,58 @@ inline void operator<<= (CORBA::Any& a, const advanced_optimizations_struct& s)
     props["advanced_optimizations::sdds_to_bulkio_thread_priority"] = s.sdds_to_bulkio_thread_priority;
  
     props["advanced_optimizations::check_for_duplicate_sender"] = s.check_for_duplicate_sender;
+ 
+    props["advanced_optimizations::lock_free_buffer"] = s.lock_free_buffer;
+ 
+    props["advanced_optimizations::zero_copy_receive"] = s.zero_copy_receive;
+ 
+    props["advanced_optimizations::receive_backend"] = s.receive_backend;
+ 
+    props["advanced_optimizations::wait_policy"] = s.wait_policy;
+ 
+    props["advanced_optimizations::spin_time"] = s.spin_time;
+ 
+    props["advanced_optimizations::busy_poll_time"] = s.busy_poll_time;
+ 
+    props["advanced_optimizations::num_socket_readers"] = s.num_socket_readers;
+ 
+    props["advanced_optimizations::udp_gro"] = s.udp_gro;
+ 
+    props["advanced_optimizations::auto_tune"] = s.auto_tune;
+ 
+    props["advanced_optimizations::min_pkts_per_socket_read"] = s.min_pkts_per_socket_read;
+ 
+    props["advanced_optimizations::max_pkts_per_socket_read"] = s.max_pkts_per_socket_read;
+ 
+    props["advanced_optimizations::min_sdds_pkts_per_bulkio_push"] = s.min_sdds_pkts_per_bulkio_push;
+ 
+    props["advanced_optimizations::max_sdds_pkts_per_bulkio_push"] = s.max_sdds_pkts_per_bulkio_push;
+ 
+    props["advanced_optimizations::shared_reader_threads"] = s.shared_reader_threads;
+ 
+    props["advanced_optimizations::shared_reader_budget"] = s.shared_reader_budget;
+ 
+    props["advanced_optimizations::max_attached_streams"] = s.max_attached_streams;
+ 
+    props["advanced_optimizations::stream_worker_threads"] = s.stream_worker_threads;
+ 
+    props["advanced_optimizations::conversion_threads"] = s.conversion_threads;
+ 
+    props["advanced_optimizations::run_to_completion"] = s.run_to_completion;
+ 
+    props["advanced_optimizations::huge_page_buffer"] = s.huge_page_buffer;
+ 
+    props["advanced_optimizations::lock_buffer_memory"] = s.lock_buffer_memory;
+ 
+    props["advanced_optimizations::numa_placement"] = s.numa_placement;
+ 
+    props["advanced_optimizations::real_time_mode"] = s.real_time_mode;
+ 
+    props["advanced_optimizations::real_time_priority"] = s.real_time_priority;
+ 
+    props["advanced_optimizations::overflow_policy"] = s.overflow_policy;
+ 
+    props["advanced_optimizations::max_buffer_memory"] = s.max_buffer_memory;
     a <<= props;
 }
 
@@ -135,6 +317,58 @@ inline bool operator== (const advanced_optimizations_struct& s1, const advanced_
         return false;
     if (s1.check_for_duplicate_sender!=s2.check_for_duplicate_sender)
         return false;
+    if (s1.lock_free_buffer!=s2.lock_free_buffer)
+        return false;
+    if (s1.zero_copy_receive!=s2.zero_copy_receive)
+        return false;
+    if (s1.receive_backend!=s2.receive_backend)
+        return false;
+    if (s1.wait_policy!=s2.wait_policy)
+        return false;
+    if (s1.spin_time!=s2.spin_time)
+        return false;
+    if (s1.busy_poll_time!=s2.busy_poll_time)
+        return false;
+    if (s1.num_socket_readers!=s2.num_socket_readers)
+        return false;
+    if (s1.udp_gro!=s2.udp_gro)
+        return false;
+    if (s1.auto_tune!=s2.auto_tune)
+        return false;
+    if (s1.min_pkts_per_socket_read!=s2.min_pkts_per_socket_read)
+        return false;
+    if (s1.max_pkts_per_socket_read!=s2.max_pkts_per_socket_read)
+        return false;
+    if (s1.min_sdds_pkts_per_bulkio_push!=s2.min_sdds_pkts_per_bulkio_push)
+        return false;
+    if (s1.max_sdds_pkts_per_bulkio_push!=s2.max_sdds_pkts_per_bulkio_push)
+        return false;
+    if (s1.shared_reader_threads!=s2.shared_reader_threads)
+        return false;
+    if (s1.shared_reader_budget!=s2.shared_reader_budget)
+        return false;
+    if (s1.max_attached_streams!=s2.max_attached_streams)
+        return false;
+    if (s1.stream_worker_threads!=s2.stream_worker_threads)
+        return false;
+    if (s1.conversion_threads!=s2.conversion_threads)
+        return false;
+    if (s1.run_to_completion!=s2.run_to_completion)
+        return false;
+    if (s1.huge_page_buffer!=s2.huge_page_buffer)
+        return false;
+    if (s1.lock_buffer_memory!=s2.lock_buffer_memory)
+        return false;
+    if (s1.numa_placement!=s2.numa_placement)
+        return false;
+    if (s1.real_time_mode!=s2.real_time_mode)
+        return false;
+    if (s1.real_time_priority!=s2.real_time_priority)
+        return false;
+    if (s1.overflow_policy!=s2.overflow_policy)
+        return false;
+    if (s1.max_buffer_memory!=s2.max_buffer_memory)
+        return false;
     return true;
 }
 
@@ -286,6 +520,24 @@ struct status_struct {
         time_slips = 0LL;
         num_packets_dropped_by_nic = 0;
         interface = "";
+        socket_reader_spin_time = 0;
+        socket_reader_busy_poll_time = 0;
+        socket_reader_blocked_time = 0;
+        gro_coalescing_ratio = 0.0;
+        buffer_page_size = "";
+        buffer_locked_bytes = 0;
+        nic_numa_node = -1;
+        buffer_numa_node = -1;
+        real_time_status = "";
+        overflow_dropped_newest = 0;
+        overflow_reclaimed_oldest = 0;
+        buffer_capacity = 0;
+        buffer_capacity_high_water = 0;
+        buffer_reused = false;
+        start_latency = 0;
+        byte_swap_kernel = "";
+        sri_changes = 0;
+        receive_backend_in_use = "";
     };
 
     static std::string getId() {
@@ -308,6 +560,24 @@ struct status_struct {
     CORBA::LongLong time_slips;
     CORBA::Long num_packets_dropped_by_nic;
     std::string interface;
+    CORBA::ULongLong socket_reader_spin_time;
+    CORBA::ULongLong socket_reader_busy_poll_time;
+    CORBA::ULongLong socket_reader_blocked_time;
+    double gro_coalescing_ratio;
+    std::string buffer_page_size;
+    CORBA::ULongLong buffer_locked_bytes;
+    CORBA::Long nic_numa_node;
+    CORBA::Long buffer_numa_node;
+    std::string real_time_status;
+    CORBA::ULongLong overflow_dropped_newest;
+    CORBA::ULongLong overflow_reclaimed_oldest;
+    CORBA::ULongLong buffer_capacity;
+    CORBA::ULongLong buffer_capacity_high_water;
+    bool buffer_reused;
+    CORBA::ULongLong start_latency;
+    std::string byte_swap_kernel;
+    CORBA::ULongLong sri_changes;
+    std::string receive_backend_in_use;
 };
 
 inline bool operator>>= (const CORBA::Any& a, status_struct& s) {
@@ -362,6 +632,60 @@ inline bool operator>>= (const CORBA::Any& a, status_struct& s) {
     if (props.contains("status::interface")) {
         if (!(props["status::interface"] >>= s.interface)) return false;
     }
+    if (props.contains("status::socket_reader_spin_time")) {
+        if (!(props["status::socket_reader_spin_time"] >>= s.socket_reader_spin_time)) return false;
+    }
+    if (props.contains("status::socket_reader_busy_poll_time")) {
+        if (!(props["status::socket_reader_busy_poll_time"] >>= s.socket_reader_busy_poll_time)) return false;
+    }
+    if (props.contains("status::socket_reader_blocked_time")) {
+        if (!(props["status::socket_reader_blocked_time"] >>= s.socket_reader_blocked_time)) return false;
+    }
+    if (props.contains("status::gro_coalescing_ratio")) {
+        if (!(props["status::gro_coalescing_ratio"] >>= s.gro_coalescing_ratio)) return false;
+    }
+    if (props.contains("status::buffer_page_size")) {
+        if (!(props["status::buffer_page_size"] >>= s.buffer_page_size)) return false;
+    }
+    if (props.contains("status::buffer_locked_bytes")) {
+        if (!(props["status::buffer_locked_bytes"] >>= s.buffer_locked_bytes)) return false;
+    }
+    if (props.contains("status::nic_numa_node")) {
+        if (!(props["status::nic_numa_node"] >>= s.nic_numa_node)) return false;
+    }
+    if (props.contains("status::buffer_numa_node")) {
+        if (!(props["status::buffer_numa_node"] >>= s.buffer_numa_node)) return false;
+    }
+    if (props.contains("status::real_time_status")) {
+        if (!(props["status::real_time_status"] >>= s.real_time_status)) return false;
+    }
+    if (props.contains("status::overflow_dropped_newest")) {
+        if (!(props["status::overflow_dropped_newest"] >>= s.overflow_dropped_newest)) return false;
+    }
+    if (props.contains("status::overflow_reclaimed_oldest")) {
+        if (!(props["status::overflow_reclaimed_oldest"] >>= s.overflow_reclaimed_oldest)) return false;
+    }
+    if (props.contains("status::buffer_capacity")) {
+        if (!(props["status::buffer_capacity"] >>= s.buffer_capacity)) return false;
+    }
+    if (props.contains("status::buffer_capacity_high_water")) {
+        if (!(props["status::buffer_capacity_high_water"] >>= s.buffer_capacity_high_water)) return false;
+    }
+    if (props.contains("status::buffer_reused")) {
+        if (!(props["status::buffer_reused"] >>= s.buffer_reused)) return false;
+    }
+    if (props.contains("status::start_latency")) {
+        if (!(props["status::start_latency"] >>= s.start_latency)) return false;
+    }
+    if (props.contains("status::byte_swap_kernel")) {
+        if (!(props["status::byte_swap_kernel"] >>= s.byte_swap_kernel)) return false;
+    }
+    if (props.contains("status::sri_changes")) {
+        if (!(props["status::sri_changes"] >>= s.sri_changes)) return false;
+    }
+    if (props.contains("status::receive_backend_in_use")) {
+        if (!(props["status::receive_backend_in_use"] >>= s.receive_backend_in_use)) return false;
+    }
     return true;
 }
 
@@ -399,6 +723,42 @@ inline void operator<<= (CORBA::Any& a, const status_struct& s) {
     props["status::num_packets_dropped_by_nic"] = s.num_packets_dropped_by_nic;
  
     props["status::interface"] = s.interface;
+ 
+    props["status::socket_reader_spin_time"] = s.socket_reader_spin_time;
+ 
+    props["status::socket_reader_busy_poll_time"] = s.socket_reader_busy_poll_time;
+ 
+    props["status::socket_reader_blocked_time"] = s.socket_reader_blocked_time;
+ 
+    props["status::gro_coalescing_ratio"] = s.gro_coalescing_ratio;
+ 
+    props["status::buffer_page_size"] = s.buffer_page_size;
+ 
+    props["status::buffer_locked_bytes"] = s.buffer_locked_bytes;
+ 
+    props["status::nic_numa_node"] = s.nic_numa_node;
+ 
+    props["status::buffer_numa_node"] = s.buffer_numa_node;
+ 
+    props["status::real_time_status"] = s.real_time_status;
+ 
+    props["status::overflow_dropped_newest"] = s.overflow_dropped_newest;
+ 
+    props["status::overflow_reclaimed_oldest"] = s.overflow_reclaimed_oldest;
+ 
+    props["status::buffer_capacity"] = s.buffer_capacity;
+ 
+    props["status::buffer_capacity_high_water"] = s.buffer_capacity_high_water;
+ 
+    props["status::buffer_reused"] = s.buffer_reused;
+ 
+    props["status::start_latency"] = s.start_latency;
+ 
+    props["status::byte_swap_kernel"] = s.byte_swap_kernel;
+ 
+    props["status::sri_changes"] = s.sri_changes;
+ 
+    props["status::receive_backend_in_use"] = s.receive_backend_in_use;
     a <<= props;
 }
 
@@ -435,6 +795,42 @@ inline bool operator== (const status_struct& s1, const status_struct& s2) {
         return false;
     if (s1.interface!=s2.interface)
         return false;
+    if (s1.socket_reader_spin_time!=s2.socket_reader_spin_time)
+        return false;
+    if (s1.socket_reader_busy_poll_time!=s2.socket_reader_busy_poll_time)
+        return false;
+    if (s1.socket_reader_blocked_time!=s2.socket_reader_blocked_time)
+        return false;
+    if (s1.gro_coalescing_ratio!=s2.gro_coalescing_ratio)
+        return false;
+    if (s1.buffer_page_size!=s2.buffer_page_size)
+        return false;
+    if (s1.buffer_locked_bytes!=s2.buffer_locked_bytes)
+        return false;
+    if (s1.nic_numa_node!=s2.nic_numa_node)
+        return false;
+    if (s1.buffer_numa_node!=s2.buffer_numa_node)
+        return false;
+    if (s1.real_time_status!=s2.real_time_status)
+        return false;
+    if (s1.overflow_dropped_newest!=s2.overflow_dropped_newest)
+        return false;
+    if (s1.overflow_reclaimed_oldest!=s2.overflow_reclaimed_oldest)
+        return false;
+    if (s1.buffer_capacity!=s2.buffer_capacity)
+        return false;
+    if (s1.buffer_capacity_high_water!=s2.buffer_capacity_high_water)
+        return false;
+    if (s1.buffer_reused!=s2.buffer_reused)
+        return false;
+    if (s1.start_latency!=s2.start_latency)
+        return false;
+    if (s1.byte_swap_kernel!=s2.byte_swap_kernel)
+        return false;
+    if (s1.sri_changes!=s2.sri_changes)
+        return false;
+    if (s1.receive_backend_in_use!=s2.receive_backend_in_use)
+        return false;
     return true;
 }
 
@@ -442,4 +838,133 @@ inline bool operator!= (const status_struct& s1, const status_struct& s2) {
     return !(s1==s2);
 }
 
+struct stream_status_entry_struct {
+    stream_status_entry_struct ()
+    {
+        attach_id = "";
+        input_stream_id = "";
+        input_address = "";
+        input_port = 0;
+        input_vlan = 0;
+        bits_per_sample = 0;
+        expected_sequence_number = 0;
+        dropped_packets = 0;
+        time_slips = 0LL;
+        buffers_to_work = "";
+        empty_buffers_available = "";
+    };
+
+    static std::string getId() {
+        return std::string("stream_status::stream_status_entry");
+    };
+
+    std::string attach_id;
+    std::string input_stream_id;
+    std::string input_address;
+    CORBA::Long input_port;
+    CORBA::Long input_vlan;
+    unsigned short bits_per_sample;
+    unsigned short expected_sequence_number;
+    CORBA::ULong dropped_packets;
+    CORBA::LongLong time_slips;
+    std::string buffers_to_work;
+    std::string empty_buffers_available;
+};
+
+inline bool operator>>= (const CORBA::Any& a, stream_status_entry_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("stream_status::attach_id")) {
+        if (!(props["stream_status::attach_id"] >>= s.attach_id)) return false;
+    }
+    if (props.contains("stream_status::input_stream_id")) {
+        if (!(props["stream_status::input_stream_id"] >>= s.input_stream_id)) return false;
+    }
+    if (props.contains("stream_status::input_address")) {
+        if (!(props["stream_status::input_address"] >>= s.input_address)) return false;
+    }
+    if (props.contains("stream_status::input_port")) {
+        if (!(props["stream_status::input_port"] >>= s.input_port)) return false;
+    }
+    if (props.contains("stream_status::input_vlan")) {
+        if (!(props["stream_status::input_vlan"] >>= s.input_vlan)) return false;
+    }
+    if (props.contains("stream_status::bits_per_sample")) {
+        if (!(props["stream_status::bits_per_sample"] >>= s.bits_per_sample)) return false;
+    }
+    if (props.contains("stream_status::expected_sequence_number")) {
+        if (!(props["stream_status::expected_sequence_number"] >>= s.expected_sequence_number)) return false;
+    }
+    if (props.contains("stream_status::dropped_packets")) {
+        if (!(props["stream_status::dropped_packets"] >>= s.dropped_packets)) return false;
+    }
+    if (props.contains("stream_status::time_slips")) {
+        if (!(props["stream_status::time_slips"] >>= s.time_slips)) return false;
+    }
+    if (props.contains("stream_status::buffers_to_work")) {
+        if (!(props["stream_status::buffers_to_work"] >>= s.buffers_to_work)) return false;
+    }
+    if (props.contains("stream_status::empty_buffers_available")) {
+        if (!(props["stream_status::empty_buffers_available"] >>= s.empty_buffers_available)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const stream_status_entry_struct& s) {
+    redhawk::PropertyMap props;
+    props["stream_status::attach_id"] = s.attach_id;
+ 
+    props["stream_status::input_stream_id"] = s.input_stream_id;
+ 
+    props["stream_status::input_address"] = s.input_address;
+ 
+    props["stream_status::input_port"] = s.input_port;
+ 
+    props["stream_status::input_vlan"] = s.input_vlan;
+ 
+    props["stream_status::bits_per_sample"] = s.bits_per_sample;
+ 
+    props["stream_status::expected_sequence_number"] = s.expected_sequence_number;
+ 
+    props["stream_status::dropped_packets"] = s.dropped_packets;
+ 
+    props["stream_status::time_slips"] = s.time_slips;
+ 
+    props["stream_status::buffers_to_work"] = s.buffers_to_work;
+ 
+    props["stream_status::empty_buffers_available"] = s.empty_buffers_available;
+    a <<= props;
+}
+
+inline bool operator== (const stream_status_entry_struct& s1, const stream_status_entry_struct& s2) {
+    if (s1.attach_id!=s2.attach_id)
+        return false;
+    if (s1.input_stream_id!=s2.input_stream_id)
+        return false;
+    if (s1.input_address!=s2.input_address)
+        return false;
+    if (s1.input_port!=s2.input_port)
+        return false;
+    if (s1.input_vlan!=s2.input_vlan)
+        return false;
+    if (s1.bits_per_sample!=s2.bits_per_sample)
+        return false;
+    if (s1.expected_sequence_number!=s2.expected_sequence_number)
+        return false;
+    if (s1.dropped_packets!=s2.dropped_packets)
+        return false;
+    if (s1.time_slips!=s2.time_slips)
+        return false;
+    if (s1.buffers_to_work!=s2.buffers_to_work)
+        return false;
+    if (s1.empty_buffers_available!=s2.empty_buffers_available)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const stream_status_entry_struct& s1, const stream_status_entry_struct& s2) {
+    return !(s1==s2);
+}
+
 #endif // STRUCTPROPS_H
@@ -21,6 +21,7 @@ import unittest
 import ossie.utils.testing
 from ossie.cf import CF
 import os
+import resource
 import socket
 import struct
 import sys
@@ -97,6 +98,45 @@ class ComponentTests(ossie.utils.testing.ScaComponentTestCase):
         
         self.assertTrue(self.attachId != '', "Failed to attach to SourceSDDS component")
         
+    def sendAndCheck(self, sink, num_pkts, first=0, delay=0, batch=1):
+        """Sends num_pkts SDDS short packets, starting from packet number first, and checks the sink received all of
+        their samples in order with none dropped. Each packet holds its packet number plus the sample offset. A delay is
+        slept after each packet so a slow component can keep up. A batch of more than one sends that many packets at a
+        time as a single UDP GSO super datagram."""
+        gso = None
+        if batch > 1:
+            # UDP_SEGMENT, on loopback the datagram reaches a UDP_GRO socket without being split
+            gso = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+            gso.setsockopt(socket.IPPROTO_UDP, 103, 1080)
+
+        expected = []
+        pending = ''
+        for num_sent in range(first, first + num_pkts):
+            fakeData = [(num_sent + x) % 65536 for x in range(0, 512)]
+            expected.extend(fakeData)
+            # Every 32nd sequence number is skipped, as it is for the SDDS parity packet
+            h = Sdds.SddsHeader(num_sent + num_sent // 31)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            if gso is None:
+                self.userver.send(p.encodedPacket)
+            else:
+                pending += p.encodedPacket
+                if (num_sent - first + 1) % batch == 0:
+                    gso.sendto(pending, (self.uni_ip, self.port))
+                    pending = ''
+            if delay:
+                time.sleep(delay)
+        if gso is not None:
+            gso.close()
+
+        time.sleep(1)
+        data = sink.getData()
+
+        self.assertEqual(len(data), num_pkts * 512)
+        self.assertEqual(self.comp.status.dropped_packets, 0)
+        self.assertEqual(expected, list(struct.unpack('>%dH' % len(data), struct.pack('>%dH' % len(data), *data))))
+
     def testScaBasicBehavior(self):
         """Basic test, start, stop and query component"""
         self.setupComponent()
@@ -732,6 +772,523 @@ class ComponentTests(ossie.utils.testing.ScaComponentTestCase):
             self.assertTrue(diff in available, "Expected " + diff + " empty buffers available but received " + available)
             self.comp.stop()
 
+    def testLockFreeBuffer(self):
+        """Sends a run of packets through the lock free buffer and confirms they all arrive in order"""
+        self.setupComponent(pkts_per_push=4)
+        self.comp.advanced_optimizations.lock_free_buffer = True
+        self.comp.advanced_optimizations.buffer_size = 500
+        self.comp.advanced_optimizations.pkts_per_socket_read = 10
+
+        sink = sb.DataSink()
+        self.comp.connect(sink, providesPortName='shortIn')
+        self.comp.start()
+        sink.start()
+
+        diff = str(500 - 10)
+        available = self.comp.status.empty_buffers_available
+        self.assertTrue(diff in available, "Expected " + diff + " empty buffers available but received " + available)
+
+        self.sendAndCheck(sink, 64)
+        self.assertTrue(self.comp.advanced_optimizations.lock_free_buffer)
+        self.comp.stop()
+        sink.stop()
+
+    def testZeroCopyReceive(self):
+        """Sends enough packets to wrap the packet pool a few times with zero copy receive enabled and confirms the data is intact"""
+        self.setupComponent(pkts_per_push=4)
+        self.comp.advanced_optimizations.zero_copy_receive = True
+        # Not a multiple of the push size so that some pushes straddle the end of the pool
+        self.comp.advanced_optimizations.buffer_size = 98
+        self.comp.advanced_optimizations.pkts_per_socket_read = 10
+
+        sink = sb.DataSink()
+        self.comp.connect(sink, providesPortName='shortIn')
+        self.comp.start()
+        sink.start()
+
+        # Give the component a chance to keep up, the pool is small
+        self.sendAndCheck(sink, 256, delay=0.001)
+        self.assertTrue(self.comp.advanced_optimizations.zero_copy_receive)
+        self.comp.stop()
+        sink.stop()
+
+    def testPacketMmapBackend(self):
+        """Receives through the AF_PACKET ring, skipped if the reader fell back to recvmmsg without CAP_NET_RAW"""
+        self.setupComponent()
+        self.comp.advanced_optimizations.receive_backend = "packet_mmap"
+
+        sink = sb.DataSink()
+        self.comp.connect(sink, providesPortName='shortIn')
+        self.comp.start()
+        sink.start()
+
+        # Lets the reader thread get through setting up the ring or falling back before the backend is checked
+        self.sendAndCheck(sink, 1)
+        if self.comp.status.receive_backend_in_use != "packet_mmap":
+            self.comp.stop()
+            sink.stop()
+            self.skipTest("The packet_mmap receive backend could not be used, it needs CAP_NET_RAW")
+
+        self.sendAndCheck(sink, 63, first=1)
+        self.assertEqual(self.comp.advanced_optimizations.receive_backend, "packet_mmap")
+        self.assertEqual(self.comp.status.receive_backend_in_use, "packet_mmap")
+        self.comp.stop()
+        sink.stop()
+
+    def testIoUringBackend(self):
+        """Receives with the io_uring multishot receive, skipped if the reader fell back to recvmmsg on an older kernel"""
+        self.setupComponent()
+        self.comp.advanced_optimizations.receive_backend = "io_uring"
+
+        sink = sb.DataSink()
+        self.comp.connect(sink, providesPortName='shortIn')
+        self.comp.start()
+        sink.start()
+
+        # Lets the reader thread get through setting up the io_uring or falling back before the backend is checked
+        self.sendAndCheck(sink, 1)
+        if self.comp.status.receive_backend_in_use != "io_uring":
+            self.comp.stop()
+            sink.stop()
+            self.skipTest("The io_uring receive backend could not be used, it needs Linux 6.0 or later")
+
+        self.sendAndCheck(sink, 63, first=1)
+        self.assertEqual(self.comp.advanced_optimizations.receive_backend, "io_uring")
+        self.assertEqual(self.comp.status.receive_backend_in_use, "io_uring")
+        self.comp.stop()
+        sink.stop()
+
+    def testWaitPolicy(self):
+        """Sends packets slowly under each wait policy, confirms none are lost and the time spent waiting is accounted for"""
+        self.setupComponent()
+        for policy in ("poll", "adaptive"):
+            self.comp.advanced_optimizations.wait_policy = policy
+
+            sink = sb.DataSink()
+            self.comp.connect(sink, providesPortName='shortIn')
+            self.comp.start()
+            sink.start()
+
+            seq = 0
+            for num_sent in range(0, 20):
+                h = Sdds.SddsHeader(seq)
+                p = Sdds.SddsShortPacket(h.header, [num_sent] * 512)
+                p.encode()
+                self.userver.send(p.encodedPacket)
+                seq = seq + 1
+                time.sleep(0.01)
+
+            time.sleep(0.5)
+            data = sink.getData()
+
+            self.assertEqual(len(data), 20 * 512)
+            self.assertEqual(self.comp.status.dropped_packets, 0)
+            self.assertEqual(self.comp.advanced_optimizations.wait_policy, policy)
+            # Packets are 10 ms apart so the reader must have spent most of its time asleep
+            self.assertTrue(self.comp.status.socket_reader_blocked_time > 100000)
+            if policy == "poll":
+                self.assertEqual(self.comp.status.socket_reader_spin_time, 0)
+
+            self.comp.stop()
+            sink.stop()
+
+    def testMultipleSocketReaders(self):
+        """Shares the stream between three socket readers, the packets must be merged back into order with none lost"""
+        self.setupComponent()
+        self.comp.advanced_optimizations.num_socket_readers = 3
+
+        sink = sb.DataSink()
+        self.comp.connect(sink, providesPortName='shortIn')
+        self.comp.start()
+        sink.start()
+
+        # Enough packets for each reader to get several runs of 32 sequence numbers
+        self.sendAndCheck(sink, 400)
+        self.assertEqual(self.comp.status.num_udp_socket_readers, 3)
+        self.assertEqual(self.comp.advanced_optimizations.num_socket_readers, 3)
+        self.comp.stop()
+        sink.stop()
+
+    def testUdpGro(self):
+        """Sends the packets in batches as UDP GSO super datagrams, the reader must split them back up and report the coalescing"""
+        self.setupComponent()
+        self.comp.advanced_optimizations.udp_gro = True
+
+        sink = sb.DataSink()
+        self.comp.connect(sink, providesPortName='shortIn')
+        self.comp.start()
+        sink.start()
+
+        self.sendAndCheck(sink, 256, batch=16)
+        self.assertTrue(self.comp.status.gro_coalescing_ratio > 1.0)
+        self.assertEqual(self.comp.advanced_optimizations.udp_gro, True)
+        self.comp.stop()
+        sink.stop()
+
+    def testAutoTune(self):
+        """Trickles packets in with auto tuning on, both sizes must shrink within their bounds and no data may be lost"""
+        self.setupComponent(pkts_per_push=64)
+        self.comp.advanced_optimizations.auto_tune = True
+        self.comp.advanced_optimizations.min_pkts_per_socket_read = 8
+        self.comp.advanced_optimizations.max_pkts_per_socket_read = 64
+        self.comp.advanced_optimizations.min_sdds_pkts_per_bulkio_push = 8
+        self.comp.advanced_optimizations.max_sdds_pkts_per_bulkio_push = 64
+
+        sink = sb.DataSink()
+        self.comp.connect(sink, providesPortName='shortIn')
+        self.comp.start()
+        sink.start()
+
+        # Every size the tuner can pick from these bounds divides the packet count, so nothing is left waiting for a push
+        self.sendAndCheck(sink, 256, delay=0.01)
+        self.assertTrue(8 <= self.comp.advanced_optimizations.pkts_per_socket_read < 64)
+        self.assertTrue(8 <= self.comp.advanced_optimizations.sdds_pkts_per_bulkio_push < 64)
+        self.comp.stop()
+        sink.stop()
+
+    def testSharedReader(self):
+        """Reads the socket from the shared reader engine in place of a socket reader thread, no data may be lost"""
+        self.setupComponent()
+        self.comp.advanced_optimizations.shared_reader_threads = 1
+        self.comp.advanced_optimizations.shared_reader_budget = 16
+
+        sink = sb.DataSink()
+        self.comp.connect(sink, providesPortName='shortIn')
+        self.comp.start()
+        sink.start()
+
+        self.sendAndCheck(sink, 400)
+        self.assertEqual(self.comp.advanced_optimizations.shared_reader_threads, 1)
+        # The engine reads with recvmmsg whatever receive_backend is set to
+        self.assertEqual(self.comp.status.receive_backend_in_use, "recvmmsg")
+
+        # Stopping hands the socket back, starting again must attach to the engine anew
+        self.comp.stop()
+        self.comp.start()
+        self.comp.stop()
+        sink.stop()
+
+    def testMultipleAttachedStreams(self):
+        """Attaches a second stream to the same instance, both streams must be output in full on their own stream IDs"""
+        self.setupComponent()
+        self.comp.advanced_optimizations.max_attached_streams = 2
+        self.comp.advanced_optimizations.stream_worker_threads = 1
+
+        compDataSddsIn = self.comp.getPort('dataSddsIn')
+        streamDef = BULKIO.SDDSStreamDefinition('second', BULKIO.SDDS_SI, self.uni_ip, 0, self.port + 1, 8000, True, 'testing')
+        secondId = compDataSddsIn.attach(streamDef, 'test')
+        self.assertEqual(secondId, 'second')
+        userver2 = unicast.unicast_server(self.uni_ip, self.port + 1)
+
+        # A third stream is more than max_attached_streams allows
+        streamDef = BULKIO.SDDSStreamDefinition('third', BULKIO.SDDS_SI, self.uni_ip, 0, self.port + 2, 8000, True, 'testing')
+        self.assertRaises(BULKIO.dataSDDS.AttachError, compDataSddsIn.attach, streamDef, 'test')
+
+        sink = sb.DataSink()
+        self.comp.connect(sink, providesPortName='shortIn')
+        self.comp.start()
+        sink.start()
+
+        seq = 0
+        for num_sent in range(0, 64):
+            fakeData = [(num_sent + x) % 65536 for x in range(0, 512)]
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            userver2.send(p.encodedPacket)
+            seq = seq + 1
+            if seq != 0 and seq % 32 == 31:
+                seq = seq + 1
+
+        time.sleep(1)
+        data = sink.getData()
+        self.assertEqual(len(data), 2 * 64 * 512)
+
+        stream_status = self.comp.stream_status
+        self.assertEqual(len(stream_status), 2)
+        self.assertEqual(stream_status[0].attach_id, self.attachId)
+        self.assertEqual(stream_status[1].attach_id, 'second')
+        self.assertEqual(stream_status[1].input_stream_id, 'second')
+        self.assertEqual(stream_status[1].input_port, self.port + 1)
+        for entry in stream_status:
+            self.assertEqual(entry.dropped_packets, 0)
+
+        # Detaching the second stream leaves the first running
+        compDataSddsIn.detach(secondId)
+        self.assertEqual(len(self.comp.stream_status), 1)
+
+        # Once the first stream is detached it can not be attached again with the ID of a stream attached after it
+        streamDef = BULKIO.SDDSStreamDefinition('second', BULKIO.SDDS_SI, self.uni_ip, 0, self.port + 1, 8000, True, 'testing')
+        compDataSddsIn.attach(streamDef, 'test')
+        compDataSddsIn.detach(self.attachId)
+        streamDef = BULKIO.SDDSStreamDefinition('second', BULKIO.SDDS_SI, self.uni_ip, 0, self.port, 8000, True, 'testing')
+        self.assertRaises(BULKIO.dataSDDS.AttachError, compDataSddsIn.attach, streamDef, 'test')
+        compDataSddsIn.detach('second')
+        self.comp.stop()
+        sink.stop()
+
+    def testConversionThreads(self):
+        """Copies and byte swaps on conversion threads, the output must be in order and identical to converting on one thread"""
+        self.setupComponent(pkts_per_push=8)
+        self.comp.advanced_optimizations.conversion_threads = 2
+
+        sink = sb.DataSink()
+        self.comp.connect(sink, providesPortName='shortIn')
+        self.comp.start()
+        sink.start()
+
+        self.sendAndCheck(sink, 400)
+
+        # Cannot be changed while running
+        self.comp.advanced_optimizations.conversion_threads = 4
+        self.assertEqual(self.comp.advanced_optimizations.conversion_threads, 2)
+        self.comp.stop()
+        sink.stop()
+
+    def testRunToCompletion(self):
+        """Reads, processes and pushes on one thread, a packet must be pushed without waiting for a full push"""
+        self.setupComponent(pkts_per_push=16)
+        self.comp.advanced_optimizations.run_to_completion = True
+
+        sink = sb.DataSink()
+        self.comp.connect(sink, providesPortName='shortIn')
+        self.comp.start()
+        sink.start()
+
+        # The first packet alone is far short of a push
+        self.sendAndCheck(sink, 1)
+        self.sendAndCheck(sink, 63, first=1)
+        self.comp.stop()
+        sink.stop()
+
+    def testBufferMemory(self):
+        """The internal buffer reports the page size backing it and how much of it is locked"""
+        self.setupComponent()
+        self.comp.advanced_optimizations.buffer_size = 20000
+        self.comp.start()
+
+        # Huge pages and locking are asked for by default but depend on the system, they may fall back
+        self.assertTrue(' kB' in self.comp.status.buffer_page_size)
+        self.assertTrue(self.comp.status.buffer_locked_bytes == 0 or self.comp.status.buffer_locked_bytes >= 20000 * 1080)
+        self.comp.stop()
+
+        self.comp.advanced_optimizations.huge_page_buffer = False
+        self.comp.advanced_optimizations.lock_buffer_memory = False
+        self.comp.start()
+        self.assertEqual(self.comp.status.buffer_page_size, '%d kB' % (resource.getpagesize() / 1024))
+        self.assertEqual(self.comp.status.buffer_locked_bytes, 0)
+        self.comp.stop()
+
+    def testNumaPlacement(self):
+        """The loopback has no NUMA node so nothing is placed, the buffer still reports the node it is on"""
+        self.setupComponent()
+        self.comp.advanced_optimizations.numa_placement = True
+        self.comp.start()
+
+        self.assertEqual(self.comp.status.nic_numa_node, -1)
+        self.assertTrue(self.comp.status.buffer_numa_node >= -1)
+        self.assertNotEqual(self.comp.advanced_optimizations.socket_read_thread_affinity, '')
+
+        self.comp.advanced_optimizations.numa_placement = False
+        self.assertEqual(self.comp.advanced_optimizations.numa_placement, True)
+        self.comp.stop()
+
+    def testThreadAffinitySyntax(self):
+        """The thread affinity takes a cpu list as well as a mask, and auto must still start when no interrupts are found"""
+        self.setupComponent()
+        self.comp.advanced_optimizations.socket_read_thread_affinity = '0-0'
+        self.comp.advanced_optimizations.sdds_to_bulkio_thread_affinity = 'auto'
+        self.comp.start()
+
+        self.assertEqual(self.comp.advanced_optimizations.socket_read_thread_affinity, '1')
+        self.assertNotEqual(self.comp.advanced_optimizations.sdds_to_bulkio_thread_affinity, 'auto')
+        self.comp.stop()
+
+    def testRealTimeMode(self):
+        """Real time mode must start and pass data whatever privileges it has, reporting what it could not apply"""
+        self.setupComponent()
+        self.comp.advanced_optimizations.real_time_priority = 100
+        self.assertEqual(self.comp.advanced_optimizations.real_time_priority, 50)
+        self.comp.advanced_optimizations.real_time_mode = True
+
+        sink = sb.DataSink()
+        self.comp.connect(sink, providesPortName='shortIn')
+        self.assertEqual(self.comp.status.real_time_status, '')
+        self.comp.start()
+        sink.start()
+
+        status = self.comp.status.real_time_status
+        self.assertTrue(status == 'applied' or status.startswith('not applied: '), status)
+
+        self.sendAndCheck(sink, 31)
+
+        self.comp.advanced_optimizations.real_time_mode = False
+        self.assertEqual(self.comp.advanced_optimizations.real_time_mode, True)
+        self.comp.stop()
+        sink.stop()
+
+    def testOverflowPolicy(self):
+        """An unknown overflow policy is refused, and a policy must not drop anything while the processor keeps up"""
+        self.setupComponent()
+        self.comp.advanced_optimizations.overflow_policy = 'drop_oldest'
+        self.assertEqual(self.comp.advanced_optimizations.overflow_policy, 'block')
+        self.comp.advanced_optimizations.overflow_policy = 'reclaim_oldest'
+        self.assertEqual(self.comp.advanced_optimizations.overflow_policy, 'reclaim_oldest')
+
+        sink = sb.DataSink()
+        self.comp.connect(sink, providesPortName='shortIn')
+        self.comp.start()
+        sink.start()
+
+        self.sendAndCheck(sink, 31)
+        self.assertEqual(self.comp.status.overflow_dropped_newest, 0)
+        self.assertEqual(self.comp.status.overflow_reclaimed_oldest, 0)
+
+        self.comp.advanced_optimizations.overflow_policy = 'drop_newest'
+        self.assertEqual(self.comp.advanced_optimizations.overflow_policy, 'reclaim_oldest')
+        self.comp.stop()
+        sink.stop()
+
+    def testOverflowPolicyDrops(self):
+        """Overruns a small buffer under each policy, the drops must be whole pushes and the packets let through in order"""
+        self.setupComponent(pkts_per_push=4)
+        self.comp.advanced_optimizations.buffer_size = 32
+        self.comp.advanced_optimizations.pkts_per_socket_read = 4
+
+        # Encoded up front so they go out far faster than the processor can push them to the sink four at a time
+        num_pkts = 4000
+        packets = []
+        for num_sent in range(0, num_pkts):
+            fakeData = [(num_sent + x) % 65536 for x in range(0, 512)]
+            h = Sdds.SddsHeader(num_sent + num_sent // 31)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            packets.append(p.encodedPacket)
+
+        for policy, counter in (('drop_newest', 'overflow_dropped_newest'), ('reclaim_oldest', 'overflow_reclaimed_oldest')):
+            self.comp.advanced_optimizations.overflow_policy = policy
+
+            sink = sb.DataSink()
+            self.comp.connect(sink, providesPortName='shortIn')
+            self.comp.start()
+            sink.start()
+
+            for packet in packets:
+                self.userver.send(packet)
+
+            time.sleep(2)
+            data = sink.getData()
+            dropped = self.comp.status.overflow_dropped_newest
+            reclaimed = self.comp.status.overflow_reclaimed_oldest
+
+            self.assertTrue(getattr(self.comp.status, counter) > 0, policy + " did not drop anything")
+            self.assertEqual(dropped % 4, 0)
+            self.assertEqual(reclaimed % 4, 0)
+            self.assertEqual(len(data), (num_pkts - dropped - reclaimed) * 512)
+
+            # Each packet let through is whole and comes after the one before it. The newest are dropped as they are
+            # read, counted off in pushes from the first packet, so those gaps are whole pushes on push boundaries.
+            data = struct.unpack('>%dH' % len(data), struct.pack('>%dH' % len(data), *data))
+            last = -1
+            for i in range(0, len(data), 512):
+                num = data[i]
+                self.assertTrue(num > last, "Packet " + str(num) + " came after packet " + str(last))
+                self.assertEqual(list(data[i:i + 512]), [(num + x) % 65536 for x in range(0, 512)])
+                if policy == 'drop_newest' and num != last + 1:
+                    self.assertEqual(num % 4, 0)
+                last = num
+
+            self.comp.stop()
+            sink.stop()
+
+    def testElasticBuffer(self):
+        """An elastic buffer starts at buffer_size, stays there while the processor keeps up and its cap cannot change while running"""
+        self.setupComponent()
+        self.comp.advanced_optimizations.buffer_size = 1000
+        self.comp.advanced_optimizations.max_buffer_memory = 4000 * 1080
+
+        sink = sb.DataSink()
+        self.comp.connect(sink, providesPortName='shortIn')
+        self.comp.start()
+        sink.start()
+        self.assertEqual(self.comp.status.buffer_capacity, 1000)
+
+        self.sendAndCheck(sink, 31)
+        self.assertEqual(self.comp.status.buffer_capacity, 1000)
+        self.assertEqual(self.comp.status.buffer_capacity_high_water, 1000)
+
+        self.comp.advanced_optimizations.max_buffer_memory = 0
+        self.assertEqual(self.comp.advanced_optimizations.max_buffer_memory, 4000 * 1080)
+        self.comp.stop()
+        sink.stop()
+
+    def testElasticBufferGrows(self):
+        """Holds an elastic buffer below its low watermark for a while, it must grow past buffer_size but no further than its cap"""
+        self.setupComponent(pkts_per_push=95)
+        self.comp.advanced_optimizations.buffer_size = 100
+        self.comp.advanced_optimizations.pkts_per_socket_read = 4
+        self.comp.advanced_optimizations.max_buffer_memory = 150 * 1080
+
+        sink = sb.DataSink()
+        self.comp.connect(sink, providesPortName='shortIn')
+        self.comp.start()
+        sink.start()
+        self.assertEqual(self.comp.status.buffer_capacity, 100)
+
+        # The processor holds on to the packets of a push until it is complete, so the last ten or so packets of the
+        # push leave fewer than an eighth of the buffers empty, and spread out they do so for well over ELASTIC_PRESSURE_MS
+        self.sendAndCheck(sink, 95, delay=0.005)
+
+        capacity = self.comp.status.buffer_capacity
+        high_water = self.comp.status.buffer_capacity_high_water
+        self.assertTrue(100 < capacity <= 150, "Expected the buffer to grow to at most 150 but it is " + str(capacity))
+        self.assertTrue(capacity <= high_water <= 150, "Expected a high water mark of at most 150 but it is " + str(high_water))
+        self.comp.stop()
+        sink.stop()
+
+    def testRestartKeepsBuffer(self):
+        """A restart keeps the internal buffer unless its size changes, and the start latency is reported"""
+        self.setupComponent()
+        self.comp.start()
+        self.assertFalse(self.comp.status.buffer_reused)
+        self.assertTrue(self.comp.status.start_latency > 0)
+
+        self.comp.stop()
+        self.comp.start()
+        self.assertTrue(self.comp.status.buffer_reused)
+        self.assertTrue(self.comp.status.start_latency > 0)
+
+        self.comp.stop()
+        self.comp.advanced_optimizations.buffer_size = self.comp.advanced_optimizations.buffer_size + 1000
+        self.comp.start()
+        self.assertFalse(self.comp.status.buffer_reused)
+        self.comp.stop()
+
+    def testByteSwapKernel(self):
+        """Big endian shorts gathered over several packets come out in host order, and the swap kernel is reported"""
+        self.setupComponent(endianness=BIG_ENDIAN, pkts_per_push=4)
+        self.assertTrue(self.comp.status.byte_swap_kernel in ('avx512', 'avx2', 'ssse3', 'sse2', 'scalar'))
+
+        sink = sb.DataSink()
+        self.comp.connect(sink, providesPortName='shortIn')
+        self.comp.start()
+        sink.start()
+
+        fakeData = [x for x in range(0, 512)]
+        for seq in range(0, 4):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+
+        time.sleep(1)
+        data = sink.getData()
+        self.assertEqual(len(data), 4 * 512)
+        self.assertEqual(4 * fakeData, list(struct.unpack('>2048H', struct.pack('>2048H', *data))))
+        self.comp.stop()
+        sink.stop()
+
     def testUdpBufferSize(self):
 
         self.setupComponent()
@@ -1090,6 +1647,30 @@ class ComponentTests(ossie.utils.testing.ScaComponentTestCase):
             
         self.assertEqual(self.comp.status.time_slips, 0, "There should be no time slips!")
 
+    def testSriChanges(self):
+        """The SRI is pushed once for a stream and again only when the rate in the SDDS header changes"""
+        self.setupComponent()
+
+        sink = sb.DataSink()
+        self.comp.connect(sink, providesPortName='shortIn')
+        self.comp.start()
+        sink.start()
+
+        fakeData = [x for x in range(0, 512)]
+        for seq in range(0, 20):
+            sr = 1e6 if seq < 10 else 2e6
+            h = Sdds.SddsHeader(seq, FREQ=(sr*73786976294.838211))
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+
+        time.sleep(1)
+        sink.getData()
+        self.assertEqual(self.comp.status.sri_changes, 2, "The SRI should have changed for the first packet and for the new rate")
+        self.assertAlmostEqual(sink.sri().xdelta, 1/2e6)
+        self.comp.stop()
+        sink.stop()
+
     def testBulkIOTiming(self):
         self.setupComponent()
         